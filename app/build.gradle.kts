@@ -10,7 +10,7 @@ plugins {
     alias(libs.plugins.kotlin.android)
     alias(libs.plugins.kotlin.compose)
     alias(libs.plugins.kotlin.serialization)
-    alias(libs.plugins.wire)
+    alias(libs.plugins.androidx.baselineprofile)
 }
 
 android {
@@ -40,8 +40,15 @@ android {
         testInstrumentationRunner = "androidx.test.runner.AndroidJUnitRunner"
     }
 
+    // 系统跟踪（Perfetto）插桩：debug 默认开启，release 默认关闭，-PenableTracing=true 可强制开启
+    val tracingOverride = providers.gradleProperty("enableTracing").orNull
+
     buildTypes {
+        debug {
+            buildConfigField("boolean", "ENABLE_TRACING", tracingOverride ?: "true")
+        }
         release {
+            buildConfigField("boolean", "ENABLE_TRACING", tracingOverride ?: "false")
             isMinifyEnabled = true
             isShrinkResources = true
             proguardFiles(
@@ -100,16 +107,6 @@ android {
     }
 }
 
-wire {
-    kotlin {
-        android = true
-        javaInterop = true
-    }
-    sourcePath {
-        srcDir("../proto")
-    }
-}
-
 dependencies {
 
     implementation(libs.androidx.core.ktx)
@@ -124,9 +121,13 @@ dependencies {
     implementation(libs.jeromq)
     implementation(libs.timber)
     implementation(libs.gson)
-    implementation(libs.wire.runtime)
+    implementation(project(":protocol"))
+    implementation(libs.androidx.tracing.ktx)
     implementation(libs.coil.compose)
     implementation(libs.vlc.android)
+    implementation(libs.androidx.profileinstaller)
+    // 由 :baselineprofile 生成，打包进 release 构建，安装时预编译启动路径
+    baselineProfile(project(":baselineprofile"))
 
     testImplementation(libs.junit)
     androidTestImplementation(libs.androidx.junit)
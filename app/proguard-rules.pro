@@ -18,4 +18,7 @@
 
 # If you keep the line number information, uncomment this to
 # hide the original source file name.
-#-renamesourcefileattribute SourceFile
\ No newline at end of file
+#-renamesourcefileattribute SourceFile
+
+# 机器人列表以 JSON 保存（Gson 反射读写字段）
+-keep class com.helywin.leggedjoystick.data.RobotProfile { <fields>; }
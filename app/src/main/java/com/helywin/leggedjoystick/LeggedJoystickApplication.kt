@@ -19,7 +19,10 @@
 package com.helywin.leggedjoystick
 
 import android.app.Application
+import android.util.Log
+import com.helywin.leggedjoystick.log.HotLog
 import timber.log.Timber
+import java.io.File
 
 class LeggedJoystickApplication : Application() {
     override fun onCreate() {
@@ -29,6 +32,12 @@ class LeggedJoystickApplication : Application() {
         if (BuildConfig.DEBUG) {
             Timber.plant(Timber.DebugTree())
         }
+
+        // 热路径日志：debug 记录全部事件，release 只记录调试级别以上，崩溃和断链时导出
+        HotLog.minPriority = if (BuildConfig.DEBUG) Log.VERBOSE else Log.DEBUG
+        HotLog.forwardPriority = if (BuildConfig.DEBUG) Log.DEBUG else Log.INFO
+        HotLog.start(File(filesDir, "hotlog"))
+        HotLog.installCrashHandler()
         
         Timber.i("LeggedJoystick应用程序已启动")
     }
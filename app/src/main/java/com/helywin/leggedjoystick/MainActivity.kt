@@ -7,24 +7,37 @@ import android.view.KeyEvent
 import android.view.MotionEvent
 import android.view.WindowManager
 import androidx.activity.ComponentActivity
+import androidx.activity.compose.ReportDrawnWhen
 import androidx.activity.compose.setContent
 import androidx.activity.enableEdgeToEdge
+import androidx.compose.foundation.layout.Box
 import androidx.compose.foundation.layout.fillMaxSize
+import androidx.compose.foundation.layout.statusBarsPadding
 import androidx.compose.material3.MaterialTheme
 import androidx.compose.material3.Surface
 import androidx.compose.runtime.*
+import androidx.compose.ui.Alignment
 import androidx.compose.ui.Modifier
+import androidx.compose.ui.platform.LocalContext
+import androidx.compose.ui.semantics.semantics
+import androidx.compose.ui.semantics.testTagsAsResourceId
 import androidx.compose.ui.tooling.preview.Preview
+import com.helywin.leggedjoystick.controller.ControlInputSnapshot
 import com.helywin.leggedjoystick.controller.Controller
+import com.helywin.leggedjoystick.controller.PerfSnapshot
 import com.helywin.leggedjoystick.controller.RobotControllerImpl
 import com.helywin.leggedjoystick.controller.settingsState
 import com.helywin.leggedjoystick.data.AppSettings
 import com.helywin.leggedjoystick.data.ConnectionState
 import com.helywin.leggedjoystick.data.SpeedLevel
 import com.helywin.leggedjoystick.input.GamepadInputHandler
+import com.helywin.leggedjoystick.log.HotEvent
+import com.helywin.leggedjoystick.log.HotLog
+import com.helywin.leggedjoystick.ui.components.PerfHud
 import com.helywin.leggedjoystick.ui.main.MainControlScreen
 import com.helywin.leggedjoystick.ui.settings.SettingsScreen
 import com.helywin.leggedjoystick.ui.theme.LeggedJoystickTheme
+import com.helywin.leggedjoystick.ui.video.VideoSessionManager
 import com.helywin.leggedjoystick.ui.video.VideoStreamScreen
 import timber.log.Timber
 
@@ -63,9 +76,23 @@ class MainActivity : ComponentActivity() {
                 updateScreenOnFlag(settingsState.settings.keepScreenOn)
             }
 
+            // 设置加载完成且首帧已绘制后，在后台预创建 LibVLC
+            LaunchedEffect(settingsState.isSettingsLoaded) {
+                if (settingsState.isSettingsLoaded) {
+                    withFrameNanos { }
+                    VideoSessionManager.warmUp(this@MainActivity, settingsState.settings.videoProfile)
+                }
+            }
+
+            // 可以操控时报告完全绘制，启动基准的 timeToFullDisplay 即启动到可操控的耗时
+            ReportDrawnWhen { settingsState.timeToFirstControlMs >= 0 }
+
             LeggedJoystickTheme {
                 Surface(
-                    modifier = Modifier.fillMaxSize(),
+                    // 测试标签暴露为资源ID，供宏基准的 UiAutomator 查找控件
+                    modifier = Modifier
+                        .fillMaxSize()
+                        .semantics { testTagsAsResourceId = true },
                     color = MaterialTheme.colorScheme.background
                 ) {
                     LeggedJoystickApp(controller, gamepadInputHandler)
@@ -80,6 +107,17 @@ class MainActivity : ComponentActivity() {
         updateScreenOnFlag(settingsState.settings.keepScreenOn)
     }
 
+    override fun onStart() {
+        super.onStart()
+        VideoSessionManager.resume()
+    }
+
+    override fun onStop() {
+        super.onStop()
+        // 后台不拉视频流，回到前台后恢复
+        VideoSessionManager.suspend()
+    }
+
     override fun onPause() {
         super.onPause()
         // 应用进入后台时，清除屏幕常亮标志
@@ -91,6 +129,9 @@ class MainActivity : ComponentActivity() {
         releaseWakeLock()
         gamepadInputHandler.reset()
         controller.cleanup()
+        if (isFinishing) {
+            VideoSessionManager.release()
+        }
     }
 
     /**
@@ -109,7 +150,7 @@ class MainActivity : ComponentActivity() {
      */
     private fun updateWakeLockState(connectionState: ConnectionState) {
         when (connectionState) {
-            ConnectionState.CONNECTED -> {
+            ConnectionState.CONNECTED, ConnectionState.RECONNECTING -> {
                 acquireWakeLock()
                 Timber.i("[MainActivity] 已连接，启用屏幕保持唤醒")
             }
@@ -191,17 +232,8 @@ class MainActivity : ComponentActivity() {
      * 设置游戏手柄输入回调
      */
     private fun setupGamepadCallbacks() {
-        // 左摇杆回调
-        gamepadInputHandler.setLeftJoystickCallback { joystickValue ->
-            controller.updateLeftJoystick(joystickValue)
-            Timber.v("[MainActivity] 物理左摇杆更新: x=${joystickValue.x}, y=${joystickValue.y}")
-        }
-
-        // 右摇杆回调
-        gamepadInputHandler.setRightJoystickCallback { joystickValue ->
-            controller.updateRightJoystick(joystickValue)
-            Timber.v("[MainActivity] 物理右摇杆更新: x=${joystickValue.x}, y=${joystickValue.y}")
-        }
+        // 物理摇杆直接写入控制输入快照
+        gamepadInputHandler.attachInputSnapshot(controller.inputSnapshot)
 
         // 按键事件回调
         gamepadInputHandler.setKeyEventCallback { keyCode, isPressed ->
@@ -252,30 +284,17 @@ class MainActivity : ComponentActivity() {
                     controller.setSpeedLevel(nextLevel)
                 }
             }
+            KeyEvent.KEYCODE_BUTTON_SELECT -> {
+                // SELECT按钮 - 切换性能浮层
+                if (isPressed) {
+                    val current = settingsState.settings
+                    controller.updateSettings(current.copy(showPerfHud = !current.showPerfHud))
+                }
+            }
             // 可以根据需要添加更多按钮映射
         }
 
-        val action = if (isPressed) "按下" else "释放"
-        Timber.d("[MainActivity] 游戏手柄按钮事件: ${getButtonName(keyCode)} $action")
-    }
-
-    /**
-     * 获取按钮名称（用于日志）
-     */
-    private fun getButtonName(keyCode: Int): String {
-        return when (keyCode) {
-            KeyEvent.KEYCODE_BUTTON_A -> "A"
-            KeyEvent.KEYCODE_BUTTON_B -> "B"
-            KeyEvent.KEYCODE_BUTTON_X -> "X"
-            KeyEvent.KEYCODE_BUTTON_Y -> "Y"
-            KeyEvent.KEYCODE_BUTTON_L1 -> "L1"
-            KeyEvent.KEYCODE_BUTTON_R1 -> "R1"
-            KeyEvent.KEYCODE_BUTTON_L2 -> "L2"
-            KeyEvent.KEYCODE_BUTTON_R2 -> "R2"
-            KeyEvent.KEYCODE_BUTTON_THUMBL -> "左摇杆按下"
-            KeyEvent.KEYCODE_BUTTON_THUMBR -> "右摇杆按下"
-            else -> "未知($keyCode)"
-        }
+        HotLog.log(HotEvent.GAMEPAD_BUTTON, keyCode.toLong(), if (isPressed) 1L else 0L)
     }
 }
 
@@ -283,29 +302,62 @@ class MainActivity : ComponentActivity() {
 fun LeggedJoystickApp(controller: Controller, gamepadInputHandler: GamepadInputHandler) {
     var showSettings by remember { mutableStateOf(false) }
     var showVideoStream by remember { mutableStateOf(false) }
+    val context = LocalContext.current
 
-    when {
-        showVideoStream -> {
-            VideoStreamScreen(
-                rtspUrl = settingsState.settings.rtspUrl,
-                onBackClick = { showVideoStream = false }
-            )
+    // 已连接机器人时在控制界面预先建立视频会话，切换到视频界面时画面立即可用
+    val isConnected = settingsState.isConnected
+    val rtspUrl = settingsState.settings.activeRobot.rtspUrl
+    val videoProfile = settingsState.settings.videoProfile
+    LaunchedEffect(isConnected, rtspUrl, videoProfile) {
+        if (isConnected) {
+            VideoSessionManager.preconnect(context, rtspUrl, videoProfile)
+        } else if (!showVideoStream) {
+            VideoSessionManager.stop()
         }
-        showSettings -> {
-            SettingsScreen(
-                currentSettings = settingsState.settings,
-                onSettingsChange = { newSettings ->
-                    controller.updateSettings(newSettings)
-                },
-                onBackClick = { showSettings = false }
-            )
+    }
+
+    Box(modifier = Modifier.fillMaxSize()) {
+        when {
+            showVideoStream -> {
+                VideoStreamScreen(
+                    rtspUrl = settingsState.settings.activeRobot.rtspUrl,
+                    videoProfile = settingsState.settings.videoProfile,
+                    clockOffsetMs = { settingsState.linkStats.clockOffsetMs },
+                    keepSessionWarm = { settingsState.isConnected },
+                    odometryBuffer = controller.odometryBuffer,
+                    onBackClick = { showVideoStream = false }
+                )
+            }
+            showSettings -> {
+                SettingsScreen(
+                    currentSettings = settingsState.settings,
+                    onSettingsChange = { newSettings ->
+                        controller.updateSettings(newSettings)
+                    },
+                    onBackClick = { showSettings = false },
+                    isReplaying = settingsState.isReplaying,
+                    onReplayClick = { speed -> controller.replayLastSession(speed) },
+                    onStopReplayClick = { controller.stopReplay() }
+                )
+            }
+            else -> {
+                MainControlScreen(
+                    controller = controller,
+                    gamepadInputState = gamepadInputHandler.inputState,
+                    onSettingsClick = { showSettings = true },
+                    onVideoClick = { showVideoStream = true }
+                )
+            }
         }
-        else -> {
-            MainControlScreen(
-                controller = controller,
-                gamepadInputState = gamepadInputHandler.inputState,
-                onSettingsClick = { showSettings = true },
-                onVideoClick = { showVideoStream = true }
+
+        // 性能浮层叠加在所有界面之上，隐藏时不采样
+        if (settingsState.settings.showPerfHud) {
+            PerfHud(
+                sample = controller::samplePerf,
+                gamepadState = gamepadInputHandler.inputState,
+                modifier = Modifier
+                    .align(Alignment.TopEnd)
+                    .statusBarsPadding()
             )
         }
     }
@@ -317,6 +369,8 @@ fun LeggedJoystickApp(controller: Controller, gamepadInputHandler: GamepadInputH
 fun LeggedJoystickAppPreview() {
     LeggedJoystickTheme {
         LeggedJoystickApp(object : Controller {
+            override val inputSnapshot = ControlInputSnapshot()
+            override val odometryBuffer = com.helywin.leggedjoystick.odometry.OdometryBuffer()
             override fun connect() {}
             override fun disconnect() {}
             override fun cancelConnection() {}
@@ -334,6 +388,10 @@ fun LeggedJoystickAppPreview() {
             override fun saveSettings(settings: AppSettings) {}
             override fun isConnected() = false
             override fun cleanup() {}
+            override fun samplePerf() = PerfSnapshot(System.nanoTime())
+            override fun replayLastSession(speed: Double) {}
+            override fun stopReplay() {}
+            override fun switchRobot(robotId: String) {}
         }, GamepadInputHandler())
     }
 }
@@ -0,0 +1,226 @@
+/*********************************************************************************
+ * FileName: ControlInputSnapshot.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 控制输入快照，基于顺序锁（seqlock）在输入线程和控制线程之间共享完整的控制状态
+ * Others: 写入端为UI线程（虚拟摇杆、物理手柄），读取端为控制循环线程，读取过程不分配内存
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.controller
+
+import com.helywin.leggedjoystick.data.SpeedLevel
+import java.util.concurrent.atomic.AtomicIntegerArray
+import java.util.concurrent.atomic.AtomicLong
+import kotlin.math.abs
+
+/**
+ * 控制循环读取到的一帧输入，由读取方持有并重复使用
+ */
+class ControlInputFrame {
+    // 本帧对应的输入序号，每次写入加一
+    var sequence = 0L
+        internal set
+    var leftX = 0f
+        internal set
+    var leftY = 0f
+        internal set
+    var rightX = 0f
+        internal set
+    var rightY = 0f
+        internal set
+    // 按键位图，见 ControlInputSnapshot.BUTTON_*
+    var buttons = 0
+        internal set
+    var speedLevel = SpeedLevel.MEDIUM
+        internal set
+    // 最近一次摇杆样本的时间（System.nanoTime时基，与MotionEvent事件时间一致）
+    var stickTimeNanos = 0L
+        internal set
+    // 最近一次摇杆更新合并的样本数
+    var stickSamples = 0
+        internal set
+
+    /**
+     * 左摇杆是否在中心位置（与 JoystickValue.isCenter 阈值一致）
+     */
+    val isLeftCenter: Boolean
+        get() = abs(leftX) < CENTER_THRESHOLD && abs(leftY) < CENTER_THRESHOLD
+
+    /**
+     * 右摇杆是否在中心位置
+     */
+    val isRightCenter: Boolean
+        get() = abs(rightX) < CENTER_THRESHOLD && abs(rightY) < CENTER_THRESHOLD
+
+    fun isButtonPressed(button: Int): Boolean = (buttons and button) != 0
+
+    private companion object {
+        const val CENTER_THRESHOLD = 0.01f
+    }
+}
+
+/**
+ * 控制输入快照
+ *
+ * 写入方法之间互斥，读取方通过序号判断是否读到一致的数据：
+ * 序号为奇数表示正在写入，读取前后序号相同且为偶数时数据有效
+ */
+class ControlInputSnapshot {
+    companion object {
+        // 按键位
+        const val BUTTON_A = 1 shl 0
+        const val BUTTON_B = 1 shl 1
+        const val BUTTON_X = 1 shl 2
+        const val BUTTON_Y = 1 shl 3
+        const val BUTTON_L1 = 1 shl 4
+        const val BUTTON_R1 = 1 shl 5
+        const val BUTTON_L2 = 1 shl 6
+        const val BUTTON_R2 = 1 shl 7
+        const val BUTTON_SELECT = 1 shl 8
+        const val BUTTON_START = 1 shl 9
+        const val BUTTON_THUMBL = 1 shl 10
+        const val BUTTON_THUMBR = 1 shl 11
+
+        // 数据槽位
+        private const val SLOT_LEFT_X = 0
+        private const val SLOT_LEFT_Y = 1
+        private const val SLOT_RIGHT_X = 2
+        private const val SLOT_RIGHT_Y = 3
+        private const val SLOT_BUTTONS = 4
+        private const val SLOT_SPEED_LEVEL = 5
+        private const val SLOT_STICK_SAMPLES = 6
+        private const val SLOT_COUNT = 7
+
+        private val speedLevels = SpeedLevel.entries.toTypedArray()
+    }
+
+    private val sequence = AtomicLong(0)
+    private val stickTimeNanos = AtomicLong(0)
+    private val slots = AtomicIntegerArray(SLOT_COUNT).apply {
+        set(SLOT_SPEED_LEVEL, SpeedLevel.MEDIUM.ordinal)
+    }
+
+    /**
+     * 当前已完成的写入次数，与 ControlInputFrame.sequence 比较即可判断是否有新输入
+     */
+    val currentSequence: Long
+        get() = sequence.get() ushr 1
+
+    /**
+     * 更新左摇杆
+     */
+    fun updateLeftStick(x: Float, y: Float) = write {
+        slots.set(SLOT_LEFT_X, x.toRawBits())
+        slots.set(SLOT_LEFT_Y, y.toRawBits())
+        markStickSample(System.nanoTime(), 1)
+    }
+
+    /**
+     * 更新右摇杆
+     */
+    fun updateRightStick(x: Float, y: Float) = write {
+        slots.set(SLOT_RIGHT_X, x.toRawBits())
+        slots.set(SLOT_RIGHT_Y, y.toRawBits())
+        markStickSample(System.nanoTime(), 1)
+    }
+
+    /**
+     * 同时更新两个摇杆，保证读取方看到同一事件中的左右摇杆值
+     * @param sampleTimeNanos 最新样本的事件时间
+     * @param samples 本次合并的样本数（包括批量历史样本）
+     */
+    fun updateSticks(
+        leftX: Float,
+        leftY: Float,
+        rightX: Float,
+        rightY: Float,
+        sampleTimeNanos: Long = System.nanoTime(),
+        samples: Int = 1
+    ) = write {
+        slots.set(SLOT_LEFT_X, leftX.toRawBits())
+        slots.set(SLOT_LEFT_Y, leftY.toRawBits())
+        slots.set(SLOT_RIGHT_X, rightX.toRawBits())
+        slots.set(SLOT_RIGHT_Y, rightY.toRawBits())
+        markStickSample(sampleTimeNanos, samples)
+    }
+
+    /**
+     * 更新按键状态
+     */
+    fun updateButton(button: Int, pressed: Boolean) = write {
+        val current = slots.get(SLOT_BUTTONS)
+        slots.set(SLOT_BUTTONS, if (pressed) current or button else current and button.inv())
+    }
+
+    /**
+     * 更新速度档位
+     */
+    fun updateSpeedLevel(level: SpeedLevel) = write {
+        slots.set(SLOT_SPEED_LEVEL, level.ordinal)
+    }
+
+    /**
+     * 摇杆和按键全部复位
+     */
+    fun reset() = write {
+        for (slot in SLOT_LEFT_X..SLOT_BUTTONS) {
+            slots.set(slot, 0)
+        }
+        markStickSample(System.nanoTime(), 0)
+    }
+
+    /**
+     * 读取一致的一帧输入到 [frame]
+     * @return 与frame中原有的序号相比是否有新输入
+     */
+    fun read(frame: ControlInputFrame): Boolean {
+        while (true) {
+            val before = sequence.get()
+            if ((before and 1L) != 0L) {
+                Thread.yield()
+                continue
+            }
+
+            val leftX = Float.fromBits(slots.get(SLOT_LEFT_X))
+            val leftY = Float.fromBits(slots.get(SLOT_LEFT_Y))
+            val rightX = Float.fromBits(slots.get(SLOT_RIGHT_X))
+            val rightY = Float.fromBits(slots.get(SLOT_RIGHT_Y))
+            val buttons = slots.get(SLOT_BUTTONS)
+            val speedLevel = slots.get(SLOT_SPEED_LEVEL)
+            val stickSamples = slots.get(SLOT_STICK_SAMPLES)
+            val stickTime = stickTimeNanos.get()
+
+            if (sequence.get() == before) {
+                val newSequence = before ushr 1
+                val changed = newSequence != frame.sequence
+                frame.sequence = newSequence
+                frame.leftX = leftX
+                frame.leftY = leftY
+                frame.rightX = rightX
+                frame.rightY = rightY
+                frame.buttons = buttons
+                frame.speedLevel = speedLevels[speedLevel]
+                frame.stickTimeNanos = stickTime
+                frame.stickSamples = stickSamples
+                return changed
+            }
+        }
+    }
+
+    private fun markStickSample(sampleTimeNanos: Long, samples: Int) {
+        stickTimeNanos.set(sampleTimeNanos)
+        slots.set(SLOT_STICK_SAMPLES, samples)
+    }
+
+    private inline fun write(block: () -> Unit) {
+        synchronized(this) {
+            sequence.incrementAndGet()
+            try {
+                block()
+            } finally {
+                sequence.incrementAndGet()
+            }
+        }
+    }
+}
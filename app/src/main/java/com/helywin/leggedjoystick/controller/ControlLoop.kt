@@ -0,0 +1,240 @@
+/*********************************************************************************
+ * FileName: ControlLoop.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 独立线程上的固定频率控制循环，按单调时钟截止时间调度
+ * Others: 以截止时间而非“执行后休眠”定步，避免周期随执行耗时和UI卡顿漂移
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.controller
+
+import android.os.Process
+import android.os.SystemClock
+import com.helywin.leggedjoystick.data.ControlRate
+import com.helywin.leggedjoystick.trace.PerfTrace
+import com.helywin.leggedjoystick.trace.TraceNames
+import timber.log.Timber
+import java.util.concurrent.locks.LockSupport
+
+/**
+ * 控制循环统计数据，每个统计窗口（约1秒）发布一次
+ *
+ * @param rateHz 目标频率
+ * @param ticks 本窗口内执行的周期数
+ * @param meanLatenessUs 本窗口内唤醒时刻相对截止时间的平均延迟（抖动）
+ * @param maxLatenessUs 本窗口内最大唤醒延迟
+ * @param maxWorkUs 本窗口内单个周期的最大执行耗时
+ * @param overruns 累计执行耗时超过一个周期的次数
+ * @param missedDeadlines 累计被整体跳过的周期数
+ */
+data class ControlLoopStats(
+    val rateHz: Int = 0,
+    val ticks: Int = 0,
+    val meanLatenessUs: Long = 0,
+    val maxLatenessUs: Long = 0,
+    val maxWorkUs: Long = 0,
+    val overruns: Long = 0,
+    val missedDeadlines: Long = 0
+)
+
+/**
+ * 固定频率控制循环
+ *
+ * @param name 线程名
+ * @param rate 初始控制频率
+ * @param onStats 统计回调，在控制线程上调用
+ * @param tick 每个周期执行的工作，参数为本周期的截止时间（elapsedRealtimeNanos）
+ */
+class ControlLoop(
+    private val name: String,
+    rate: ControlRate,
+    private val onStats: (ControlLoopStats) -> Unit = {},
+    private val tick: (deadlineNanos: Long) -> Unit
+) {
+    companion object {
+        private const val STATS_WINDOW_NANOS = 1_000_000_000L
+        private const val THREAD_JOIN_TIMEOUT_MS = 500L
+    }
+
+    @Volatile
+    private var rate: ControlRate = rate
+
+    @Volatile
+    private var running = false
+
+    private var thread: Thread? = null
+
+    // 跟踪区段名，按循环名预先拼接
+    private val traceSection = "Control.$name"
+
+    val isRunning: Boolean
+        get() = running
+
+    /**
+     * 修改控制频率，下一个周期生效
+     */
+    fun setRate(newRate: ControlRate) {
+        if (rate != newRate) {
+            rate = newRate
+            thread?.let { LockSupport.unpark(it) }
+            Timber.i("[ControlLoop] $name 控制频率切换为 ${newRate.displayName}")
+        }
+    }
+
+    /**
+     * 启动控制线程
+     */
+    @Synchronized
+    fun start() {
+        if (running) return
+        running = true
+        thread = Thread({ runLoop() }, name).apply {
+            isDaemon = true
+            start()
+        }
+        Timber.i("[ControlLoop] $name 已启动: ${rate.displayName}")
+    }
+
+    /**
+     * 停止控制线程并等待其退出
+     */
+    @Synchronized
+    fun stop() {
+        if (!running) return
+        running = false
+        thread?.let {
+            LockSupport.unpark(it)
+            if (it !== Thread.currentThread()) {
+                it.join(THREAD_JOIN_TIMEOUT_MS)
+            }
+        }
+        thread = null
+        Timber.i("[ControlLoop] $name 已停止")
+    }
+
+    private fun runLoop() {
+        Process.setThreadPriority(Process.THREAD_PRIORITY_DISPLAY)
+
+        var currentRate = rate
+        val pacer = DeadlinePacer(currentRate.periodNanos, SystemClock.elapsedRealtimeNanos())
+
+        // 统计窗口
+        var windowStart = pacer.deadlineNanos
+        var windowTicks = 0
+        var windowLatenessSum = 0L
+        var windowMaxLateness = 0L
+        var windowMaxWork = 0L
+
+        while (running) {
+            // 等待到截止时间
+            var now = SystemClock.elapsedRealtimeNanos()
+            while (running && now < pacer.deadlineNanos) {
+                LockSupport.parkNanos(pacer.deadlineNanos - now)
+                now = SystemClock.elapsedRealtimeNanos()
+                if (rate != currentRate) break
+            }
+            if (!running) break
+
+            if (rate != currentRate) {
+                // 频率变化时以当前时刻为新的时间基准
+                currentRate = rate
+                pacer.restart(currentRate.periodNanos, now)
+            }
+
+            val deadline = pacer.deadlineNanos
+            val lateness = now - deadline
+            PerfTrace.counter(TraceNames.CONTROL_LATENESS_US, (lateness / 1000).toInt())
+            try {
+                PerfTrace.section(traceSection) {
+                    tick(deadline)
+                }
+            } catch (e: Exception) {
+                Timber.e(e, "[ControlLoop] $name 周期执行异常")
+            }
+            val workNanos = SystemClock.elapsedRealtimeNanos() - now
+            pacer.onTickDone(now, workNanos)
+
+            windowTicks++
+            windowLatenessSum += lateness
+            if (lateness > windowMaxLateness) windowMaxLateness = lateness
+            if (workNanos > windowMaxWork) windowMaxWork = workNanos
+
+            val afterWork = now + workNanos
+            if (afterWork - windowStart >= STATS_WINDOW_NANOS) {
+                onStats(
+                    ControlLoopStats(
+                        rateHz = currentRate.hz,
+                        ticks = windowTicks,
+                        meanLatenessUs = windowLatenessSum / windowTicks / 1000,
+                        maxLatenessUs = windowMaxLateness / 1000,
+                        maxWorkUs = windowMaxWork / 1000,
+                        overruns = pacer.overruns,
+                        missedDeadlines = pacer.missedDeadlines
+                    )
+                )
+                windowStart = afterWork
+                windowTicks = 0
+                windowLatenessSum = 0
+                windowMaxLateness = 0
+                windowMaxWork = 0
+            }
+        }
+    }
+}
+
+/**
+ * 截止时间推进和超时计数，只在控制线程使用，时间均为 elapsedRealtimeNanos
+ *
+ * @param periodNanos 控制周期
+ * @param startNanos 第一个周期的截止时间
+ */
+internal class DeadlinePacer(periodNanos: Long, startNanos: Long) {
+    var periodNanos = periodNanos
+        private set
+
+    /**
+     * 下一个周期的截止时间
+     */
+    var deadlineNanos = startNanos
+        private set
+
+    /**
+     * 累计执行耗时超过一个周期的次数
+     */
+    var overruns = 0L
+        private set
+
+    /**
+     * 累计被整体跳过的周期数
+     */
+    var missedDeadlines = 0L
+        private set
+
+    /**
+     * 切换周期，以 [nowNanos] 为新的时间基准，累计计数保留
+     */
+    fun restart(newPeriodNanos: Long, nowNanos: Long) {
+        periodNanos = newPeriodNanos
+        deadlineNanos = nowNanos
+    }
+
+    /**
+     * 一个周期执行完毕：统计超时并推进截止时间；已经错过的周期整体跳过，不做补发
+     *
+     * @param startNanos 本周期开始执行的时刻
+     * @param workNanos 本周期执行耗时
+     */
+    fun onTickDone(startNanos: Long, workNanos: Long) {
+        if (workNanos > periodNanos) {
+            overruns++
+        }
+        deadlineNanos += periodNanos
+        val afterWork = startNanos + workNanos
+        if (afterWork >= deadlineNanos) {
+            val skipped = (afterWork - deadlineNanos) / periodNanos + 1
+            missedDeadlines += skipped
+            deadlineNanos += skipped * periodNanos
+        }
+    }
+}
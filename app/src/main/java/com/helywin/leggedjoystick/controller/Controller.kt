@@ -11,6 +11,8 @@ package com.helywin.leggedjoystick.controller
 
 import android.content.Context
 import android.os.Build
+import android.os.Process
+import android.os.SystemClock
 import android.os.VibrationEffect
 import android.os.Vibrator
 import android.os.VibratorManager
@@ -19,12 +21,28 @@ import com.helywin.leggedjoystick.data.AppSettings
 import com.helywin.leggedjoystick.data.ConnectionState
 import com.helywin.leggedjoystick.data.SettingsManager
 import com.helywin.leggedjoystick.data.SpeedLevel
+import com.helywin.leggedjoystick.log.HotEvent
+import com.helywin.leggedjoystick.log.HotLog
+import com.helywin.leggedjoystick.metrics.LatencyGauge
+import com.helywin.leggedjoystick.metrics.RuntimeCounters
+import com.helywin.leggedjoystick.odometry.OdometryBuffer
+import com.helywin.leggedjoystick.odometry.OdometryPublisher
+import com.helywin.leggedjoystick.odometry.OdometryState
 import com.helywin.leggedjoystick.proto.MessageUtils
+import com.helywin.leggedjoystick.recording.FlightRecordReader
+import com.helywin.leggedjoystick.recording.FlightRecorder
 import legged_driver.*
 import com.helywin.leggedjoystick.ui.joystick.JoystickValue
+import com.helywin.leggedjoystick.zmq.DeliveryMode
+import com.helywin.leggedjoystick.zmq.FlightReplayer
+import com.helywin.leggedjoystick.zmq.LinkStatsSnapshot
 import com.helywin.leggedjoystick.zmq.NewZmqClient
+import com.helywin.leggedjoystick.zmq.RobotSession
+import com.helywin.leggedjoystick.zmq.RobotSessionManager
+import com.helywin.leggedjoystick.zmq.awaitResult
 import kotlinx.coroutines.*
 import timber.log.Timber
+import java.io.File
 
 /**
  * 应用状态管理类
@@ -58,6 +76,34 @@ class ControllerState {
     var isRobotCtrlModeChanging by mutableStateOf(false)
         private set
 
+    // 控制循环统计
+    var controlLoopStats by mutableStateOf(ControlLoopStats())
+        private set
+
+    // 链路质量统计
+    var linkStats by mutableStateOf(LinkStatsSnapshot())
+        private set
+
+    // 里程计（按帧抽样发布）
+    var odometry by mutableStateOf(OdometryState())
+        private set
+
+    // 是否正在回放黑匣子记录
+    var isReplaying by mutableStateOf(false)
+        private set
+
+    // 设置是否已从存储加载（启动时在后台线程加载，加载前为默认设置）
+    var isSettingsLoaded by mutableStateOf(false)
+        private set
+
+    // 进程启动到可以操控的耗时：开启自动连接时到首次连接成功，否则到设置加载完成；未知时为 -1
+    var timeToFirstControlMs by mutableStateOf(-1L)
+        private set
+
+    // 每个机器人会话的连接状态（按机器人ID），用于切换操控对象时显示
+    var robotConnectionStates by mutableStateOf(emptyMap<String, ConnectionState>())
+        private set
+
     // 衍生状态
     val isConnected: Boolean
         get() = connectionState == ConnectionState.CONNECTED
@@ -102,6 +148,38 @@ class ControllerState {
     fun setSpeedLevel(level: SpeedLevel) {
         settings = settings.copy(speedLevel = level)
     }
+
+    fun updateControlLoopStats(stats: ControlLoopStats) {
+        controlLoopStats = stats
+    }
+
+    fun updateLinkStats(stats: LinkStatsSnapshot) {
+        linkStats = stats
+    }
+
+    fun updateOdometry(state: OdometryState) {
+        odometry = state
+    }
+
+    fun updateReplaying(replaying: Boolean) {
+        isReplaying = replaying
+    }
+
+    fun updateSettingsLoaded(loaded: Boolean) {
+        isSettingsLoaded = loaded
+    }
+
+    fun updateTimeToFirstControl(ms: Long) {
+        timeToFirstControlMs = ms
+    }
+
+    fun updateRobotConnectionState(robotId: String, state: ConnectionState) {
+        robotConnectionStates = robotConnectionStates + (robotId to state)
+    }
+
+    fun removeRobotConnectionStates(keep: Set<String>) {
+        robotConnectionStates = robotConnectionStates.filterKeys { it in keep }
+    }
 }
 
 /**
@@ -113,6 +191,10 @@ val settingsState = ControllerState()
  * 机器人控制器接口
  */
 interface Controller {
+    // 控制输入快照，物理手柄直接写入，控制循环从中读取
+    val inputSnapshot: ControlInputSnapshot
+    // 里程计缓冲区，轨迹叠加和记录查询最近的轨迹窗口
+    val odometryBuffer: OdometryBuffer
     fun connect()
     fun disconnect()
     fun cancelConnection()
@@ -130,6 +212,13 @@ interface Controller {
     fun cleanup()
     fun loadSettings()
     fun saveSettings(settings: AppSettings)
+    // 性能浮层低频采样，读取无锁计数器，不影响控制和I/O线程
+    fun samplePerf(): PerfSnapshot
+    // 未连接时回放最近一次黑匣子记录，speed <= 0 表示不等待
+    fun replayLastSession(speed: Double)
+    fun stopReplay()
+    // 切换操控的机器人，其余机器人会话在后台保持连接
+    fun switchRobot(robotId: String)
 }
 
 /**
@@ -144,8 +233,27 @@ class RobotControllerImpl(private val context: Context) : Controller {
         private const val VIBRATION_AMPLITUDE_RELEASE = 150     // 释放震动强度
     }
 
-    private val zmqClient = NewZmqClient()
-    private val settingsManager = SettingsManager(context)
+    // 多机器人会话共享一个ZMQ上下文和I/O线程，只有当前操控的会话发送速度指令
+    private val robotSessions = RobotSessionManager()
+
+    // 当前操控的会话，任意线程可读
+    private val activeSession: RobotSession
+        get() = checkNotNull(robotSessions.active)
+
+    private val zmqClient: NewZmqClient
+        get() = activeSession.client
+
+    // 是否已请求连接（连接后新增的机器人会话立即连接）
+    private var fleetConnected = false
+
+    // 首次访问会同步读取 SharedPreferences，只在后台线程上首次访问
+    private val settingsManager by lazy { SettingsManager(context) }
+
+    // 黑匣子：每次连接一个会话，记录收发的原始帧
+    private val flightRoot = File(context.filesDir, "flight")
+    private val flightRecorder = FlightRecorder(flightRoot)
+    private var flightReplayer: FlightReplayer? = null
+    private var replayJob: Job? = null
 
     // 震动管理器
     private val vibrator: Vibrator? by lazy {
@@ -165,113 +273,272 @@ class RobotControllerImpl(private val context: Context) : Controller {
     // 连接任务
     private var connectJob: Job? = null
 
-    // 摇杆状态
-    private var currentLeftJoystick = JoystickValue.ZERO  // 左摇杆：vx, vy
-    private var currentRightJoystick = JoystickValue.ZERO  // 右摇杆：yawRate
-    private var lastCommandSent = false  // 跟踪是否发送过速度指令
+    // 设置加载完成前收到的连接请求（主线程访问）
+    private var connectAfterSettingsLoaded = false
 
-    // 速度发送任务
-    private var velocitySendJob: Job? = null
+    // 控制输入快照：左摇杆 vx, vy；右摇杆 yawRate
+    override val inputSnapshot = ControlInputSnapshot()
 
-    init {
-        // 设置ZMQ客户端回调
-        zmqClient.setMessageCallback { message ->
-            handleIncomingMessage(message)
-        }
+    override val odometryBuffer: OdometryBuffer
+        get() = zmqClient.getOdometryBuffer()
 
-        zmqClient.setConnectionStateCallback {
-            handleConnectionState(it)
+    // 里程计在接收线程写入缓冲区，这里按显示帧抽样发布到界面状态
+    private val odometryPublisher by lazy {
+        OdometryPublisher(zmqClient.getOdometryBuffer()) { state ->
+            settingsState.updateOdometry(state)
         }
+    }
+
+    // 以下仅在控制线程访问
+    private val inputFrame = ControlInputFrame()
+    private var lastCommandSent = false  // 跟踪是否发送过速度指令
+    private var lastMeasuredStickTimeNanos = 0L
+
+    // 摇杆事件到速度指令进入发送槽的时延，控制线程写入，性能浮层采样
+    private val inputToSendLatency = LatencyGauge()
+
+    // 速度发送控制循环，运行在独立线程上，不经过主线程
+    private val velocityLoop = ControlLoop(
+        name = "VelocityControlLoop",
+        rate = settingsState.settings.controlRate,
+        onStats = { stats -> handleControlLoopStats(stats) },
+        tick = { sendVelocityTick() }
+    )
+    private var lastReportedOverruns = 0L
+    private var lastReportedMissedDeadlines = 0L
+
+    init {
+        // 设置加载前先按默认设置建立主机器人会话
+        syncRobotSessions(settingsState.settings)
 
         // 启动时加载设置
         loadSettings()
     }
 
     /**
-     * 处理接收到的消息
+     * 按配置增删机器人会话，新会话注册订阅和回调；当前机器人变化时切换界面状态（主线程）
      */
-    private fun handleIncomingMessage(message: LeggedDriverMessage) {
-        when (message.message_type) {
-            MessageType.MESSAGE_TYPE_HEARTBEAT -> {
-                message.heartbeat?.let { heartbeat ->
-                    Timber.d("[Controller] 收到服务器心跳，连接状态: ${heartbeat.is_connected}")
-                }
-            }
-            MessageType.MESSAGE_TYPE_BATTERY_INFO -> {
-                message.battery_info?.let { batteryInfo ->
-                    settingsState.updateBatteryLevel(batteryInfo.battery_level)
-                    Timber.d("[Controller] 收到电池信息，电量: ${batteryInfo.battery_level}%")
-                }
-            }
-            MessageType.MESSAGE_TYPE_CURRENT_MODE -> {
-                message.current_mode?.let { currentModeMsg ->
-                    settingsState.updateRobotMode(currentModeMsg.mode)
-                    Timber.d("[Controller] 收到当前模式: ${currentModeMsg.mode}")
-                }
-            }
-            MessageType.MESSAGE_TYPE_CURRENT_CONTROL_MODE -> {
-                message.current_control_mode?.let { currentControlModeMsg ->
-                    settingsState.updateRobotCtrlMode(currentControlModeMsg.control_mode)
-                    Timber.d("[Controller] 收到当前控制模式: ${currentControlModeMsg.control_mode}")
-                }
-            }
-            else -> {
-//                Timber.d("[Controller] 收到其他消息类型: ${message.message_type}")
+    private fun syncRobotSessions(settings: AppSettings) {
+        val previous = robotSessions.active
+        val created = robotSessions.sync(settings.robots, settings.activeRobotId)
+        created.forEach { session ->
+            bindSession(session)
+            if (fleetConnected) connectSession(session)
+        }
+        settingsState.removeRobotConnectionStates(settings.robots.map { it.id }.toSet())
+        if (previous != null && previous !== robotSessions.active) {
+            onActiveSessionChanged(previous)
+        }
+    }
+
+    /**
+     * 注册会话的订阅和回调，只有当前操控的会话更新界面状态
+     */
+    private fun bindSession(session: RobotSession) {
+        val client = session.client
+        // 按消息类型订阅：界面状态按显示帧合并后在主线程更新，心跳只记录日志
+        client.subscribe(MessageType.MESSAGE_TYPE_HEARTBEAT, DeliveryMode.INLINE, ::handleHeartbeat)
+        client.subscribe(MessageType.MESSAGE_TYPE_BATTERY_INFO, DeliveryMode.MAIN_COALESCED) {
+            if (session === robotSessions.active) handleBatteryInfo(it)
+        }
+        client.subscribe(MessageType.MESSAGE_TYPE_CURRENT_MODE, DeliveryMode.MAIN_COALESCED) {
+            if (session === robotSessions.active) handleCurrentMode(it)
+        }
+        client.subscribe(MessageType.MESSAGE_TYPE_CURRENT_CONTROL_MODE, DeliveryMode.MAIN_COALESCED) {
+            if (session === robotSessions.active) handleCurrentControlMode(it)
+        }
+        // 里程计由ZMQ客户端写入缓冲区，按显示帧抽样发布，不在每条消息上更新界面状态
+
+        client.setConnectionStateCallback {
+            handleConnectionState(session, it)
+        }
+
+        // 黑匣子只记录当前操控的会话
+        if (session === robotSessions.active) {
+            client.setFlightRecorder(flightRecorder)
+        }
+
+        client.setLinkStatsCallback { stats ->
+            scope.launch {
+                if (session === robotSessions.active) settingsState.updateLinkStats(stats)
             }
         }
     }
 
     /**
-     * 处理连接状态
+     * 处理心跳消息（I/O线程）
+     */
+    private fun handleHeartbeat(message: LeggedDriverMessage) {
+        message.heartbeat?.let { heartbeat ->
+            HotLog.log(HotEvent.HEARTBEAT_RECEIVED, if (heartbeat.is_connected) 1 else 0)
+        }
+    }
+
+    /**
+     * 处理电池信息（主线程，每帧最多一次）
+     */
+    private fun handleBatteryInfo(message: LeggedDriverMessage) {
+        message.battery_info?.let { batteryInfo ->
+            settingsState.updateBatteryLevel(batteryInfo.battery_level)
+            HotLog.log(HotEvent.BATTERY_RECEIVED, batteryInfo.battery_level.toLong())
+        }
+    }
+
+    /**
+     * 处理机器人回报的当前模式（主线程，每帧最多一次）
+     */
+    private fun handleCurrentMode(message: LeggedDriverMessage) {
+        message.current_mode?.let { currentModeMsg ->
+            settingsState.updateRobotMode(currentModeMsg.mode)
+            HotLog.log(HotEvent.MODE_REPORTED, currentModeMsg.mode.value.toLong())
+        }
+    }
+
+    /**
+     * 处理机器人回报的当前控制模式（主线程，每帧最多一次）
+     */
+    private fun handleCurrentControlMode(message: LeggedDriverMessage) {
+        message.current_control_mode?.let { currentControlModeMsg ->
+            settingsState.updateRobotCtrlMode(currentControlModeMsg.control_mode)
+            HotLog.log(HotEvent.CONTROL_MODE_REPORTED, currentControlModeMsg.control_mode.value.toLong())
+        }
+    }
+
+    /**
+     * 处理会话的连接状态，后台会话只记录到各机器人的连接状态
      */
-    private fun handleConnectionState(state: ConnectionState) {
+    private fun handleConnectionState(session: RobotSession, state: ConnectionState) {
         scope.launch {
-            if (settingsState.connectionState == state) {
-                // 状态未变化，忽略
+            settingsState.updateRobotConnectionState(session.robotId, state)
+            if (session !== robotSessions.active) {
+                Timber.i("[Controller] 后台机器人${session.profile.name}连接状态: $state")
                 return@launch
             }
-            if (state == ConnectionState.CONNECTED) {
+            // 已连接后链路中断，导出断链前的热路径日志
+            if (settingsState.connectionState == ConnectionState.CONNECTED &&
+                (state == ConnectionState.RECONNECTING || state == ConnectionState.CONNECTION_FAILED)
+            ) {
+                HotLog.requestDump("link-lost")
+            }
+            applyConnectionState(state)
+        }
+    }
+
+    /**
+     * 把当前操控会话的连接状态应用到控制循环、里程计发布和界面状态（主线程）
+     */
+    private fun applyConnectionState(state: ConnectionState) {
+        if (settingsState.connectionState == state) {
+            // 状态未变化，忽略
+            return
+        }
+        when (state) {
+            ConnectionState.CONNECTED -> {
+                // 初次连接或重连恢复，模式以机器人回报的为准
+                settingsState.updateRobotModeChangingState(false)
+                settingsState.updateRobotCtrlModeChangingState(false)
                 startVelocityLoop()
-            } else {
+                odometryPublisher.start()
+                reportFirstControl("首次连接成功")
+            }
+            ConnectionState.RECONNECTING -> {
+                // 重连期间停止发送速度指令，里程计保持显示（会标记为过期）
+                stopVelocityLoop()
+            }
+            else -> {
                 stopVelocityLoop()
+                odometryPublisher.stop()
+                flightRecorder.stopSession()
+                // 启动时自动连接失败，界面已可操作（可手动重试）
+                reportFirstControl("自动连接失败 $state")
             }
-            settingsState.updateConnectionState(state)
-            Timber.i("[Controller] 连接状态更新: $state")
         }
+        settingsState.updateConnectionState(state)
+        Timber.i("[Controller] 连接状态更新: $state")
+    }
+
+    /**
+     * 切换操控的机器人：原会话已转入后台（补发零速度指令），界面状态换成新会话的缓存值
+     */
+    override fun switchRobot(robotId: String) {
+        if (robotId == robotSessions.active?.robotId) return
+        if (robotSessions.session(robotId) == null) {
+            Timber.w("[Controller] 未知的机器人: $robotId")
+            return
+        }
+        updateSettings(settingsState.settings.copy(activeRobotId = robotId))
+    }
+
+    /**
+     * 当前操控的会话变化后同步控制器状态（主线程）
+     */
+    private fun onActiveSessionChanged(previous: RobotSession) {
+        stopReplay()
+        val session = activeSession
+        val client = session.client
+
+        // 黑匣子按机器人分会话记录
+        previous.client.setFlightRecorder(null)
+        flightRecorder.stopSession()
+        client.setFlightRecorder(flightRecorder)
+        val state = client.getConnectionState()
+        if (settingsState.settings.flightRecorder &&
+            (state == ConnectionState.CONNECTED || state == ConnectionState.RECONNECTING)
+        ) {
+            flightRecorder.startSession()
+        }
+
+        // 新机器人还没有里程计时不保留上一台的位置
+        settingsState.updateOdometry(OdometryState())
+        odometryPublisher.buffer = client.getOdometryBuffer()
+        settingsState.updateBatteryLevel(client.getBatteryLevel())
+        settingsState.updateRobotMode(client.getCurrentMode())
+        settingsState.updateRobotCtrlMode(client.getCurrentControlMode())
+        settingsState.updateRobotModeChangingState(false)
+        settingsState.updateRobotCtrlModeChangingState(false)
+        settingsState.updateLinkStats(client.getLinkStats())
+        applyConnectionState(state)
+        Timber.i("[Controller] 操控对象切换为: ${session.profile.name} (${session.profile.endpoint})，连接状态: $state")
     }
 
     /**
      * 连接到机器人
      */
     override fun connect() {
+        if (!settingsState.isSettingsLoaded) {
+            // 设置还在后台加载，加载完成后用保存的地址连接
+            connectAfterSettingsLoaded = true
+            Timber.i("[Controller] 设置尚未加载完成，加载后自动连接")
+            return
+        }
+
         if (settingsState.connectionState == ConnectionState.CONNECTING) {
             Timber.w("[Controller] 正在连接中，忽略重复连接请求")
             return
         }
 
-        if (settingsState.connectionState == ConnectionState.CONNECTED) {
+        if (settingsState.connectionState == ConnectionState.CONNECTED ||
+            settingsState.connectionState == ConnectionState.RECONNECTING
+        ) {
             Timber.w("[Controller] 已经连接，忽略重复连接请求")
             return
         }
 
         cancelConnection() // 取消之前的连接任务
+        stopReplay()
 
         settingsState.updateConnectionState(ConnectionState.CONNECTING)
+        if (settingsState.settings.flightRecorder) {
+            flightRecorder.startSession()
+        }
 
         connectJob = scope.launch {
             try {
                 Timber.i("[Controller] 开始连接到机器人...")
 
-                // 构建连接地址
-                val endpoint = "tcp://${settingsState.settings.zmqIp}:${settingsState.settings.zmqPort}"
-                Timber.i("[Controller] 连接地址: $endpoint")
-
-                // 设置连接地址
-                zmqClient.setEndpoint(endpoint)
-
-                // 进行连接
-                zmqClient.connect()
-
+                // 全部机器人同时连接，后台会话只保持心跳，切换操控对象时无需重新连接
+                fleetConnected = true
+                robotSessions.all.forEach { connectSession(it) }
 
             } catch (e: CancellationException) {
                 settingsState.updateConnectionState(ConnectionState.DISCONNECTED)
@@ -283,17 +550,91 @@ class RobotControllerImpl(private val context: Context) : Controller {
         }
     }
 
+    /**
+     * 连接一个机器人会话，已连接或正在连接的会话不重复连接
+     */
+    private fun connectSession(session: RobotSession) {
+        val client = session.client
+        val state = client.getConnectionState()
+        if (state == ConnectionState.CONNECTED || state == ConnectionState.RECONNECTING ||
+            state == ConnectionState.CONNECTING
+        ) {
+            return
+        }
+
+        val settings = settingsState.settings
+        val robot = session.profile
+        Timber.i("[Controller] 连接地址: ${robot.name} ${robot.endpoint}")
+
+        // 设置连接地址，开启独立遥测通道时同一地址的遥测端口
+        client.setEndpoint(robot.endpoint)
+        client.setTelemetryEndpoint(
+            if (settings.splitTelemetry) "tcp://${robot.zmqIp}:${settings.telemetryPort}" else null
+        )
+        client.autoReconnect = settings.autoReconnect
+
+        // 进行连接
+        client.connect()
+    }
+
     /**
      * 断开连接
      */
     override fun disconnect() {
         cancelConnection()
         stopVelocityLoop()
-        zmqClient.disconnect()
+        odometryPublisher.stop()
+        fleetConnected = false
+        robotSessions.all.forEach { it.client.disconnect() }
+        flightRecorder.stopSession()
         settingsState.updateConnectionState(ConnectionState.DISCONNECTED)
         Timber.i("[Controller] 已断开连接")
     }
 
+    /**
+     * 回放最近一次黑匣子记录，入站帧经过ZMQ客户端的分发路径到达控制器和界面状态
+     */
+    override fun replayLastSession(speed: Double) {
+        if (settingsState.connectionState != ConnectionState.DISCONNECTED &&
+            settingsState.connectionState != ConnectionState.CONNECTION_FAILED &&
+            settingsState.connectionState != ConnectionState.CONNECTION_TIMEOUT
+        ) {
+            Timber.w("[Controller] 连接期间不能回放记录")
+            return
+        }
+        if (replayJob?.isActive == true) return
+
+        replayJob = scope.launch {
+            settingsState.updateReplaying(true)
+            try {
+                val report = withContext(Dispatchers.IO) {
+                    val session = FlightRecordReader.latestSession(flightRoot)
+                    if (session == null) {
+                        Timber.w("[Controller] 没有可回放的记录")
+                        return@withContext null
+                    }
+                    Timber.i("[Controller] 开始回放: ${session.name}, 倍速: $speed")
+                    val frames = FlightRecordReader.readSession(session)
+                    // 回放到当前操控的会话，经过与套接字相同的分发路径
+                    val replayer = FlightReplayer(zmqClient).also { flightReplayer = it }
+                    runInterruptible { replayer.run(frames, speed) }
+                }
+                report?.let {
+                    Timber.i("[Controller] 回放结束: 入站${it.inboundFrames}帧, 出站${it.outboundFrames}帧, " +
+                            "校验失败${it.invalidFrames}帧, 分发耗时${it.dispatchNanosPerFrame}ns/帧")
+                }
+            } finally {
+                settingsState.updateReplaying(false)
+            }
+        }
+    }
+
+    override fun stopReplay() {
+        flightReplayer?.cancel()
+        replayJob?.cancel()
+        replayJob = null
+    }
+
     /**
      * 取消连接
      */
@@ -318,16 +659,22 @@ class RobotControllerImpl(private val context: Context) : Controller {
 
         settingsState.updateRobotModeChangingState(true)
 
+        val session = activeSession
         scope.launch {
             try {
-                val success = zmqClient.setMode(mode)
-                if (success) {
-                    Timber.i("[Controller] 模式设置请求已发送: $mode")
-                    // 实际模式更新由消息回调处理
+                val result = session.client.setMode(mode).awaitResult()
+                // 等待确认期间切换了操控对象，结果不属于当前界面
+                if (session !== robotSessions.active) return@launch
+                settingsState.updateRobotModeChangingState(false)
+                if (result.isSuccess) {
+                    // 收到确认即更新界面，不等待下一次状态广播
+                    settingsState.updateRobotMode(mode)
+                    Timber.i("[Controller] 模式设置已确认: $mode，耗时${result.latencyMs}ms，发送${result.attempts}次")
                 } else {
-                    settingsState.updateRobotModeChangingState(false)
-                    Timber.e("[Controller] 模式设置失败: $mode")
+                    Timber.e("[Controller] 模式设置失败: $mode，${result.status.displayName} ${result.reason}")
                 }
+            } catch (e: CancellationException) {
+                throw e
             } catch (e: Exception) {
                 settingsState.updateRobotModeChangingState(false)
                 Timber.e(e, "[Controller] 设置模式异常: $mode")
@@ -351,16 +698,22 @@ class RobotControllerImpl(private val context: Context) : Controller {
 
         settingsState.updateRobotCtrlModeChangingState(true)
 
+        val session = activeSession
         scope.launch {
             try {
-                val success = zmqClient.setControlMode(controlMode)
-                if (success) {
-                    Timber.i("[Controller] 控制模式设置请求已发送: $controlMode")
-                    // 实际控制模式更新由消息回调处理
+                val result = session.client.setControlMode(controlMode).awaitResult()
+                // 等待确认期间切换了操控对象，结果不属于当前界面
+                if (session !== robotSessions.active) return@launch
+                settingsState.updateRobotCtrlModeChangingState(false)
+                if (result.isSuccess) {
+                    // 收到确认即更新界面，不等待下一次状态广播
+                    settingsState.updateRobotCtrlMode(controlMode)
+                    Timber.i("[Controller] 控制模式设置已确认: $controlMode，耗时${result.latencyMs}ms，发送${result.attempts}次")
                 } else {
-                    settingsState.updateRobotCtrlModeChangingState(false)
-                    Timber.e("[Controller] 控制模式设置失败: $controlMode")
+                    Timber.e("[Controller] 控制模式设置失败: $controlMode，${result.status.displayName} ${result.reason}")
                 }
+            } catch (e: CancellationException) {
+                throw e
             } catch (e: Exception) {
                 settingsState.updateRobotCtrlModeChangingState(false)
                 Timber.e(e, "[Controller] 设置控制模式异常: $controlMode")
@@ -372,32 +725,28 @@ class RobotControllerImpl(private val context: Context) : Controller {
      * 更新左摇杆（移动控制：vx, vy）
      */
     override fun updateLeftJoystick(joystickValue: JoystickValue) {
-        currentLeftJoystick = joystickValue
-        Timber.v("[Controller] 左摇杆更新: vx=${joystickValue.x}, vy=${joystickValue.y}")
+        inputSnapshot.updateLeftStick(joystickValue.x, joystickValue.y)
     }
 
     /**
      * 更新右摇杆（转向控制：yawRate）
      */
     override fun updateRightJoystick(joystickValue: JoystickValue) {
-        currentRightJoystick = joystickValue
-        Timber.v("[Controller] 右摇杆更新: yawRate=${joystickValue.x}")
+        inputSnapshot.updateRightStick(joystickValue.x, joystickValue.y)
     }
 
     /**
-     * 左摇杆释放回调
+     * 左摇杆释放回调，回零已由摇杆组件通过 [updateLeftJoystick] 写入
      */
     override fun onLeftJoystickReleased() {
-        currentLeftJoystick = JoystickValue.ZERO
         triggerVibration(JOYSTICK_RELEASE_VIBRATION_MS, VIBRATION_AMPLITUDE_RELEASE)
         Timber.d("[Controller] 左摇杆已释放，触发震动反馈")
     }
 
     /**
-     * 右摇杆释放回调
+     * 右摇杆释放回调，回零已由摇杆组件通过 [updateRightJoystick] 写入
      */
     override fun onRightJoystickReleased() {
-        currentRightJoystick = JoystickValue.ZERO
         triggerVibration(JOYSTICK_RELEASE_VIBRATION_MS, VIBRATION_AMPLITUDE_RELEASE)
         Timber.d("[Controller] 右摇杆已释放，触发震动反馈")
     }
@@ -423,6 +772,7 @@ class RobotControllerImpl(private val context: Context) : Controller {
      */
     override fun setSpeedLevel(level: SpeedLevel) {
         settingsState.setSpeedLevel(level)
+        inputSnapshot.updateSpeedLevel(level)
         // 自动保存更新后的设置
         saveSettings(settingsState.settings)
         Timber.i("[Controller] 已切换到${level.displayName}并保存设置")
@@ -433,6 +783,10 @@ class RobotControllerImpl(private val context: Context) : Controller {
      */
     override fun updateSettings(settings: AppSettings) {
         settingsState.updateSettings(settings)
+        inputSnapshot.updateSpeedLevel(settings.speedLevel)
+        velocityLoop.setRate(settings.controlRate)
+        syncRobotSessions(settings)
+        robotSessions.all.forEach { it.client.autoReconnect = settings.autoReconnect }
         // 自动保存设置
         saveSettings(settings)
         Timber.d("[Controller] 设置已更新并保存")
@@ -442,15 +796,40 @@ class RobotControllerImpl(private val context: Context) : Controller {
      * 加载设置
      */
     override fun loadSettings() {
-        try {
-            val settings = settingsManager.loadSettings()
+        scope.launch {
+            val settings = try {
+                withContext(Dispatchers.IO) { settingsManager.loadSettings() }
+            } catch (e: Exception) {
+                Timber.e(e, "[Controller] 加载设置失败，使用默认设置")
+                AppSettings()
+            }
             settingsState.updateSettings(settings)
+            inputSnapshot.updateSpeedLevel(settings.speedLevel)
+            syncRobotSessions(settings)
+            robotSessions.all.forEach { it.client.autoReconnect = settings.autoReconnect }
+            settingsState.updateSettingsLoaded(true)
             Timber.i("[Controller] 设置已从存储中加载: $settings")
-        } catch (e: Exception) {
-            Timber.e(e, "[Controller] 加载设置失败，使用默认设置")
+
+            if (settings.autoConnect || connectAfterSettingsLoaded) {
+                connectAfterSettingsLoaded = false
+                Timber.i("[Controller] 启动时自动连接: ${settings.robots.joinToString { it.endpoint }}")
+                connect()
+            } else {
+                reportFirstControl("设置加载完成")
+            }
         }
     }
 
+    /**
+     * 记录进程启动到可以操控的耗时，每个进程只记录一次
+     */
+    private fun reportFirstControl(reason: String) {
+        if (settingsState.timeToFirstControlMs >= 0) return
+        val elapsedMs = SystemClock.uptimeMillis() - Process.getStartUptimeMillis()
+        settingsState.updateTimeToFirstControl(elapsedMs)
+        Timber.i("[Controller] 启动到可操控耗时: ${elapsedMs}ms（$reason）")
+    }
+
     /**
      * 保存设置
      */
@@ -475,46 +854,84 @@ class RobotControllerImpl(private val context: Context) : Controller {
      */
     private fun startVelocityLoop() {
         stopVelocityLoop()
+        velocityLoop.setRate(settingsState.settings.controlRate)
+        velocityLoop.start()
+    }
 
-        velocitySendJob = scope.launch {
-            while (isActive && settingsState.isConnected) {
-                try {
-                    // 只有在手动模式下才发送速度指令
-                    if (settingsState.robotMode == Mode.MODE_MANUAL) {
-                        // 检查是否有摇杆被按下（不在中心位置）
-                        val leftJoystickPressed = !currentLeftJoystick.isCenter
-                        val rightJoystickPressed = !currentRightJoystick.isCenter
-
-                        // 只有当至少有一个摇杆被按下时才发送速度指令
-                        if (leftJoystickPressed || rightJoystickPressed) {
-                            // 计算速度参数，使用速度档位设置的最大线速度
-                            val maxSpeed = settingsState.settings.speedLevel.maxLinearSpeed
-                            val vx = -currentLeftJoystick.y * maxSpeed
-                            val vy = -currentLeftJoystick.x * maxSpeed
-                            val yawRate = -currentRightJoystick.x * maxSpeed // 使用右摇杆的X轴作为角速度
-
-                            // 发送速度指令
-                            zmqClient.sendVelocityCommand(vx, vy, yawRate)
-                            Timber.v("[Controller] 发送速度指令: vx=$vx, vy=$vy, yawRate=$yawRate")
-                            lastCommandSent = true
-                        } else if (lastCommandSent) {
-                            // 只有之前发送过指令，且现在摇杆都在中心位置时，才发送一次停止指令
-                            zmqClient.sendVelocityCommand(0f, 0f, 0f)
-                            Timber.v("[Controller] 发送停止指令")
-                            lastCommandSent = false
-                        }
-                        // 如果摇杆都在中心位置且之前没有发送过指令，则不发送任何指令
-                    }
+    /**
+     * 控制线程上每个周期执行一次：读取摇杆并直接交给ZMQ发送槽
+     */
+    private fun sendVelocityTick() {
+        if (!settingsState.isConnected) return
+
+        // 只有在手动模式下才发送速度指令
+        if (settingsState.robotMode != Mode.MODE_MANUAL) return
+
+        // 读取一致的输入帧，不分配内存
+        val input = inputFrame
+        inputSnapshot.read(input)
+
+        // 检查是否有摇杆被按下（不在中心位置）
+        val leftJoystickPressed = !input.isLeftCenter
+        val rightJoystickPressed = !input.isRightCenter
+
+        // 只有当至少有一个摇杆被按下时才发送速度指令
+        if (leftJoystickPressed || rightJoystickPressed) {
+            // 计算速度参数，使用速度档位设置的最大线速度
+            val maxSpeed = input.speedLevel.maxLinearSpeed
+            val vx = -input.leftY * maxSpeed
+            val vy = -input.leftX * maxSpeed
+            val yawRate = -input.rightX * maxSpeed // 使用右摇杆的X轴作为角速度
+
+            // 发送速度指令
+            zmqClient.sendVelocityCommand(vx, vy, yawRate)
+            recordInputToSend(input)
+            HotLog.log(HotEvent.VELOCITY_SENT, HotLog.bits(vx), HotLog.bits(vy), HotLog.bits(yawRate))
+            lastCommandSent = true
+        } else if (lastCommandSent) {
+            // 只有之前发送过指令，且现在摇杆都在中心位置时，才发送一次停止指令
+            zmqClient.sendVelocityCommand(0f, 0f, 0f)
+            recordInputToSend(input)
+            HotLog.log(HotEvent.STOP_SENT)
+            lastCommandSent = false
+        }
+        // 如果摇杆都在中心位置且之前没有发送过指令，则不发送任何指令
+    }
 
-                    delay(50) // 20Hz发送频率
+    /**
+     * 记录输入到发送的时延，每个摇杆样本只计一次，摇杆静止期间不累计等待时间
+     */
+    private fun recordInputToSend(input: ControlInputFrame) {
+        val sampleTime = input.stickTimeNanos
+        if (sampleTime == 0L || sampleTime == lastMeasuredStickTimeNanos) return
+        lastMeasuredStickTimeNanos = sampleTime
+        inputToSendLatency.record((System.nanoTime() - sampleTime) / 1000)
+    }
+
+    override fun samplePerf(): PerfSnapshot = PerfSnapshot(
+        timeNanos = System.nanoTime(),
+        controlLoop = settingsState.controlLoopStats,
+        inputToSendUs = inputToSendLatency.drain(),
+        sendQueueSize = zmqClient.getSendQueueSize(),
+        consecutiveFailures = zmqClient.getConsecutiveFailures(),
+        linkStats = settingsState.linkStats,
+        linkCounters = zmqClient.getLinkCounters(),
+        gcCount = RuntimeCounters.gcCount()
+    )
 
-                } catch (e: CancellationException) {
-                    break
-                } catch (e: Exception) {
-                    Timber.e(e, "[Controller] 速度发送异常")
-                    delay(100) // 出错时稍微等待一下
-                }
-            }
+    /**
+     * 处理控制循环统计（控制线程），出现超时或丢周期时记录日志
+     */
+    private fun handleControlLoopStats(stats: ControlLoopStats) {
+        if (stats.overruns != lastReportedOverruns || stats.missedDeadlines != lastReportedMissedDeadlines) {
+            Timber.w("[Controller] 控制循环超时: 超时${stats.overruns - lastReportedOverruns}次, " +
+                    "丢失周期${stats.missedDeadlines - lastReportedMissedDeadlines}个, " +
+                    "最大延迟${stats.maxLatenessUs}us, 最大耗时${stats.maxWorkUs}us")
+            lastReportedOverruns = stats.overruns
+            lastReportedMissedDeadlines = stats.missedDeadlines
+        }
+        scope.launch {
+            settingsState.updateControlLoopStats(stats)
         }
     }
 
@@ -522,8 +939,7 @@ class RobotControllerImpl(private val context: Context) : Controller {
      * 停止速度发送循环
      */
     private fun stopVelocityLoop() {
-        velocitySendJob?.cancel()
-        velocitySendJob = null
+        velocityLoop.stop()
         lastCommandSent = false  // 重置命令发送标志
     }
 
@@ -531,7 +947,9 @@ class RobotControllerImpl(private val context: Context) : Controller {
      * 清理资源
      */
     override fun cleanup() {
+        stopReplay()
         disconnect()
+        robotSessions.close()
         supervisorJob.cancel()
     }
 
@@ -0,0 +1,69 @@
+/*********************************************************************************
+ * FileName: PerfSnapshot.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 性能浮层的采样快照，以及由相邻两次采样计算的速率
+ * Others: 累计计数在采样方求差，热路径上不做除法和时间窗口管理
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.controller
+
+import com.helywin.leggedjoystick.metrics.LatencySummary
+import com.helywin.leggedjoystick.zmq.LinkCountersSnapshot
+import com.helywin.leggedjoystick.zmq.LinkStatsSnapshot
+import legged_driver.MessageType
+
+/**
+ * 控制器侧的一次性能采样
+ *
+ * @param timeNanos 采样时刻（System.nanoTime）
+ * @param inputToSendUs 摇杆事件时间到速度指令进入发送槽的时延（本次采样窗口）
+ * @param gcCount 进程启动以来的GC次数，不可用时为 -1
+ */
+data class PerfSnapshot(
+    val timeNanos: Long,
+    val controlLoop: ControlLoopStats = ControlLoopStats(),
+    val inputToSendUs: LatencySummary = LatencySummary(),
+    val sendQueueSize: Int = 0,
+    val consecutiveFailures: Int = 0,
+    val linkStats: LinkStatsSnapshot = LinkStatsSnapshot(),
+    val linkCounters: LinkCountersSnapshot = LinkCountersSnapshot(LongArray(MessageType.entries.size), 0, 0),
+    val gcCount: Long = -1
+)
+
+/**
+ * 相邻两次采样之间的速率
+ *
+ * @param receiveHz 各消息类型的接收频率（按 [MessageType.ordinal]）
+ * @param decodeFailures 区间内校验失败的帧数
+ * @param droppedFrames 区间内丢弃的速度指令帧数
+ * @param gcCount 区间内的GC次数
+ */
+class PerfRates(
+    val receiveHz: FloatArray,
+    val decodeFailures: Long,
+    val droppedFrames: Long,
+    val gcCount: Long
+) {
+    fun receiveHz(type: MessageType): Float = receiveHz[type.ordinal]
+}
+
+/**
+ * 根据上一次采样计算区间速率
+ */
+fun PerfSnapshot.ratesSince(previous: PerfSnapshot?): PerfRates {
+    val types = linkCounters.receivedByType.size
+    if (previous == null || timeNanos <= previous.timeNanos) {
+        return PerfRates(FloatArray(types), 0, 0, 0)
+    }
+    val seconds = (timeNanos - previous.timeNanos) / 1e9f
+    val current = linkCounters
+    val before = previous.linkCounters
+    return PerfRates(
+        receiveHz = FloatArray(types) { ((current.receivedByType[it] - before.receivedByType[it]) / seconds).coerceAtLeast(0f) },
+        decodeFailures = (current.decodeFailures - before.decodeFailures).coerceAtLeast(0),
+        droppedFrames = (current.droppedFrames - before.droppedFrames).coerceAtLeast(0),
+        gcCount = if (gcCount < 0 || previous.gcCount < 0) 0 else gcCount - previous.gcCount
+    )
+}
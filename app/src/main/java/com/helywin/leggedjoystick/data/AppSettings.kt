@@ -18,6 +18,61 @@ enum class SpeedLevel(val displayName: String, val maxLinearSpeed: Float) {
     FAST("快速", 2.0f)
 }
 
+/**
+ * 速度指令控制频率枚举
+ */
+enum class ControlRate(val displayName: String, val hz: Int) {
+    HZ_20("20 Hz", 20),
+    HZ_50("50 Hz", 50),
+    HZ_100("100 Hz", 100);
+
+    val periodNanos: Long
+        get() = 1_000_000_000L / hz
+}
+
+/**
+ * 视频播放配置，在画面流畅度和端到端延迟之间取舍
+ *
+ * @param networkCachingMs 网络缓冲时长
+ * @param clockJitterMs 时钟抖动容忍度，超过后重新同步时钟而不是等待
+ * @param clockSynchro 是否与流时钟同步，关闭后解码完成即显示
+ * @param dropLateFrames 是否丢弃迟到帧和跳帧以追上实时画面
+ * @param preferUdp RTSP是否优先使用UDP传输（无数据时回退TCP），否则固定TCP
+ * @param forceHwDecoder 是否强制使用MediaCodec硬件解码
+ */
+enum class VideoProfile(
+    val displayName: String,
+    val networkCachingMs: Int,
+    val clockJitterMs: Int,
+    val clockSynchro: Boolean,
+    val dropLateFrames: Boolean,
+    val preferUdp: Boolean,
+    val forceHwDecoder: Boolean
+) {
+    SMOOTH("流畅", 300, 5000, true, false, false, false),
+    BALANCED("均衡", 150, 500, true, true, false, false),
+    LOW_LATENCY("低延迟遥操作", 50, 0, false, true, true, true)
+}
+
+/**
+ * 机器人连接配置
+ * 主机器人使用 [AppSettings] 中的 zmqIp / zmqPort / rtspUrl，其他机器人保存在 [AppSettings.extraRobots]
+ */
+data class RobotProfile(
+    val id: String,
+    val name: String,
+    val zmqIp: String,
+    val zmqPort: Int,
+    val rtspUrl: String
+) {
+    val endpoint: String
+        get() = "tcp://$zmqIp:$zmqPort"
+
+    companion object {
+        const val PRIMARY_ID = "primary"
+    }
+}
+
 /**
  * 应用设置数据类
  */
@@ -28,8 +83,26 @@ data class AppSettings(
     val rtspUrl: String = "rtsp://192.168.234.1:8554/test",
     val mainTitle: String = "机器狗遥控器",
     val logoPath: String = "",
-    val keepScreenOn: Boolean = true
+    val keepScreenOn: Boolean = true,
+    val controlRate: ControlRate = ControlRate.HZ_20,
+    val videoProfile: VideoProfile = VideoProfile.SMOOTH,
+    val autoReconnect: Boolean = true,
+    val splitTelemetry: Boolean = false, // 里程计、电量等遥测走独立的 PUB/SUB 通道
+    val telemetryPort: Int = 33446,
+    val showPerfHud: Boolean = false, // 在所有界面上叠加性能浮层
+    val flightRecorder: Boolean = true, // 记录每次连接收发的原始帧，用于事后分析和回放
+    val autoConnect: Boolean = false, // 启动并加载设置后用上次的地址自动连接
+    val extraRobots: List<RobotProfile> = emptyList(), // 其他机器人，连接后全部保持会话，可随时切换操控
+    val activeRobotId: String = RobotProfile.PRIMARY_ID
 ) {
+    // 全部机器人，主机器人在最前
+    val robots: List<RobotProfile>
+        get() = listOf(RobotProfile(RobotProfile.PRIMARY_ID, "主机器人", zmqIp, zmqPort, rtspUrl)) + extraRobots
+
+    // 当前操控的机器人，配置中找不到时为主机器人
+    val activeRobot: RobotProfile
+        get() = robots.firstOrNull { it.id == activeRobotId } ?: robots.first()
+
     // 保持向后兼容的属性，狂暴模式现在等同于快速模式
     val isRageModeEnabled: Boolean
         get() = speedLevel == SpeedLevel.FAST
@@ -42,6 +115,7 @@ enum class ConnectionState(val displayName: String) {
     DISCONNECTED("已断开"),
     CONNECTING("连接中..."),
     CONNECTED("已连接"),
+    RECONNECTING("重连中..."),
     CONNECTION_FAILED("连接失败"),
     CONNECTION_TIMEOUT("连接超时")
 }
@@ -11,6 +11,8 @@ package com.helywin.leggedjoystick.data
 
 import android.content.Context
 import android.content.SharedPreferences
+import com.google.gson.Gson
+import com.google.gson.reflect.TypeToken
 import timber.log.Timber
 import androidx.core.content.edit
 
@@ -27,6 +29,16 @@ class SettingsManager(context: Context) {
         private const val KEY_MAIN_TITLE = "main_title"
         private const val KEY_LOGO_PATH = "logo_path"
         private const val KEY_KEEP_SCREEN_ON = "keep_screen_on"
+        private const val KEY_CONTROL_RATE = "control_rate"
+        private const val KEY_VIDEO_PROFILE = "video_profile"
+        private const val KEY_AUTO_RECONNECT = "auto_reconnect"
+        private const val KEY_SPLIT_TELEMETRY = "split_telemetry"
+        private const val KEY_TELEMETRY_PORT = "telemetry_port"
+        private const val KEY_SHOW_PERF_HUD = "show_perf_hud"
+        private const val KEY_FLIGHT_RECORDER = "flight_recorder"
+        private const val KEY_AUTO_CONNECT = "auto_connect"
+        private const val KEY_EXTRA_ROBOTS = "extra_robots"
+        private const val KEY_ACTIVE_ROBOT_ID = "active_robot_id"
 
         // 默认配置
         private const val DEFAULT_ZMQ_IP = "127.0.0.1"
@@ -35,11 +47,19 @@ class SettingsManager(context: Context) {
         private const val DEFAULT_MAIN_TITLE = "机器狗遥控器"
         private const val DEFAULT_LOGO_PATH = ""
         private const val DEFAULT_KEEP_SCREEN_ON = true
+        private const val DEFAULT_AUTO_RECONNECT = true
+        private const val DEFAULT_SPLIT_TELEMETRY = false
+        private const val DEFAULT_TELEMETRY_PORT = 33446
+        private const val DEFAULT_SHOW_PERF_HUD = false
+        private const val DEFAULT_FLIGHT_RECORDER = true
+        private const val DEFAULT_AUTO_CONNECT = false
     }
 
     private val sharedPreferences: SharedPreferences =
         context.getSharedPreferences(PREFS_NAME, Context.MODE_PRIVATE)
 
+    private val gson = Gson()
+
     /**
      * 保存应用设置
      */
@@ -53,6 +73,16 @@ class SettingsManager(context: Context) {
                 putString(KEY_MAIN_TITLE, settings.mainTitle)
                 putString(KEY_LOGO_PATH, settings.logoPath)
                 putBoolean(KEY_KEEP_SCREEN_ON, settings.keepScreenOn)
+                putString(KEY_CONTROL_RATE, settings.controlRate.name)
+                putString(KEY_VIDEO_PROFILE, settings.videoProfile.name)
+                putBoolean(KEY_AUTO_RECONNECT, settings.autoReconnect)
+                putBoolean(KEY_SPLIT_TELEMETRY, settings.splitTelemetry)
+                putInt(KEY_TELEMETRY_PORT, settings.telemetryPort)
+                putBoolean(KEY_SHOW_PERF_HUD, settings.showPerfHud)
+                putBoolean(KEY_FLIGHT_RECORDER, settings.flightRecorder)
+                putBoolean(KEY_AUTO_CONNECT, settings.autoConnect)
+                putString(KEY_EXTRA_ROBOTS, gson.toJson(settings.extraRobots))
+                putString(KEY_ACTIVE_ROBOT_ID, settings.activeRobotId)
                 apply()
             }
             Timber.d("设置已保存: $settings")
@@ -74,6 +104,22 @@ class SettingsManager(context: Context) {
                 SpeedLevel.MEDIUM
             }
 
+            val controlRateName = sharedPreferences.getString(KEY_CONTROL_RATE, ControlRate.HZ_20.name)
+            val controlRate = try {
+                ControlRate.valueOf(controlRateName ?: ControlRate.HZ_20.name)
+            } catch (e: IllegalArgumentException) {
+                Timber.w("无效的控制频率: $controlRateName，使用默认值")
+                ControlRate.HZ_20
+            }
+
+            val videoProfileName = sharedPreferences.getString(KEY_VIDEO_PROFILE, VideoProfile.SMOOTH.name)
+            val videoProfile = try {
+                VideoProfile.valueOf(videoProfileName ?: VideoProfile.SMOOTH.name)
+            } catch (e: IllegalArgumentException) {
+                Timber.w("无效的视频播放配置: $videoProfileName，使用默认值")
+                VideoProfile.SMOOTH
+            }
+
             AppSettings(
                 zmqIp = sharedPreferences.getString(KEY_ZMQ_IP, DEFAULT_ZMQ_IP) ?: DEFAULT_ZMQ_IP,
                 zmqPort = sharedPreferences.getInt(KEY_ZMQ_PORT, DEFAULT_ZMQ_PORT),
@@ -81,7 +127,18 @@ class SettingsManager(context: Context) {
                 rtspUrl = sharedPreferences.getString(KEY_RTSP_URL, DEFAULT_RTSP_URL) ?: DEFAULT_RTSP_URL,
                 mainTitle = sharedPreferences.getString(KEY_MAIN_TITLE, DEFAULT_MAIN_TITLE) ?: DEFAULT_MAIN_TITLE,
                 logoPath = sharedPreferences.getString(KEY_LOGO_PATH, DEFAULT_LOGO_PATH) ?: DEFAULT_LOGO_PATH,
-                keepScreenOn = sharedPreferences.getBoolean(KEY_KEEP_SCREEN_ON, DEFAULT_KEEP_SCREEN_ON)
+                keepScreenOn = sharedPreferences.getBoolean(KEY_KEEP_SCREEN_ON, DEFAULT_KEEP_SCREEN_ON),
+                controlRate = controlRate,
+                videoProfile = videoProfile,
+                autoReconnect = sharedPreferences.getBoolean(KEY_AUTO_RECONNECT, DEFAULT_AUTO_RECONNECT),
+                splitTelemetry = sharedPreferences.getBoolean(KEY_SPLIT_TELEMETRY, DEFAULT_SPLIT_TELEMETRY),
+                telemetryPort = sharedPreferences.getInt(KEY_TELEMETRY_PORT, DEFAULT_TELEMETRY_PORT),
+                showPerfHud = sharedPreferences.getBoolean(KEY_SHOW_PERF_HUD, DEFAULT_SHOW_PERF_HUD),
+                flightRecorder = sharedPreferences.getBoolean(KEY_FLIGHT_RECORDER, DEFAULT_FLIGHT_RECORDER),
+                autoConnect = sharedPreferences.getBoolean(KEY_AUTO_CONNECT, DEFAULT_AUTO_CONNECT),
+                extraRobots = loadExtraRobots(),
+                activeRobotId = sharedPreferences.getString(KEY_ACTIVE_ROBOT_ID, RobotProfile.PRIMARY_ID)
+                    ?: RobotProfile.PRIMARY_ID
             ).also {
                 Timber.d("设置已加载: $it")
             }
@@ -91,6 +148,25 @@ class SettingsManager(context: Context) {
         }
     }
 
+    /**
+     * 加载其他机器人列表（JSON），字段缺失或格式错误的条目丢弃
+     */
+    private fun loadExtraRobots(): List<RobotProfile> {
+        val json = sharedPreferences.getString(KEY_EXTRA_ROBOTS, null) ?: return emptyList()
+        return try {
+            val type = object : TypeToken<List<RobotProfile>>() {}.type
+            // Gson 不经过 Kotlin 构造函数，非空字段可能为 null
+            @Suppress("SENSELESS_COMPARISON")
+            gson.fromJson<List<RobotProfile>>(json, type).orEmpty().filter {
+                it.id != null && it.name != null && it.zmqIp != null && it.rtspUrl != null &&
+                        it.id != RobotProfile.PRIMARY_ID
+            }
+        } catch (e: Exception) {
+            Timber.w(e, "无效的机器人列表，忽略")
+            emptyList()
+        }
+    }
+
     /**
      * 检查是否是首次启动
      */
@@ -9,10 +9,17 @@
 
 package com.helywin.leggedjoystick.input
 
+import android.os.Build
+import android.util.SparseArray
 import android.view.InputDevice
 import android.view.KeyEvent
 import android.view.MotionEvent
 import androidx.compose.runtime.*
+import com.helywin.leggedjoystick.controller.ControlInputSnapshot
+import com.helywin.leggedjoystick.log.HotEvent
+import com.helywin.leggedjoystick.log.HotLog
+import com.helywin.leggedjoystick.trace.PerfTrace
+import com.helywin.leggedjoystick.trace.TraceNames
 import com.helywin.leggedjoystick.ui.joystick.JoystickValue
 import timber.log.Timber
 import kotlin.math.abs
@@ -66,9 +73,6 @@ class GamepadInputState {
  */
 class GamepadInputHandler {
     companion object {
-        // 摇杆死区，小于此值的输入将被忽略
-        private const val DEADZONE_THRESHOLD = 0.1f
-        
         // 支持的游戏手柄轴
         private const val AXIS_LEFT_X = MotionEvent.AXIS_X
         private const val AXIS_LEFT_Y = MotionEvent.AXIS_Y
@@ -78,6 +82,42 @@ class GamepadInputHandler {
         // 备用右摇杆轴（某些设备可能使用不同的轴）
         private const val AXIS_RIGHT_X_ALT = MotionEvent.AXIS_RX
         private const val AXIS_RIGHT_Y_ALT = MotionEvent.AXIS_RY
+
+        // 轴在缓存中的下标
+        private const val INDEX_LEFT_X = 0
+        private const val INDEX_LEFT_Y = 1
+        private const val INDEX_RIGHT_X = 2
+        private const val INDEX_RIGHT_Y = 3
+        private const val AXIS_COUNT = StickFilter.AXIS_COUNT
+    }
+
+    /**
+     * 单个输入设备的摇杆轴范围缓存
+     * 右摇杆在设备支持主要轴（Z/RZ）时使用主要轴，否则使用备用轴（RX/RY）
+     */
+    private class DeviceAxisRanges(device: InputDevice, source: Int) {
+        val axes = IntArray(AXIS_COUNT)
+        val min = FloatArray(AXIS_COUNT)
+        val span = FloatArray(AXIS_COUNT)
+        val flat = FloatArray(AXIS_COUNT)
+        val present = BooleanArray(AXIS_COUNT)
+
+        init {
+            val useAltRightAxes = device.getMotionRange(AXIS_RIGHT_X, source) == null &&
+                    device.getMotionRange(AXIS_RIGHT_X_ALT, source) != null
+            axes[INDEX_LEFT_X] = AXIS_LEFT_X
+            axes[INDEX_LEFT_Y] = AXIS_LEFT_Y
+            axes[INDEX_RIGHT_X] = if (useAltRightAxes) AXIS_RIGHT_X_ALT else AXIS_RIGHT_X
+            axes[INDEX_RIGHT_Y] = if (useAltRightAxes) AXIS_RIGHT_Y_ALT else AXIS_RIGHT_Y
+
+            for (i in 0 until AXIS_COUNT) {
+                val range = device.getMotionRange(axes[i], source) ?: continue
+                present[i] = true
+                min[i] = range.min
+                span[i] = range.max - range.min
+                flat[i] = range.flat
+            }
+        }
     }
     
     // 输入状态
@@ -89,6 +129,23 @@ class GamepadInputHandler {
     
     // 按键事件回调
     private var keyEventCallback: ((Int, Boolean) -> Unit)? = null
+
+    // 控制输入快照，摇杆和按键直接写入，不经过回调
+    private var inputSnapshot: ControlInputSnapshot? = null
+
+    // 按设备ID缓存的轴范围
+    private val deviceAxisRanges = SparseArray<DeviceAxisRanges>()
+
+    // 摇杆滤波 [leftX, leftY, rightX, rightY]
+    private val stickFilter = StickFilter()
+    private val sampleAxes = FloatArray(AXIS_COUNT)
+
+    /**
+     * 绑定控制输入快照
+     */
+    fun attachInputSnapshot(snapshot: ControlInputSnapshot) {
+        inputSnapshot = snapshot
+    }
     
     /**
      * 设置左摇杆变化回调
@@ -121,7 +178,14 @@ class GamepadInputHandler {
         if (!isGamepadEvent(event)) {
             return false
         }
-        
+
+        PerfTrace.counter(TraceNames.INPUT_BATCH_SAMPLES, event.historySize + 1)
+        return PerfTrace.section(TraceNames.INPUT_MOTION_EVENT) {
+            processMotionEvent(event)
+        }
+    }
+
+    private fun processMotionEvent(event: MotionEvent): Boolean {
         try {
             // 更新设备连接状态
             val device = event.device
@@ -130,36 +194,55 @@ class GamepadInputHandler {
                 Timber.i("[GamepadInput] 检测到游戏手柄: ${device.name}")
             }
             
-            // 获取左摇杆值
-            val leftX = getCenteredAxis(event, AXIS_LEFT_X)
-            val leftY = getCenteredAxis(event, AXIS_LEFT_Y)
-            val leftJoystick = JoystickValue(leftX, leftY)
-            
-            // 获取右摇杆值（尝试主要轴和备用轴）
-            var rightX = getCenteredAxis(event, AXIS_RIGHT_X)
-            var rightY = getCenteredAxis(event, AXIS_RIGHT_Y)
-            
-            // 如果主要轴没有值，尝试备用轴
-            if (abs(rightX) < DEADZONE_THRESHOLD && abs(rightY) < DEADZONE_THRESHOLD) {
-                rightX = getCenteredAxis(event, AXIS_RIGHT_X_ALT)
-                rightY = getCenteredAxis(event, AXIS_RIGHT_Y_ALT)
+            val ranges = getAxisRanges(event)
+
+            // 依次处理批量历史样本和当前样本
+            val historySize = event.historySize
+            for (pos in 0..historySize) {
+                val historical = pos < historySize
+                val sampleTimeNanos = when {
+                    Build.VERSION.SDK_INT >= Build.VERSION_CODES.UPSIDE_DOWN_CAKE ->
+                        if (historical) event.getHistoricalEventTimeNanos(pos) else event.eventTimeNanos
+                    else ->
+                        (if (historical) event.getHistoricalEventTime(pos) else event.eventTime) * 1_000_000L
+                }
+
+                for (i in 0 until AXIS_COUNT) {
+                    sampleAxes[i] = if (ranges == null) 0f else getCenteredAxis(event, ranges, i, pos, historical)
+                }
+                stickFilter.add(sampleAxes, sampleTimeNanos)
+            }
+
+            val filteredAxes = stickFilter.axes
+            val processedLeftX = filteredAxes[INDEX_LEFT_X]
+            val processedLeftY = filteredAxes[INDEX_LEFT_Y]
+            val processedRightX = filteredAxes[INDEX_RIGHT_X]
+            val processedRightY = filteredAxes[INDEX_RIGHT_Y]
+
+            HotLog.log(
+                HotEvent.GAMEPAD_MOTION,
+                (historySize + 1).toLong(), HotLog.bits(processedLeftX), HotLog.bits(processedLeftY)
+            )
+
+            // 写入控制输入快照，附带最新样本的时间戳和本次消费的样本数
+            inputSnapshot?.updateSticks(
+                processedLeftX, processedLeftY, processedRightX, processedRightY,
+                stickFilter.lastSampleTimeNanos, historySize + 1
+            )
+
+            // 仅在数值变化时更新界面状态和回调
+            val left = inputState.leftJoystick
+            if (left.x != processedLeftX || left.y != processedLeftY) {
+                val processedLeftJoystick = JoystickValue(processedLeftX, processedLeftY)
+                inputState.updateLeftJoystick(processedLeftJoystick)
+                leftJoystickCallback?.invoke(processedLeftJoystick)
+            }
+            val right = inputState.rightJoystick
+            if (right.x != processedRightX || right.y != processedRightY) {
+                val processedRightJoystick = JoystickValue(processedRightX, processedRightY)
+                inputState.updateRightJoystick(processedRightJoystick)
+                rightJoystickCallback?.invoke(processedRightJoystick)
             }
-            
-            val rightJoystick = JoystickValue(rightX, rightY)
-            
-            // 应用死区处理
-            val processedLeftJoystick = applyDeadzone(leftJoystick)
-            val processedRightJoystick = applyDeadzone(rightJoystick)
-            
-            // 更新状态
-            inputState.updateLeftJoystick(processedLeftJoystick)
-            inputState.updateRightJoystick(processedRightJoystick)
-            
-            // 触发回调
-            leftJoystickCallback?.invoke(processedLeftJoystick)
-            rightJoystickCallback?.invoke(processedRightJoystick)
-            
-            Timber.v("[GamepadInput] 摇杆更新 - 左: (${processedLeftJoystick.x}, ${processedLeftJoystick.y}), 右: (${processedRightJoystick.x}, ${processedRightJoystick.y})")
             
             return true
             
@@ -188,12 +271,15 @@ class GamepadInputHandler {
             if (isPressed || isReleased) {
                 // 更新按键状态
                 inputState.updateButtonState(keyCode, isPressed)
+                val button = getButtonBit(keyCode)
+                if (button != 0) {
+                    inputSnapshot?.updateButton(button, isPressed)
+                }
                 
                 // 触发回调
                 keyEventCallback?.invoke(keyCode, isPressed)
                 
-                val action = if (isPressed) "按下" else "释放"
-                Timber.d("[GamepadInput] 按键事件: ${getKeyName(keyCode)} $action")
+                HotLog.log(HotEvent.GAMEPAD_KEY, keyCode.toLong(), if (isPressed) 1L else 0L)
                 
                 return true
             }
@@ -223,68 +309,63 @@ class GamepadInputHandler {
                 source and InputDevice.SOURCE_JOYSTICK == InputDevice.SOURCE_JOYSTICK
     }
     
+    /**
+     * 获取事件对应设备的轴范围，按设备ID缓存
+     */
+    private fun getAxisRanges(event: MotionEvent): DeviceAxisRanges? {
+        val deviceId = event.deviceId
+        deviceAxisRanges.get(deviceId)?.let { return it }
+
+        val device = event.device ?: return null
+        return DeviceAxisRanges(device, event.source).also {
+            deviceAxisRanges.put(deviceId, it)
+            Timber.d("[GamepadInput] 缓存设备轴范围: ${device.name}, ID: $deviceId")
+        }
+    }
+
     /**
      * 获取居中的轴值（处理偏移）
      */
-    private fun getCenteredAxis(event: MotionEvent, axis: Int): Float {
-        val device = event.device ?: return 0f
-        
-        val range = device.getMotionRange(axis, event.source) ?: return 0f
-        val flat = range.flat
-        val value = event.getAxisValue(axis)
+    private fun getCenteredAxis(
+        event: MotionEvent,
+        ranges: DeviceAxisRanges,
+        index: Int,
+        pos: Int,
+        historical: Boolean
+    ): Float {
+        if (!ranges.present[index]) return 0f
+
+        val axis = ranges.axes[index]
+        val value = if (historical) event.getHistoricalAxisValue(axis, pos) else event.getAxisValue(axis)
         
         // 应用死区
-        return if (abs(value) > flat) {
+        return if (abs(value) > ranges.flat[index]) {
             // 归一化到 [-1, 1] 范围
-            val normalizedValue = (value - range.min) / (range.max - range.min) * 2f - 1f
+            val normalizedValue = (value - ranges.min[index]) / ranges.span[index] * 2f - 1f
             normalizedValue.coerceIn(-1f, 1f)
         } else {
             0f
         }
     }
-    
-    /**
-     * 应用死区处理
-     */
-    private fun applyDeadzone(joystickValue: JoystickValue): JoystickValue {
-        val magnitude = joystickValue.magnitude
-        
-        return if (magnitude < DEADZONE_THRESHOLD) {
-            JoystickValue.ZERO
-        } else {
-            // 重新缩放以补偿死区
-            val scaleFactor = (magnitude - DEADZONE_THRESHOLD) / (1f - DEADZONE_THRESHOLD)
-            val normalizedX = if (abs(joystickValue.x) > DEADZONE_THRESHOLD) 
-                joystickValue.x * scaleFactor / magnitude else 0f
-            val normalizedY = if (abs(joystickValue.y) > DEADZONE_THRESHOLD) 
-                joystickValue.y * scaleFactor / magnitude else 0f
-            
-            JoystickValue(normalizedX, normalizedY)
-        }
-    }
-    
+
     /**
-     * 获取按键名称（用于调试）
+     * 按键码到控制输入快照按键位的映射，不关心的按键返回0
      */
-    private fun getKeyName(keyCode: Int): String {
+    private fun getButtonBit(keyCode: Int): Int {
         return when (keyCode) {
-            KeyEvent.KEYCODE_BUTTON_A -> "A"
-            KeyEvent.KEYCODE_BUTTON_B -> "B"
-            KeyEvent.KEYCODE_BUTTON_X -> "X"
-            KeyEvent.KEYCODE_BUTTON_Y -> "Y"
-            KeyEvent.KEYCODE_BUTTON_L1 -> "L1"
-            KeyEvent.KEYCODE_BUTTON_R1 -> "R1"
-            KeyEvent.KEYCODE_BUTTON_L2 -> "L2"
-            KeyEvent.KEYCODE_BUTTON_R2 -> "R2"
-            KeyEvent.KEYCODE_BUTTON_SELECT -> "SELECT"
-            KeyEvent.KEYCODE_BUTTON_START -> "START"
-            KeyEvent.KEYCODE_BUTTON_THUMBL -> "左摇杆按下"
-            KeyEvent.KEYCODE_BUTTON_THUMBR -> "右摇杆按下"
-            KeyEvent.KEYCODE_DPAD_UP -> "方向键上"
-            KeyEvent.KEYCODE_DPAD_DOWN -> "方向键下"
-            KeyEvent.KEYCODE_DPAD_LEFT -> "方向键左"
-            KeyEvent.KEYCODE_DPAD_RIGHT -> "方向键右"
-            else -> "未知($keyCode)"
+            KeyEvent.KEYCODE_BUTTON_A -> ControlInputSnapshot.BUTTON_A
+            KeyEvent.KEYCODE_BUTTON_B -> ControlInputSnapshot.BUTTON_B
+            KeyEvent.KEYCODE_BUTTON_X -> ControlInputSnapshot.BUTTON_X
+            KeyEvent.KEYCODE_BUTTON_Y -> ControlInputSnapshot.BUTTON_Y
+            KeyEvent.KEYCODE_BUTTON_L1 -> ControlInputSnapshot.BUTTON_L1
+            KeyEvent.KEYCODE_BUTTON_R1 -> ControlInputSnapshot.BUTTON_R1
+            KeyEvent.KEYCODE_BUTTON_L2 -> ControlInputSnapshot.BUTTON_L2
+            KeyEvent.KEYCODE_BUTTON_R2 -> ControlInputSnapshot.BUTTON_R2
+            KeyEvent.KEYCODE_BUTTON_SELECT -> ControlInputSnapshot.BUTTON_SELECT
+            KeyEvent.KEYCODE_BUTTON_START -> ControlInputSnapshot.BUTTON_START
+            KeyEvent.KEYCODE_BUTTON_THUMBL -> ControlInputSnapshot.BUTTON_THUMBL
+            KeyEvent.KEYCODE_BUTTON_THUMBR -> ControlInputSnapshot.BUTTON_THUMBR
+            else -> 0
         }
     }
     
@@ -334,6 +415,9 @@ class GamepadInputHandler {
         inputState.updateRightJoystick(JoystickValue.ZERO)
         inputState.buttonStates = mutableMapOf()
         inputState.updateGamepadConnection(false)
+        inputSnapshot?.reset()
+        deviceAxisRanges.clear()
+        stickFilter.reset()
         Timber.d("[GamepadInput] 输入状态已重置")
     }
 }
\ No newline at end of file
@@ -0,0 +1,91 @@
+/*********************************************************************************
+ * FileName: StickFilter.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 双摇杆输入滤波：径向死区和按样本时间间隔计算系数的一阶低通
+ * Others: 批量历史样本逐个送入，平滑系数由相邻样本的事件时间决定，与事件到达的批次无关；
+ *         不分配对象
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.input
+
+import kotlin.math.abs
+import kotlin.math.exp
+import kotlin.math.sqrt
+
+/**
+ * 摇杆滤波器，只在输入线程使用
+ * 样本和输出的轴顺序均为 [leftX, leftY, rightX, rightY]
+ */
+internal class StickFilter {
+    companion object {
+        const val AXIS_COUNT = 4
+
+        // 摇杆死区，小于此值的输入将被忽略
+        const val DEADZONE_THRESHOLD = 0.1f
+
+        // 摇杆低通滤波时间常数，按样本实际时间间隔计算平滑系数
+        const val TIME_CONSTANT_NS = 8_000_000f
+    }
+
+    /**
+     * 滤波后的轴值
+     */
+    val axes = FloatArray(AXIS_COUNT)
+
+    /**
+     * 最近一个样本的事件时间，0 表示还没有样本
+     */
+    var lastSampleTimeNanos = 0L
+        private set
+
+    // 死区处理的输出缓存 [x, y]，避免每个样本分配对象
+    private val deadzoneOutput = FloatArray(2)
+
+    /**
+     * 对一个样本做死区处理和低通滤波，结果累积在 [axes] 中
+     * 回到死区内的摇杆立即归零，不经过滤波
+     */
+    fun add(sample: FloatArray, sampleTimeNanos: Long) {
+        val dt = (sampleTimeNanos - lastSampleTimeNanos).toFloat()
+        val alpha = if (lastSampleTimeNanos == 0L || dt <= 0f) 1f
+            else 1f - exp(-dt / TIME_CONSTANT_NS)
+        lastSampleTimeNanos = sampleTimeNanos
+
+        for (stick in 0 until 2) {
+            val xIndex = stick * 2
+            val yIndex = xIndex + 1
+            applyDeadzone(sample[xIndex], sample[yIndex], deadzoneOutput)
+            if (deadzoneOutput[0] == 0f && deadzoneOutput[1] == 0f) {
+                axes[xIndex] = 0f
+                axes[yIndex] = 0f
+            } else {
+                axes[xIndex] += (deadzoneOutput[0] - axes[xIndex]) * alpha
+                axes[yIndex] += (deadzoneOutput[1] - axes[yIndex]) * alpha
+            }
+        }
+    }
+
+    fun reset() {
+        axes.fill(0f)
+        lastSampleTimeNanos = 0L
+    }
+
+    /**
+     * 应用死区处理，结果写入 out[0], out[1]
+     */
+    private fun applyDeadzone(x: Float, y: Float, out: FloatArray) {
+        val magnitude = sqrt(x * x + y * y).coerceAtMost(1f)
+
+        if (magnitude < DEADZONE_THRESHOLD) {
+            out[0] = 0f
+            out[1] = 0f
+        } else {
+            // 重新缩放以补偿死区
+            val scaleFactor = (magnitude - DEADZONE_THRESHOLD) / (1f - DEADZONE_THRESHOLD)
+            out[0] = if (abs(x) > DEADZONE_THRESHOLD) x * scaleFactor / magnitude else 0f
+            out[1] = if (abs(y) > DEADZONE_THRESHOLD) y * scaleFactor / magnitude else 0f
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/*********************************************************************************
+ * FileName: HotEvent.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 热路径日志事件定义：级别、标签和参数格式化
+ * Others: 热路径只记录事件序号和最多3个整型参数，文本在写线程或导出时才格式化；
+ *         浮点参数以 toRawBits 保存
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.log
+
+import android.util.Log
+import android.view.KeyEvent
+import com.helywin.leggedjoystick.data.ConnectionState
+import legged_driver.ControlMode
+import legged_driver.Mode
+
+/**
+ * 热路径日志事件
+ *
+ * @param priority 日志级别（[Log.VERBOSE] ~ [Log.ERROR]）
+ * @param tag 与 Timber 日志前缀一致的模块名
+ */
+enum class HotEvent(val priority: Int, val tag: String) {
+    HEARTBEAT_RECEIVED(Log.DEBUG, "Controller") {
+        override fun format(a: Long, b: Long, c: Long) = "收到服务器心跳，连接状态: ${a != 0L}"
+    },
+    BATTERY_RECEIVED(Log.DEBUG, "Controller") {
+        override fun format(a: Long, b: Long, c: Long) = "收到电池信息，电量: $a%"
+    },
+    MODE_REPORTED(Log.DEBUG, "Controller") {
+        override fun format(a: Long, b: Long, c: Long) = "收到当前模式: ${Mode.fromValue(a.toInt())}"
+    },
+    CONTROL_MODE_REPORTED(Log.DEBUG, "Controller") {
+        override fun format(a: Long, b: Long, c: Long) = "收到当前控制模式: ${ControlMode.fromValue(a.toInt())}"
+    },
+    VELOCITY_SENT(Log.VERBOSE, "Controller") {
+        override fun format(a: Long, b: Long, c: Long) =
+            "发送速度指令: vx=${floatArg(a)}, vy=${floatArg(b)}, yaw_rate=${floatArg(c)}"
+    },
+    STOP_SENT(Log.VERBOSE, "Controller") {
+        override fun format(a: Long, b: Long, c: Long) = "发送停止指令"
+    },
+    GAMEPAD_MOTION(Log.VERBOSE, "GamepadInput") {
+        override fun format(a: Long, b: Long, c: Long) =
+            "运动事件: 样本数=$a, 左摇杆=(${floatArg(b)}, ${floatArg(c)})"
+    },
+    GAMEPAD_KEY(Log.DEBUG, "GamepadInput") {
+        override fun format(a: Long, b: Long, c: Long) = "按键事件: ${keyName(a.toInt())} ${pressAction(b)}"
+    },
+    GAMEPAD_BUTTON(Log.DEBUG, "MainActivity") {
+        override fun format(a: Long, b: Long, c: Long) = "游戏手柄按钮事件: ${keyName(a.toInt())} ${pressAction(b)}"
+    },
+    CONNECTION_STATE(Log.DEBUG, "NewZmqClient") {
+        override fun format(a: Long, b: Long, c: Long) =
+            "连接状态变更: ${ConnectionState.entries[a.toInt()]} -> ${ConnectionState.entries[b.toInt()]}"
+    },
+    COMMAND_RESENT(Log.DEBUG, "NewZmqClient") {
+        override fun format(a: Long, b: Long, c: Long) = "指令未确认，重发"
+    },
+    STALE_ACK(Log.DEBUG, "NewZmqClient") {
+        override fun format(a: Long, b: Long, c: Long) = "收到过期的指令确认: $a"
+    },
+    CRC_FAILED(Log.WARN, "NewZmqClient") {
+        override fun format(a: Long, b: Long, c: Long) = "CRC32校验失败 - 数据长度: $a"
+    };
+
+    /**
+     * 格式化事件文本（写线程或导出时调用）
+     */
+    abstract fun format(a: Long, b: Long, c: Long): String
+
+    companion object {
+        fun floatArg(bits: Long): Float = Float.fromBits(bits.toInt())
+
+        private fun pressAction(pressed: Long) = if (pressed != 0L) "按下" else "释放"
+
+        /**
+         * 游戏手柄按键名称
+         */
+        private fun keyName(keyCode: Int): String {
+            return when (keyCode) {
+                KeyEvent.KEYCODE_BUTTON_A -> "A"
+                KeyEvent.KEYCODE_BUTTON_B -> "B"
+                KeyEvent.KEYCODE_BUTTON_X -> "X"
+                KeyEvent.KEYCODE_BUTTON_Y -> "Y"
+                KeyEvent.KEYCODE_BUTTON_L1 -> "L1"
+                KeyEvent.KEYCODE_BUTTON_R1 -> "R1"
+                KeyEvent.KEYCODE_BUTTON_L2 -> "L2"
+                KeyEvent.KEYCODE_BUTTON_R2 -> "R2"
+                KeyEvent.KEYCODE_BUTTON_SELECT -> "SELECT"
+                KeyEvent.KEYCODE_BUTTON_START -> "START"
+                KeyEvent.KEYCODE_BUTTON_THUMBL -> "左摇杆按下"
+                KeyEvent.KEYCODE_BUTTON_THUMBR -> "右摇杆按下"
+                KeyEvent.KEYCODE_DPAD_UP -> "方向键上"
+                KeyEvent.KEYCODE_DPAD_DOWN -> "方向键下"
+                KeyEvent.KEYCODE_DPAD_LEFT -> "方向键左"
+                KeyEvent.KEYCODE_DPAD_RIGHT -> "方向键右"
+                else -> "未知($keyCode)"
+            }
+        }
+    }
+}
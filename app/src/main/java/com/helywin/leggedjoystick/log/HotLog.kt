@@ -0,0 +1,253 @@
+/*********************************************************************************
+ * FileName: HotLog.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 热路径日志：按级别过滤后把结构化事件写入预分配的环形缓冲区，
+ *              写线程异步转交 Timber，崩溃或断链时导出最近一段时间的事件
+ * Others: 记录只做一次级别比较和一次短临界区内的数组写入，不拼接字符串、不分配内存；
+ *         缓冲区满后覆盖最旧的事件，写线程落后超过一圈时跳过并计数
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.log
+
+import android.util.Log
+import timber.log.Timber
+import java.io.File
+import java.text.SimpleDateFormat
+import java.util.Date
+import java.util.Locale
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.locks.LockSupport
+
+/**
+ * 热路径日志，进程内唯一
+ */
+object HotLog {
+    private const val CAPACITY = 8192 // 约为100Hz速度指令 + 100Hz手柄事件 + 状态消息下30秒以上的事件
+    private const val ARGS_PER_RECORD = 3
+    private const val DRAIN_INTERVAL_MS = 200L
+    private const val DUMP_WINDOW_SECONDS = 30L
+    private const val MAX_DUMP_FILES = 10
+    private const val DUMP_PREFIX = "hotlog-"
+
+    /**
+     * 低于此级别的事件直接丢弃，不进入缓冲区
+     */
+    @Volatile
+    var minPriority = Log.DEBUG
+
+    /**
+     * 写线程转交 Timber 的最低级别，低于此级别的事件只保留在缓冲区中供导出
+     */
+    @Volatile
+    var forwardPriority = Log.DEBUG
+
+    private val events = HotEvent.entries.toTypedArray()
+    private val lock = Any()
+
+    // 环形缓冲区（生产者在锁内写入）
+    private val times = LongArray(CAPACITY)
+    private val eventIds = IntArray(CAPACITY)
+    private val args = LongArray(CAPACITY * ARGS_PER_RECORD)
+    private var total = 0L // 累计写入条数，槽位为 total % CAPACITY
+
+    // 写线程的拷贝区
+    private val drainTimes = LongArray(CAPACITY)
+    private val drainEventIds = IntArray(CAPACITY)
+    private val drainArgs = LongArray(CAPACITY * ARGS_PER_RECORD)
+    private var drained = 0L
+    private var lost = 0L
+    private var reportedLost = 0L
+
+    @Volatile
+    private var dumpDir: File? = null
+
+    @Volatile
+    private var pendingDumpReason: String? = null
+
+    private var writerThread: Thread? = null
+
+    /**
+     * 事件是否会被记录，需要额外计算参数时先调用
+     */
+    fun isLoggable(priority: Int): Boolean = priority >= minPriority
+
+    /**
+     * 记录一个事件
+     */
+    fun log(event: HotEvent, a: Long = 0, b: Long = 0, c: Long = 0) {
+        if (event.priority < minPriority) return
+        val now = System.nanoTime()
+        synchronized(lock) {
+            val slot = (total % CAPACITY).toInt()
+            times[slot] = now
+            eventIds[slot] = event.ordinal
+            val base = slot * ARGS_PER_RECORD
+            args[base] = a
+            args[base + 1] = b
+            args[base + 2] = c
+            total++
+        }
+    }
+
+    /**
+     * 浮点参数的编码，与 [HotEvent.floatArg] 对应
+     */
+    fun bits(value: Float): Long = value.toRawBits().toLong()
+
+    /**
+     * 启动写线程
+     * @param dir 导出文件目录
+     */
+    fun start(dir: File) = synchronized(this) {
+        dumpDir = dir
+        if (writerThread != null) return@synchronized
+        writerThread = Thread(::writerLoop, "HotLogWriter").apply {
+            isDaemon = true
+            start()
+        }
+    }
+
+    /**
+     * 安装未捕获异常处理：先同步导出最近的事件，再交给原有处理器
+     */
+    fun installCrashHandler() {
+        val previous = Thread.getDefaultUncaughtExceptionHandler()
+        Thread.setDefaultUncaughtExceptionHandler { thread, throwable ->
+            try {
+                dump("crash")
+            } catch (_: Throwable) {
+                // 导出失败不影响原有的崩溃处理
+            }
+            previous?.uncaughtException(thread, throwable)
+        }
+    }
+
+    /**
+     * 请求在写线程上导出（例如断链时），多次请求合并为一次
+     */
+    fun requestDump(reason: String) {
+        pendingDumpReason = reason
+        writerThread?.let { LockSupport.unpark(it) }
+    }
+
+    /**
+     * 在调用线程上导出最近 [DUMP_WINDOW_SECONDS] 秒的事件
+     * @return 导出的文件，未启动或写入失败时返回 null
+     */
+    fun dump(reason: String): File? {
+        val dir = dumpDir ?: return null
+        val dumpTimes = LongArray(CAPACITY)
+        val dumpEventIds = IntArray(CAPACITY)
+        val dumpArgs = LongArray(CAPACITY * ARGS_PER_RECORD)
+        val count: Int
+        val lostCount: Long
+        synchronized(lock) {
+            count = minOf(total, CAPACITY.toLong()).toInt()
+            copyLocked(total - count, count, dumpTimes, dumpEventIds, dumpArgs)
+            lostCount = lost
+        }
+
+        val nowNanos = System.nanoTime()
+        val nowWallMs = System.currentTimeMillis()
+        val windowStart = nowNanos - TimeUnit.SECONDS.toNanos(DUMP_WINDOW_SECONDS)
+        val timeFormat = SimpleDateFormat("HH:mm:ss.SSS", Locale.US)
+        val stamp = SimpleDateFormat("yyyyMMdd-HHmmss", Locale.US).format(Date(nowWallMs))
+        val file = File(dir, "$DUMP_PREFIX$stamp-$reason.txt")
+        return try {
+            dir.mkdirs()
+            file.bufferedWriter().use { writer ->
+                writer.write("# reason=$reason records=$count lost=$lostCount window=${DUMP_WINDOW_SECONDS}s\n")
+                for (i in 0 until count) {
+                    val time = dumpTimes[i]
+                    if (time < windowStart) continue
+                    val event = events[dumpEventIds[i]]
+                    val base = i * ARGS_PER_RECORD
+                    val wallMs = nowWallMs - TimeUnit.NANOSECONDS.toMillis(nowNanos - time)
+                    writer.write(timeFormat.format(Date(wallMs)))
+                    writer.write(" ${priorityLetter(event.priority)} [${event.tag}] ")
+                    writer.write(event.format(dumpArgs[base], dumpArgs[base + 1], dumpArgs[base + 2]))
+                    writer.write("\n")
+                }
+            }
+            pruneDumps(dir)
+            Timber.i("[HotLog] 已导出最近${DUMP_WINDOW_SECONDS}秒日志: ${file.absolutePath}")
+            file
+        } catch (e: Exception) {
+            Timber.e(e, "[HotLog] 导出日志失败")
+            null
+        }
+    }
+
+    private fun writerLoop() {
+        while (true) {
+            drainToTimber()
+            pendingDumpReason?.let { reason ->
+                pendingDumpReason = null
+                dump(reason)
+            }
+            LockSupport.parkNanos(TimeUnit.MILLISECONDS.toNanos(DRAIN_INTERVAL_MS))
+        }
+    }
+
+    /**
+     * 取出新写入的事件，按级别格式化后交给 Timber（写线程）
+     */
+    private fun drainToTimber() {
+        val count: Int
+        val lostCount: Long
+        synchronized(lock) {
+            var from = drained
+            if (total - from > CAPACITY) {
+                lost += total - from - CAPACITY
+                from = total - CAPACITY
+            }
+            count = (total - from).toInt()
+            copyLocked(from, count, drainTimes, drainEventIds, drainArgs)
+            drained = total
+            lostCount = lost
+        }
+
+        if (lostCount != reportedLost) {
+            Timber.w("[HotLog] 写线程落后，跳过${lostCount - reportedLost}条事件")
+            reportedLost = lostCount
+        }
+        if (Timber.treeCount == 0) return
+        val threshold = forwardPriority
+        for (i in 0 until count) {
+            val event = events[drainEventIds[i]]
+            if (event.priority < threshold) continue
+            val base = i * ARGS_PER_RECORD
+            Timber.log(event.priority, "[${event.tag}] ${event.format(drainArgs[base], drainArgs[base + 1], drainArgs[base + 2])}")
+        }
+    }
+
+    /**
+     * 按写入顺序拷贝从第 [from] 条开始的 [count] 条事件（调用方持锁）
+     */
+    private fun copyLocked(from: Long, count: Int, outTimes: LongArray, outEventIds: IntArray, outArgs: LongArray) {
+        for (i in 0 until count) {
+            val slot = ((from + i) % CAPACITY).toInt()
+            outTimes[i] = times[slot]
+            outEventIds[i] = eventIds[slot]
+            System.arraycopy(args, slot * ARGS_PER_RECORD, outArgs, i * ARGS_PER_RECORD, ARGS_PER_RECORD)
+        }
+    }
+
+    private fun pruneDumps(dir: File) {
+        val dumps = dir.listFiles { file -> file.name.startsWith(DUMP_PREFIX) } ?: return
+        if (dumps.size <= MAX_DUMP_FILES) return
+        dumps.sortedBy { it.lastModified() }
+            .take(dumps.size - MAX_DUMP_FILES)
+            .forEach { it.delete() }
+    }
+
+    private fun priorityLetter(priority: Int): Char = when (priority) {
+        Log.VERBOSE -> 'V'
+        Log.DEBUG -> 'D'
+        Log.INFO -> 'I'
+        Log.WARN -> 'W'
+        else -> 'E'
+    }
+}
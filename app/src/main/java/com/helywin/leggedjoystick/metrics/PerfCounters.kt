@@ -0,0 +1,75 @@
+/*********************************************************************************
+ * FileName: PerfCounters.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 性能浮层使用的无锁计数器：热路径只做原子累加，浮层按低频采样并自行计算速率
+ * Others: 采样线程与写入线程之间不加锁，窗口边界上个别样本可能计入相邻窗口
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.metrics
+
+import android.os.Debug
+import java.util.concurrent.atomic.AtomicLong
+
+/**
+ * 时延统计摘要
+ *
+ * @param samples 窗口内的样本数
+ * @param lastUs 最近一个样本
+ * @param meanUs 窗口内平均值
+ * @param maxUs 窗口内最大值
+ */
+data class LatencySummary(
+    val samples: Long = 0,
+    val lastUs: Long = 0,
+    val meanUs: Long = 0,
+    val maxUs: Long = 0
+)
+
+/**
+ * 无锁时延计量：写入方每个样本只做几次原子操作，采样方调用 [drain] 读取并开始新窗口
+ * 支持单个写入线程，采样可在任意线程进行
+ */
+class LatencyGauge {
+    private val last = AtomicLong(0)
+    private val max = AtomicLong(0)
+    private val sum = AtomicLong(0)
+    private val count = AtomicLong(0)
+
+    /**
+     * 记录一个样本（微秒）
+     */
+    fun record(valueUs: Long) {
+        last.lazySet(valueUs)
+        sum.addAndGet(valueUs)
+        count.incrementAndGet()
+        if (valueUs > max.get()) max.lazySet(valueUs)
+    }
+
+    /**
+     * 读取本窗口的摘要并清零
+     */
+    fun drain(): LatencySummary {
+        val samples = count.getAndSet(0)
+        val total = sum.getAndSet(0)
+        val peak = max.getAndSet(0)
+        return LatencySummary(
+            samples = samples,
+            lastUs = last.get(),
+            meanUs = if (samples == 0L) 0 else total / samples,
+            maxUs = peak
+        )
+    }
+}
+
+/**
+ * 运行时指标
+ */
+object RuntimeCounters {
+    /**
+     * 进程启动以来的GC次数，读取失败时返回 -1
+     */
+    fun gcCount(): Long =
+        Debug.getRuntimeStat("art.gc.gc-count")?.toLongOrNull() ?: -1
+}
@@ -0,0 +1,78 @@
+/*********************************************************************************
+ * FileName: RollingSampleWindow.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 固定容量的滚动样本窗口，支持百分位数、均值和求和
+ * Others: 非线程安全，由调用方加锁；添加样本不分配内存
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.metrics
+
+/**
+ * 滚动样本窗口，写满后覆盖最旧的样本
+ */
+class RollingSampleWindow(val capacity: Int) {
+    private val samples = LongArray(capacity)
+    private val sortScratch = LongArray(capacity)
+    private var next = 0
+
+    var count = 0
+        private set
+
+    /**
+     * 添加一个样本
+     */
+    fun add(sample: Long) {
+        samples[next] = sample
+        next = (next + 1) % capacity
+        if (count < capacity) count++
+    }
+
+    /**
+     * 清空窗口
+     */
+    fun clear() {
+        next = 0
+        count = 0
+    }
+
+    /**
+     * 最近一个样本，窗口为空时返回 [defaultValue]
+     */
+    fun last(defaultValue: Long = 0): Long {
+        if (count == 0) return defaultValue
+        return samples[(next - 1 + capacity) % capacity]
+    }
+
+    fun sum(): Long {
+        var total = 0L
+        for (i in 0 until count) total += samples[i]
+        return total
+    }
+
+    fun mean(): Long = if (count == 0) 0 else sum() / count
+
+    fun max(): Long {
+        var result = Long.MIN_VALUE
+        for (i in 0 until count) if (samples[i] > result) result = samples[i]
+        return if (count == 0) 0 else result
+    }
+
+    /**
+     * 计算多个百分位数（最近秩法），结果写入 [out]
+     * @param percentiles 百分位，范围 (0, 100]
+     */
+    fun percentiles(percentiles: DoubleArray, out: LongArray) {
+        if (count == 0) {
+            out.fill(0)
+            return
+        }
+        samples.copyInto(sortScratch, 0, 0, count)
+        sortScratch.sort(0, count)
+        for (i in percentiles.indices) {
+            val rank = kotlin.math.ceil(percentiles[i] / 100.0 * count).toInt().coerceIn(1, count)
+            out[i] = sortScratch[rank - 1]
+        }
+    }
+}
@@ -0,0 +1,261 @@
+/*********************************************************************************
+ * FileName: OdometryBuffer.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 里程计环形缓冲区，按字段分别存放在基本类型数组中（结构数组），接收线程写入
+ * Others: 写入和查询都不分配对象，查询结果拷贝到调用方复用的 OdometrySample / TrajectoryWindow 中；
+ *         时间基准为 System.nanoTime，与 Choreographer 帧时间一致
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.odometry
+
+import kotlinx.coroutines.CancellableContinuation
+import kotlinx.coroutines.suspendCancellableCoroutine
+import kotlin.coroutines.resume
+import kotlin.math.atan2
+
+/**
+ * 单条里程计样本，由调用方持有并复用
+ */
+class OdometrySample {
+    var timeNanos = 0L
+    var x = 0f
+    var y = 0f
+    var z = 0f
+    var qx = 0f
+    var qy = 0f
+    var qz = 0f
+    var qw = 1f
+    var yaw = 0f
+    var vx = 0f
+    var vy = 0f
+    var vz = 0f
+    var wx = 0f
+    var wy = 0f
+    var wz = 0f
+}
+
+/**
+ * 一段最近的平面轨迹（时间、x、y、航向角），由调用方持有并复用
+ */
+class TrajectoryWindow(val capacity: Int) {
+    val timeNanos = LongArray(capacity)
+    val x = FloatArray(capacity)
+    val y = FloatArray(capacity)
+    val yaw = FloatArray(capacity)
+
+    // 有效样本数，按时间从旧到新排列
+    var size = 0
+        internal set
+}
+
+/**
+ * 里程计环形缓冲区，单个写线程，任意数量的读线程
+ * 写满后覆盖最旧的样本
+ */
+class OdometryBuffer(val capacity: Int = DEFAULT_CAPACITY) {
+    companion object {
+        const val DEFAULT_CAPACITY = 2048 // 100Hz 下约20秒轨迹
+
+        /**
+         * 四元数转航向角（绕Z轴，弧度）
+         */
+        fun yawOf(qx: Float, qy: Float, qz: Float, qw: Float): Float =
+            atan2(2f * (qw * qz + qx * qy), 1f - 2f * (qy * qy + qz * qz))
+    }
+
+    private val lock = Any()
+
+    private val times = LongArray(capacity)
+    private val posX = FloatArray(capacity)
+    private val posY = FloatArray(capacity)
+    private val posZ = FloatArray(capacity)
+    private val quatX = FloatArray(capacity)
+    private val quatY = FloatArray(capacity)
+    private val quatZ = FloatArray(capacity)
+    private val quatW = FloatArray(capacity)
+    private val yaws = FloatArray(capacity)
+    private val linVx = FloatArray(capacity)
+    private val linVy = FloatArray(capacity)
+    private val linVz = FloatArray(capacity)
+    private val angVx = FloatArray(capacity)
+    private val angVy = FloatArray(capacity)
+    private val angVz = FloatArray(capacity)
+
+    private var next = 0
+    private var count = 0
+
+    // 等待新样本的读方（锁内访问），在锁外唤醒；waking 仅写线程使用
+    private val waiters = ArrayList<CancellableContinuation<Unit>>(2)
+    private val waking = ArrayList<CancellableContinuation<Unit>>(2)
+
+    /**
+     * 累计写入次数，读方据此判断是否有新数据，不需要加锁
+     */
+    @Volatile
+    var writeCount = 0L
+        private set
+
+    val size: Int
+        get() = synchronized(lock) { count }
+
+    /**
+     * 写入一条样本（接收线程）
+     */
+    fun add(
+        timeNanos: Long,
+        x: Float, y: Float, z: Float,
+        qx: Float, qy: Float, qz: Float, qw: Float,
+        vx: Float, vy: Float, vz: Float,
+        wx: Float, wy: Float, wz: Float
+    ) {
+        val yaw = yawOf(qx, qy, qz, qw)
+        synchronized(lock) {
+            val i = next
+            times[i] = timeNanos
+            posX[i] = x
+            posY[i] = y
+            posZ[i] = z
+            quatX[i] = qx
+            quatY[i] = qy
+            quatZ[i] = qz
+            quatW[i] = qw
+            yaws[i] = yaw
+            linVx[i] = vx
+            linVy[i] = vy
+            linVz[i] = vz
+            angVx[i] = wx
+            angVy[i] = wy
+            angVz[i] = wz
+            next = (i + 1) % capacity
+            if (count < capacity) count++
+            writeCount++
+            takeWaiters(waking)
+        }
+        wakeWaiters(waking)
+    }
+
+    /**
+     * 清空缓冲区（重新连接时）
+     */
+    fun clear() {
+        // 可能在写线程以外调用，不复用 waking
+        val cleared = ArrayList<CancellableContinuation<Unit>>(0)
+        synchronized(lock) {
+            next = 0
+            count = 0
+            writeCount = 0
+            takeWaiters(cleared)
+        }
+        wakeWaiters(cleared)
+    }
+
+    /**
+     * 挂起直到累计写入次数不再等于 [seenWriteCount]（有新样本或缓冲区被清空）
+     * 没有读方等待时写入不做任何额外工作
+     */
+    suspend fun awaitWrite(seenWriteCount: Long) {
+        if (writeCount != seenWriteCount) return
+        suspendCancellableCoroutine { cont ->
+            val changed = synchronized(lock) {
+                (writeCount != seenWriteCount).also { if (!it) waiters.add(cont) }
+            }
+            if (changed) {
+                cont.resume(Unit)
+            } else {
+                cont.invokeOnCancellation { synchronized(lock) { waiters.remove(cont) } }
+            }
+        }
+    }
+
+    // 锁内调用：把等待的读方移到待唤醒列表
+    private fun takeWaiters(into: ArrayList<CancellableContinuation<Unit>>) {
+        if (waiters.isEmpty()) return
+        into.addAll(waiters)
+        waiters.clear()
+    }
+
+    private fun wakeWaiters(list: ArrayList<CancellableContinuation<Unit>>) {
+        if (list.isEmpty()) return
+        for (cont in list) cont.resume(Unit)
+        list.clear()
+    }
+
+    /**
+     * 读取最新样本
+     * @return 缓冲区为空时返回 false
+     */
+    fun latest(out: OdometrySample): Boolean = synchronized(lock) {
+        if (count == 0) return@synchronized false
+        val i = (next - 1 + capacity) % capacity
+        out.timeNanos = times[i]
+        out.x = posX[i]
+        out.y = posY[i]
+        out.z = posZ[i]
+        out.qx = quatX[i]
+        out.qy = quatY[i]
+        out.qz = quatZ[i]
+        out.qw = quatW[i]
+        out.yaw = yaws[i]
+        out.vx = linVx[i]
+        out.vy = linVy[i]
+        out.vz = linVz[i]
+        out.wx = angVx[i]
+        out.wy = angVy[i]
+        out.wz = angVz[i]
+        true
+    }
+
+    /**
+     * 统计时间不早于 [sinceNanos] 的样本数，用于计算接收频率
+     */
+    fun countSince(sinceNanos: Long): Int = synchronized(lock) {
+        var n = 0
+        while (n < count && times[(next - 1 - n + capacity) % capacity] >= sinceNanos) n++
+        n
+    }
+
+    /**
+     * 拷贝时间不早于 [sinceNanos] 的轨迹到 [out]，最多拷贝 out.capacity 条（保留最新的）
+     * @return 拷贝的样本数
+     */
+    fun copyTrajectory(sinceNanos: Long, out: TrajectoryWindow): Int = synchronized(lock) {
+        // 从最新往回找窗口起点
+        var n = 0
+        val limit = minOf(count, out.capacity)
+        while (n < limit && times[(next - 1 - n + capacity) % capacity] >= sinceNanos) n++
+
+        val start = (next - n + capacity) % capacity
+        for (j in 0 until n) {
+            val i = (start + j) % capacity
+            out.timeNanos[j] = times[i]
+            out.x[j] = posX[i]
+            out.y[j] = posY[i]
+            out.yaw[j] = yaws[i]
+        }
+        out.size = n
+        n
+    }
+
+    /**
+     * 增量读取：拷贝累计写入次数大于 [afterWriteCount] 的样本到 [out]，用于只追加新点的绘制
+     * 积压超过缓冲区或 out 容量时只拷贝最新的部分；缓冲区被清空后（写入次数回退）从头读取
+     * @return 当前累计写入次数，作为下次调用的 afterWriteCount
+     */
+    fun copyNewer(afterWriteCount: Long, out: TrajectoryWindow): Long = synchronized(lock) {
+        val pending = if (afterWriteCount > writeCount) writeCount else writeCount - afterWriteCount
+        val n = minOf(pending, count.toLong(), out.capacity.toLong()).toInt()
+
+        val start = (next - n + capacity) % capacity
+        for (j in 0 until n) {
+            val i = (start + j) % capacity
+            out.timeNanos[j] = times[i]
+            out.x[j] = posX[i]
+            out.y[j] = posY[i]
+            out.yaw[j] = yaws[i]
+        }
+        out.size = n
+        writeCount
+    }
+}
@@ -0,0 +1,118 @@
+/*********************************************************************************
+ * FileName: OdometryPublisher.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 按显示帧抽样发布里程计到界面状态，里程计原始频率（100Hz以上）不直接触发重组
+ * Others: Choreographer 回调在主线程执行，只有有新数据且距上次发布满 publishIntervalNanos 时才发布
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.odometry
+
+import android.view.Choreographer
+import androidx.compose.runtime.Immutable
+
+/**
+ * 界面使用的里程计状态
+ */
+@Immutable
+data class OdometryState(
+    val hasData: Boolean = false,
+    val x: Float = 0f,
+    val y: Float = 0f,
+    val z: Float = 0f,
+    val yaw: Float = 0f,       // 航向角，弧度
+    val vx: Float = 0f,
+    val vy: Float = 0f,
+    val yawRate: Float = 0f,
+    val rateHz: Int = 0,       // 最近1秒收到的里程计条数
+    val isStale: Boolean = false // 超过 STALE_AFTER_NANOS 没有新数据
+)
+
+/**
+ * 里程计界面发布器，start/stop 在主线程调用
+ */
+class OdometryPublisher(
+    buffer: OdometryBuffer,
+    private val publishIntervalNanos: Long = DEFAULT_PUBLISH_INTERVAL_NANOS,
+    private val onPublish: (OdometryState) -> Unit
+) : Choreographer.FrameCallback {
+    companion object {
+        const val DEFAULT_PUBLISH_INTERVAL_NANOS = 50_000_000L // 20Hz
+        private const val RATE_WINDOW_NANOS = 1_000_000_000L
+        private const val STALE_AFTER_NANOS = 500_000_000L
+    }
+
+    /**
+     * 数据来源，切换操控的机器人时替换，下一帧即发布新机器人的里程计
+     */
+    var buffer: OdometryBuffer = buffer
+        set(value) {
+            field = value
+            lastPublishedWriteCount = -1L
+            lastPublishNanos = 0L
+            lastPublishedStale = false
+        }
+
+    private val sample = OdometrySample()
+    private var choreographer: Choreographer? = null
+    private var running = false
+    private var lastPublishedWriteCount = -1L
+    private var lastPublishNanos = 0L
+    private var lastPublishedStale = false
+
+    fun start() {
+        if (running) return
+        running = true
+        lastPublishedWriteCount = -1L
+        lastPublishNanos = 0L
+        lastPublishedStale = false
+        val instance = choreographer ?: Choreographer.getInstance().also { choreographer = it }
+        instance.postFrameCallback(this)
+    }
+
+    /**
+     * 停止发布并把界面状态复位
+     */
+    fun stop() {
+        if (!running) return
+        running = false
+        choreographer?.removeFrameCallback(this)
+        onPublish(OdometryState())
+    }
+
+    override fun doFrame(frameTimeNanos: Long) {
+        if (!running) return
+        choreographer?.postFrameCallback(this)
+
+        if (frameTimeNanos - lastPublishNanos < publishIntervalNanos) return
+        val writes = buffer.writeCount
+        if (writes == lastPublishedWriteCount) {
+            // 没有新数据时只在进入超时状态时发布一次
+            if (lastPublishedStale || !sample.isStaleAt(frameTimeNanos)) return
+        }
+        if (!buffer.latest(sample)) return
+
+        val stale = frameTimeNanos - sample.timeNanos > STALE_AFTER_NANOS
+        lastPublishedWriteCount = writes
+        lastPublishNanos = frameTimeNanos
+        lastPublishedStale = stale
+        onPublish(
+            OdometryState(
+                hasData = true,
+                x = sample.x,
+                y = sample.y,
+                z = sample.z,
+                yaw = sample.yaw,
+                vx = sample.vx,
+                vy = sample.vy,
+                yawRate = sample.wz,
+                rateHz = buffer.countSince(frameTimeNanos - RATE_WINDOW_NANOS),
+                isStale = stale
+            )
+        )
+    }
+
+    private fun OdometrySample.isStaleAt(nowNanos: Long): Boolean =
+        timeNanos != 0L && nowNanos - timeNanos > STALE_AFTER_NANOS
+}
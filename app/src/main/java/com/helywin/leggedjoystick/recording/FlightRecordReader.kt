@@ -0,0 +1,74 @@
+/*********************************************************************************
+ * FileName: FlightRecordReader.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 读取 FlightRecorder 写入的会话记录，按分段顺序还原收发帧
+ * Others: 遇到长度为0或越界的记录即认为该分段结束，异常退出时最后一条记录可能不完整
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.recording
+
+import timber.log.Timber
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * 一条记录的帧
+ *
+ * @param timeNanos 收发时刻（记录端的 System.nanoTime）
+ * @param bytes 原始帧字节
+ */
+class FlightFrame(
+    val timeNanos: Long,
+    val direction: FrameDirection,
+    val bytes: ByteArray
+)
+
+/**
+ * 黑匣子记录读取
+ */
+object FlightRecordReader {
+    /**
+     * 最近一次会话目录，没有记录时返回 null
+     */
+    fun latestSession(rootDir: File): File? =
+        rootDir.listFiles { file -> file.isDirectory }?.maxByOrNull { it.name }
+
+    /**
+     * 读取会话目录下所有分段中的帧，按记录顺序返回
+     */
+    fun readSession(sessionDir: File): List<FlightFrame> {
+        val segments = sessionDir.listFiles { file -> file.name.endsWith(FlightRecorder.SEGMENT_SUFFIX) }
+            ?.sortedBy { it.name }
+            .orEmpty()
+        val frames = ArrayList<FlightFrame>()
+        segments.forEach { readSegment(it, frames) }
+        return frames
+    }
+
+    /**
+     * 读取单个分段，追加到 [out]
+     */
+    fun readSegment(file: File, out: MutableList<FlightFrame>) {
+        val buffer = ByteBuffer.wrap(file.readBytes()).order(ByteOrder.LITTLE_ENDIAN)
+        if (buffer.remaining() < FlightRecorder.FILE_HEADER_BYTES) return
+        val magic = ByteArray(FlightRecorder.FILE_MAGIC.size)
+        buffer.get(magic)
+        val version = buffer.getInt()
+        if (!magic.contentEquals(FlightRecorder.FILE_MAGIC) || version != FlightRecorder.FORMAT_VERSION) {
+            Timber.w("[FlightRecordReader] 不支持的记录文件: ${file.name}")
+            return
+        }
+        while (buffer.remaining() >= FlightRecorder.RECORD_HEADER_BYTES) {
+            val length = buffer.getInt()
+            if (length <= 0 || length > buffer.remaining() - (FlightRecorder.RECORD_HEADER_BYTES - 4)) break
+            val timeNanos = buffer.getLong()
+            val direction = FrameDirection.fromCode(buffer.get())
+            val bytes = ByteArray(length)
+            buffer.get(bytes)
+            out.add(FlightFrame(timeNanos, direction, bytes))
+        }
+    }
+}
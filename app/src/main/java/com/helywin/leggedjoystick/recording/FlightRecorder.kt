@@ -0,0 +1,229 @@
+/*********************************************************************************
+ * FileName: FlightRecorder.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 黑匣子记录：把每一帧收发的原始字节连同单调时间戳和方向追加到内存映射的滚动文件
+ * Others: 记录格式为 [int 长度][long 时间(System.nanoTime)][byte 方向][帧字节]，长度为0表示数据结束；
+ *         只由I/O线程写入，写入即一次内存拷贝，不经过系统调用；下一个分段由后台线程预先创建并映射，
+ *         写满后直接切换，旧分段的写回和超出总分段数时删除最旧分段也在后台线程进行
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.recording
+
+import timber.log.Timber
+import java.io.File
+import java.io.RandomAccessFile
+import java.nio.ByteOrder
+import java.nio.MappedByteBuffer
+import java.nio.channels.FileChannel
+import java.text.SimpleDateFormat
+import java.util.Date
+import java.util.Locale
+import java.util.concurrent.Executor
+import java.util.concurrent.Executors
+import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.atomic.AtomicLong
+import java.util.concurrent.atomic.AtomicReference
+
+/**
+ * 帧方向
+ */
+enum class FrameDirection(val code: Byte) {
+    INBOUND(0),
+    OUTBOUND(1);
+
+    companion object {
+        fun fromCode(code: Byte): FrameDirection = if (code == OUTBOUND.code) OUTBOUND else INBOUND
+    }
+}
+
+/**
+ * 黑匣子记录器
+ * [startSession] / [stopSession] 可在任意线程调用，[record] 只应在I/O线程调用
+ *
+ * @param rootDir 记录根目录，每个会话一个子目录
+ * @param fileExecutor 创建分段、写回和清理文件的后台执行器，需按提交顺序串行执行
+ */
+class FlightRecorder(
+    private val rootDir: File,
+    private val segmentBytes: Int = DEFAULT_SEGMENT_BYTES,
+    private val maxSegments: Int = DEFAULT_MAX_SEGMENTS,
+    private val fileExecutor: Executor = Executors.newSingleThreadExecutor { runnable ->
+        Thread(runnable, "FlightRecorderFile").apply { isDaemon = true }
+    }
+) {
+    companion object {
+        const val DEFAULT_SEGMENT_BYTES = 4 * 1024 * 1024
+        const val DEFAULT_MAX_SEGMENTS = 16 // 所有会话合计，约64MB
+        const val SEGMENT_SUFFIX = ".ljfr"
+        const val FILE_HEADER_BYTES = 8
+        const val RECORD_HEADER_BYTES = 4 + 8 + 1
+        val FILE_MAGIC = byteArrayOf('L'.code.toByte(), 'J'.code.toByte(), 'F'.code.toByte(), 'R'.code.toByte())
+        const val FORMAT_VERSION = 1
+    }
+
+    /**
+     * 已创建并映射的分段
+     */
+    private class Segment(val file: File, val buffer: MappedByteBuffer)
+
+    /**
+     * 单个会话的写入状态
+     */
+    private inner class Session(val dir: File) {
+        // 只在后台线程修改
+        var segmentIndex = 0
+
+        // 正在写入的分段，只在I/O线程修改
+        @Volatile
+        var buffer: MappedByteBuffer? = null
+
+        // 后台线程预先打开的下一个分段，I/O线程取走
+        val next = AtomicReference<Segment?>(null)
+        val preparing = AtomicBoolean(false)
+
+        @Volatile
+        var failed = false
+    }
+
+    @Volatile
+    private var session: Session? = null
+
+    // 下一个分段未就绪时丢弃的帧数
+    private val droppedFrames = AtomicLong(0)
+
+    val isActive: Boolean
+        get() = session != null
+
+    /**
+     * 因分段未就绪而丢弃的帧数
+     */
+    val droppedFrameCount: Long
+        get() = droppedFrames.get()
+
+    /**
+     * 开始新的记录会话
+     * @return 会话目录
+     */
+    fun startSession(): File {
+        val stamp = SimpleDateFormat("yyyyMMdd-HHmmss", Locale.US).format(Date())
+        var dir = File(rootDir, stamp)
+        var suffix = 1
+        while (dir.exists()) {
+            dir = File(rootDir, "$stamp-${suffix++}")
+        }
+        dir.mkdirs()
+        val created = Session(dir)
+        session = created
+        prepareNextSegment(created)
+        Timber.i("[FlightRecorder] 开始记录: ${dir.absolutePath}")
+        return dir
+    }
+
+    /**
+     * 结束当前会话，在后台写回已映射的数据并删除未用到的预创建分段
+     */
+    fun stopSession() {
+        val current = session ?: return
+        session = null
+        fileExecutor.execute {
+            current.buffer?.let(::forceSegment)
+            current.next.getAndSet(null)?.file?.delete()
+        }
+        Timber.i("[FlightRecorder] 停止记录: ${current.dir.absolutePath}")
+    }
+
+    /**
+     * 记录一帧（I/O线程）
+     */
+    fun record(direction: FrameDirection, bytes: ByteArray, offset: Int, length: Int, timeNanos: Long) {
+        val current = session ?: return
+        if (current.failed) return
+        val needed = RECORD_HEADER_BYTES + length + 4 // 预留结束标记
+        if (needed > segmentBytes - FILE_HEADER_BYTES) return
+
+        var buffer = current.buffer
+        if (buffer == null || buffer.remaining() < needed) {
+            val segment = current.next.getAndSet(null)
+            if (segment == null) {
+                // 下一个分段还在后台创建，丢弃本帧
+                droppedFrames.incrementAndGet()
+                prepareNextSegment(current)
+                return
+            }
+            val retired = buffer
+            buffer = segment.buffer
+            current.buffer = buffer
+            prepareNextSegment(current)
+            retired?.let { fileExecutor.execute { forceSegment(it) } }
+        }
+        buffer.putInt(length)
+        buffer.putLong(timeNanos)
+        buffer.put(direction.code)
+        buffer.put(bytes, offset, length)
+        // 新记录之后的长度字段保持为0，读取方据此判断数据结束
+    }
+
+    /**
+     * 请求后台预先打开会话的下一个分段，已有分段就绪或正在创建时忽略
+     */
+    private fun prepareNextSegment(current: Session) {
+        if (current.failed || current.next.get() != null) return
+        if (!current.preparing.compareAndSet(false, true)) return
+        fileExecutor.execute {
+            try {
+                if (session === current && current.next.get() == null) {
+                    current.next.set(openSegment(current))
+                    pruneSegments()
+                }
+            } catch (e: Exception) {
+                Timber.e(e, "[FlightRecorder] 创建记录分段失败，停止本次会话记录")
+                current.failed = true
+            } finally {
+                current.preparing.set(false)
+            }
+            // 创建期间I/O线程可能已取走分段，此时的请求被忽略，这里补上
+            if (session === current) prepareNextSegment(current)
+        }
+    }
+
+    /**
+     * 创建并映射会话的下一个分段（后台线程）
+     */
+    private fun openSegment(current: Session): Segment {
+        current.dir.mkdirs()
+        val file = File(current.dir, "%03d$SEGMENT_SUFFIX".format(current.segmentIndex++))
+        val buffer = RandomAccessFile(file, "rw").use { raf ->
+            raf.setLength(segmentBytes.toLong())
+            raf.channel.map(FileChannel.MapMode.READ_WRITE, 0, segmentBytes.toLong())
+        }
+        buffer.order(ByteOrder.LITTLE_ENDIAN)
+        buffer.put(FILE_MAGIC)
+        buffer.putInt(FORMAT_VERSION)
+        return Segment(file, buffer)
+    }
+
+    /**
+     * 把写满或结束的分段写回文件（后台线程）
+     */
+    private fun forceSegment(buffer: MappedByteBuffer) {
+        try {
+            buffer.force()
+        } catch (e: Exception) {
+            Timber.w(e, "[FlightRecorder] 写回记录文件失败")
+        }
+    }
+
+    /**
+     * 删除超出总数的最旧分段和空会话目录（后台线程），预先打开的下一个分段不计入总数
+     */
+    private fun pruneSegments() {
+        val sessions = rootDir.listFiles { file -> file.isDirectory }?.sortedBy { it.name } ?: return
+        val segments = sessions.flatMap { dir ->
+            dir.listFiles { file -> file.name.endsWith(SEGMENT_SUFFIX) }?.sortedBy { it.name }.orEmpty()
+        }
+        segments.take((segments.size - maxSegments - 1).coerceAtLeast(0)).forEach { it.delete() }
+        sessions.filter { it.list()?.isEmpty() == true }.forEach { it.delete() }
+    }
+}
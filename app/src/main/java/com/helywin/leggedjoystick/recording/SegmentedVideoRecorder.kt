@@ -0,0 +1,213 @@
+/*********************************************************************************
+ * FileName: SegmentedVideoRecorder.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 分段录像：VLC 按固定时长轮换录制（直接转封装，不转码），完成的分段在后台线程导出到相册
+ * Others: 每个分段使用独立目录，VLC 生成的文件无需按时间猜测；崩溃时最多丢失正在写入的一个分段。
+ *         每个分段旁有同名的遥测 CSV（见 TelemetryRecorder），时间零点与分段开始对齐
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.recording
+
+import android.content.ContentValues
+import android.content.Context
+import android.os.Build
+import android.os.Environment
+import android.os.Handler
+import android.os.HandlerThread
+import android.os.Looper
+import android.provider.MediaStore
+import org.videolan.libvlc.MediaPlayer
+import timber.log.Timber
+import java.io.File
+import java.text.SimpleDateFormat
+import java.util.Date
+import java.util.Locale
+
+/**
+ * 分段录像器
+ * start/stop 在主线程调用；导出在 "VideoRecorderExport" 线程上串行执行
+ *
+ * @param onSegmentSaved 分段导出完成回调（主线程），参数为分段序号和文件大小
+ */
+class SegmentedVideoRecorder(
+    context: Context,
+    private val onSegmentSaved: (index: Int, bytes: Long) -> Unit = { _, _ -> },
+    private val onError: (String) -> Unit = {}
+) {
+    companion object {
+        private const val SEGMENT_DURATION_MS = 60_000L
+        private const val FILE_SETTLE_POLL_MS = 200L
+        private const val FILE_SETTLE_TIMEOUT_MS = 5000L
+        private const val COPY_BUFFER_SIZE = 64 * 1024
+        private const val GALLERY_DIR = "LeggedJoystick"
+    }
+
+    private val appContext = context.applicationContext
+    private val mainHandler = Handler(Looper.getMainLooper())
+    private val exportThread = HandlerThread("VideoRecorderExport").apply { start() }
+    private val exportHandler = Handler(exportThread.looper)
+
+    private var mediaPlayer: MediaPlayer? = null
+    private var sessionName = ""
+    private var sessionDir: File? = null
+    private var segmentIndex = 0
+
+    val isRecording: Boolean
+        get() = mediaPlayer != null
+
+    private val rotateRunnable = object : Runnable {
+        override fun run() {
+            val player = mediaPlayer ?: return
+            // 先结束当前分段再开始下一个，VLC 同一时间只能录制一个文件
+            player.record(null)
+            exportSegment(segmentIndex)
+            if (startSegment(player, segmentIndex + 1)) {
+                mainHandler.postDelayed(this, SEGMENT_DURATION_MS)
+            } else {
+                stopInternal(exportLast = false)
+            }
+        }
+    }
+
+    /**
+     * 开始录像
+     */
+    fun start(player: MediaPlayer): Boolean {
+        if (mediaPlayer != null) return true
+
+        sessionName = "patrol_" + SimpleDateFormat("yyyyMMdd_HHmmss", Locale.getDefault()).format(Date())
+        val dir = File(appContext.cacheDir, "recordings/$sessionName")
+        sessionDir = dir
+
+        if (!startSegment(player, 1)) {
+            return false
+        }
+        mediaPlayer = player
+        TelemetryRecorder.start(telemetryFile(1))
+        mainHandler.postDelayed(rotateRunnable, SEGMENT_DURATION_MS)
+        Timber.i("[VideoRecorder] 开始分段录像: $sessionName")
+        return true
+    }
+
+    /**
+     * 停止录像，最后一个分段在后台导出
+     */
+    fun stop() {
+        stopInternal(exportLast = true)
+    }
+
+    /**
+     * 释放导出线程（导出队列中的任务会先执行完）
+     */
+    fun release() {
+        stop()
+        exportThread.quitSafely()
+    }
+
+    private fun stopInternal(exportLast: Boolean) {
+        val player = mediaPlayer ?: return
+        mainHandler.removeCallbacks(rotateRunnable)
+        player.record(null)
+        mediaPlayer = null
+        TelemetryRecorder.stop()
+        if (exportLast) exportSegment(segmentIndex)
+        Timber.i("[VideoRecorder] 停止分段录像: $sessionName，共${segmentIndex}段")
+    }
+
+    private fun startSegment(player: MediaPlayer, index: Int): Boolean {
+        val dir = segmentDir(index)
+        if (!dir.exists() && !dir.mkdirs()) {
+            Timber.e("[VideoRecorder] 无法创建分段目录: ${dir.absolutePath}")
+            return false
+        }
+        if (!player.record(dir.absolutePath)) {
+            Timber.e("[VideoRecorder] 分段${index}录制启动失败")
+            return false
+        }
+        segmentIndex = index
+        if (index > 1) TelemetryRecorder.rotate(telemetryFile(index))
+        Timber.d("[VideoRecorder] 开始分段$index")
+        return true
+    }
+
+    private fun segmentDir(index: Int) = File(sessionDir, "%04d".format(index))
+
+    private fun segmentName(index: Int) = "${sessionName}_%04d".format(index)
+
+    /**
+     * 遥测文件直接写入应用专属外部存储，与相册中的分段同名
+     */
+    private fun telemetryFile(index: Int): File {
+        val base = appContext.getExternalFilesDir(Environment.DIRECTORY_DOCUMENTS) ?: appContext.filesDir
+        return File(base, "telemetry/$sessionName/${segmentName(index)}.csv")
+    }
+
+    /**
+     * 等待 VLC 写完分段文件后导出到相册并删除缓存
+     */
+    private fun exportSegment(index: Int) {
+        val dir = segmentDir(index)
+        val name = segmentName(index)
+        exportHandler.post {
+            try {
+                val file = waitForSegmentFile(dir)
+                if (file == null) {
+                    Timber.w("[VideoRecorder] 分段${index}没有生成文件")
+                    return@post
+                }
+                val size = file.length()
+                val extension = file.extension.ifEmpty { "ts" }
+                copyToGallery(file, "$name.$extension")
+                dir.deleteRecursively()
+                Timber.i("[VideoRecorder] 分段${index}已保存: $name.$extension, 大小: $size bytes")
+                mainHandler.post { onSegmentSaved(index, size) }
+            } catch (e: Exception) {
+                Timber.e(e, "[VideoRecorder] 导出分段${index}失败")
+                mainHandler.post { onError(e.message ?: "导出失败") }
+            }
+        }
+    }
+
+    /**
+     * 文件大小连续两次不变视为写入完成
+     */
+    private fun waitForSegmentFile(dir: File): File? {
+        var lastSize = -1L
+        var waited = 0L
+        while (waited < FILE_SETTLE_TIMEOUT_MS) {
+            val file = dir.listFiles { f -> f.isFile && f.length() > 0 }?.maxByOrNull { it.lastModified() }
+            if (file != null) {
+                val size = file.length()
+                if (size == lastSize) return file
+                lastSize = size
+            }
+            Thread.sleep(FILE_SETTLE_POLL_MS)
+            waited += FILE_SETTLE_POLL_MS
+        }
+        return dir.listFiles { f -> f.isFile && f.length() > 0 }?.maxByOrNull { it.lastModified() }
+    }
+
+    private fun copyToGallery(file: File, displayName: String) {
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) {
+            val contentValues = ContentValues().apply {
+                put(MediaStore.Video.Media.DISPLAY_NAME, displayName)
+                put(MediaStore.Video.Media.MIME_TYPE, if (file.extension == "mp4") "video/mp4" else "video/mp2t")
+                put(MediaStore.Video.Media.RELATIVE_PATH, Environment.DIRECTORY_MOVIES + "/" + GALLERY_DIR)
+            }
+            val uri = appContext.contentResolver.insert(MediaStore.Video.Media.EXTERNAL_CONTENT_URI, contentValues)
+                ?: throw IllegalStateException("无法创建 MediaStore URI")
+            appContext.contentResolver.openOutputStream(uri)?.use { output ->
+                file.inputStream().use { it.copyTo(output, COPY_BUFFER_SIZE) }
+            }
+        } else {
+            @Suppress("DEPRECATION")
+            val appDir = File(Environment.getExternalStoragePublicDirectory(Environment.DIRECTORY_MOVIES), GALLERY_DIR)
+            if (!appDir.exists()) appDir.mkdirs()
+            file.inputStream().use { input ->
+                File(appDir, displayName).outputStream().use { input.copyTo(it, COPY_BUFFER_SIZE) }
+            }
+        }
+    }
+}
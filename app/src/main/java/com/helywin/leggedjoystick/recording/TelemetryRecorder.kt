@@ -0,0 +1,258 @@
+/*********************************************************************************
+ * FileName: TelemetryRecorder.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 录像时同步记录控制遥测（速度指令、里程计），按视频分段写入CSV
+ * Others: 生产者写入预分配的环形缓冲区，缓冲区满时丢弃并计数，写盘在独立线程，
+ *         长时间录制不增长堆内存也不阻塞控制线程和接收线程
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.recording
+
+import android.os.SystemClock
+import timber.log.Timber
+import java.io.BufferedWriter
+import java.io.File
+import java.io.FileOutputStream
+import java.io.OutputStreamWriter
+import java.util.concurrent.locks.LockSupport
+
+/**
+ * 遥测记录器，进程内唯一
+ * 每条记录的时间为相对当前视频分段开始的毫秒数，与分段视频的播放时间对齐
+ */
+object TelemetryRecorder {
+    private const val CAPACITY = 4096 // 约为100Hz速度指令 + 50Hz里程计下27秒的数据
+    private const val VALUES_PER_RECORD = 10
+    private const val FLUSH_INTERVAL_MS = 200L
+    private const val WRITE_BUFFER_SIZE = 64 * 1024
+
+    private const val TYPE_VELOCITY = 1
+    private const val TYPE_ODOMETRY = 2
+
+    private const val CSV_HEADER = "t_ms,wall_ms,type," +
+            "vx|px,vy|py,yaw_rate|pz,qx,qy,qz,qw,lin_vx,lin_vy,ang_vz"
+
+    @Volatile
+    var isActive = false
+        private set
+
+    // 记录时钟，JVM单元测试中没有 SystemClock，替换为 System.nanoTime
+    internal var clock: () -> Long = SystemClock::elapsedRealtimeNanos
+
+    private val lock = Any()
+
+    // 串行化 start/stop：stop 等旧写线程退出后才释放，新写线程不会与旧写线程共用拷贝区和文件
+    private val lifecycleLock = Any()
+
+    // 环形缓冲区（生产者在锁内写入）
+    private val times = LongArray(CAPACITY)
+    private val wallTimes = LongArray(CAPACITY)
+    private val types = IntArray(CAPACITY)
+    private val values = FloatArray(CAPACITY * VALUES_PER_RECORD)
+    private var head = 0
+    private var size = 0
+    private var dropped = 0L
+
+    // 写线程的拷贝区
+    private val drainTimes = LongArray(CAPACITY)
+    private val drainWallTimes = LongArray(CAPACITY)
+    private val drainTypes = IntArray(CAPACITY)
+    private val drainValues = FloatArray(CAPACITY * VALUES_PER_RECORD)
+    private val line = StringBuilder(256)
+
+    // 待切换的分段（锁内访问）
+    private var pendingFile: File? = null
+    private var pendingStartNanos = 0L
+    private var writerThread: Thread? = null
+
+    // 当前分段（仅写线程访问）
+    private var writer: BufferedWriter? = null
+    private var segmentStartNanos = 0L
+
+    /**
+     * 开始记录，写入第一个分段文件
+     */
+    fun start(file: File) = synchronized(lifecycleLock) {
+        synchronized(lock) { startLocked(file) }
+    }
+
+    private fun startLocked(file: File) {
+        if (isActive) return
+        head = 0
+        size = 0
+        dropped = 0
+        pendingFile = file
+        pendingStartNanos = clock()
+        isActive = true
+        writerThread = Thread(::writerLoop, "TelemetryWriter").apply {
+            isDaemon = true
+            start()
+        }
+        Timber.i("[TelemetryRecorder] 开始记录遥测: ${file.absolutePath}")
+    }
+
+    /**
+     * 切换到新的分段文件，之后的记录时间以此刻为零点
+     */
+    fun rotate(file: File) = synchronized(lock) {
+        if (!isActive) return@synchronized
+        // 此刻之前的记录仍写入旧分段
+        pendingFile = file
+        pendingStartNanos = clock()
+        LockSupport.unpark(writerThread)
+    }
+
+    /**
+     * 停止记录，等写线程写完剩余数据并关闭文件后返回
+     */
+    fun stop() = synchronized(lifecycleLock) { stopAndJoin() }
+
+    private fun stopAndJoin() {
+        val thread = synchronized(lock) {
+            if (!isActive) return
+            isActive = false
+            writerThread.also { writerThread = null }
+        }
+        thread?.let {
+            LockSupport.unpark(it)
+            it.join()
+        }
+        Timber.i("[TelemetryRecorder] 停止记录遥测，丢弃${dropped}条")
+    }
+
+    /**
+     * 记录一条速度指令（控制线程）
+     */
+    fun recordVelocity(vx: Float, vy: Float, yawRate: Float) {
+        if (!isActive) return
+        synchronized(lock) {
+            val base = append(TYPE_VELOCITY) ?: return
+            values[base] = vx
+            values[base + 1] = vy
+            values[base + 2] = yawRate
+        }
+    }
+
+    /**
+     * 记录一条里程计（接收线程）
+     */
+    fun recordOdometry(
+        px: Float, py: Float, pz: Float,
+        qx: Float, qy: Float, qz: Float, qw: Float,
+        linVx: Float, linVy: Float, angVz: Float
+    ) {
+        if (!isActive) return
+        synchronized(lock) {
+            val base = append(TYPE_ODOMETRY) ?: return
+            values[base] = px
+            values[base + 1] = py
+            values[base + 2] = pz
+            values[base + 3] = qx
+            values[base + 4] = qy
+            values[base + 5] = qz
+            values[base + 6] = qw
+            values[base + 7] = linVx
+            values[base + 8] = linVy
+            values[base + 9] = angVz
+        }
+    }
+
+    /**
+     * 分配一条记录，返回其数值区起始下标；缓冲区满时返回 null
+     */
+    private fun append(type: Int): Int? {
+        if (size == CAPACITY) {
+            dropped++
+            return null
+        }
+        val index = (head + size) % CAPACITY
+        size++
+        times[index] = clock()
+        wallTimes[index] = System.currentTimeMillis()
+        types[index] = type
+        val base = index * VALUES_PER_RECORD
+        values.fill(0f, base, base + VALUES_PER_RECORD)
+        return base
+    }
+
+    private fun writerLoop() {
+        try {
+            while (true) {
+                val active = isActive
+                drainAndWrite()
+                if (!active) break
+                LockSupport.parkNanos(FLUSH_INTERVAL_MS * 1_000_000)
+            }
+        } catch (e: Exception) {
+            Timber.e(e, "[TelemetryRecorder] 写入遥测失败")
+        } finally {
+            closeWriter()
+        }
+    }
+
+    private fun drainAndWrite() {
+        val count: Int
+        var nextFile: File?
+        val nextStartNanos: Long
+        synchronized(lock) {
+            nextFile = pendingFile
+            nextStartNanos = pendingStartNanos
+            pendingFile = null
+            count = size
+            for (i in 0 until count) {
+                val index = (head + i) % CAPACITY
+                drainTimes[i] = times[index]
+                drainWallTimes[i] = wallTimes[index]
+                drainTypes[i] = types[index]
+                values.copyInto(drainValues, i * VALUES_PER_RECORD, index * VALUES_PER_RECORD,
+                    (index + 1) * VALUES_PER_RECORD)
+            }
+            head = (head + count) % CAPACITY
+            size = 0
+        }
+
+        for (i in 0 until count) {
+            // 分段切换点之后的记录写入新分段
+            nextFile?.let { file ->
+                if (drainTimes[i] >= nextStartNanos) {
+                    openWriter(file, nextStartNanos)
+                    nextFile = null
+                }
+            }
+            val out = writer ?: continue
+            line.setLength(0)
+            line.append((drainTimes[i] - segmentStartNanos) / 1_000_000).append(',')
+                .append(drainWallTimes[i]).append(',')
+                .append(if (drainTypes[i] == TYPE_VELOCITY) "vel" else "odom")
+            val base = i * VALUES_PER_RECORD
+            val valueCount = if (drainTypes[i] == TYPE_VELOCITY) 3 else VALUES_PER_RECORD
+            for (j in 0 until valueCount) {
+                line.append(',').append(drainValues[base + j])
+            }
+            line.append('\n')
+            out.append(line)
+        }
+        nextFile?.let { openWriter(it, nextStartNanos) }
+        writer?.flush()
+    }
+
+    private fun openWriter(file: File, startNanos: Long) {
+        closeWriter()
+        segmentStartNanos = startNanos
+        file.parentFile?.mkdirs()
+        writer = BufferedWriter(OutputStreamWriter(FileOutputStream(file), Charsets.UTF_8), WRITE_BUFFER_SIZE).apply {
+            append(CSV_HEADER).append('\n')
+        }
+    }
+
+    private fun closeWriter() {
+        try {
+            writer?.close()
+        } catch (e: Exception) {
+            Timber.w(e, "[TelemetryRecorder] 关闭遥测文件失败")
+        }
+        writer = null
+    }
+}
@@ -0,0 +1,51 @@
+/*********************************************************************************
+ * FileName: PerfTrace.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 系统跟踪（Perfetto/systrace）区段和计数器，覆盖输入、控制周期和网络收发
+ * Others: 由 BuildConfig.ENABLE_TRACING 控制，关闭时分支为编译期常量，R8 会移除全部插桩；
+ *         区段名使用常量，不在热路径上拼接字符串
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.trace
+
+import androidx.tracing.Trace
+import com.helywin.leggedjoystick.BuildConfig
+
+/**
+ * 跟踪区段和计数器名称
+ */
+object TraceNames {
+    const val INPUT_MOTION_EVENT = "Input.motionEvent"
+    const val INPUT_BATCH_SAMPLES = "Input.batchSamples"
+    const val CONTROL_LATENESS_US = "Control.latenessUs"
+    const val ZMQ_RECEIVE = "Zmq.receive"
+    const val ZMQ_RECEIVE_TELEMETRY = "Zmq.receiveTelemetry"
+    const val ZMQ_SEND = "Zmq.send"
+    const val ZMQ_SEND_QUEUE = "Zmq.sendQueue"
+}
+
+object PerfTrace {
+    /**
+     * 在跟踪区段内执行 [block]，跟踪关闭时直接执行
+     */
+    inline fun <T> section(name: String, block: () -> T): T {
+        if (!BuildConfig.ENABLE_TRACING) return block()
+        Trace.beginSection(name)
+        try {
+            return block()
+        } finally {
+            Trace.endSection()
+        }
+    }
+
+    /**
+     * 更新计数器轨道
+     */
+    fun counter(name: String, value: Int) {
+        if (BuildConfig.ENABLE_TRACING) {
+            Trace.setCounter(name, value)
+        }
+    }
+}
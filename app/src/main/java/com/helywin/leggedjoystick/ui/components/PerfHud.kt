@@ -0,0 +1,190 @@
+/*********************************************************************************
+ * FileName: PerfHud.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 性能浮层：在手柄调试信息下方显示控制循环、网络、视频解码和GC指标
+ * Others: 浮层显示期间每 500ms 采样一次无锁计数器，隐藏后不再采样；
+ *         速率由相邻两次采样求差得到，热路径上只做原子累加
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.ui.components
+
+import androidx.compose.foundation.layout.*
+import androidx.compose.material3.*
+import androidx.compose.runtime.*
+import androidx.compose.ui.Modifier
+import androidx.compose.ui.graphics.Color
+import androidx.compose.ui.text.font.FontFamily
+import androidx.compose.ui.text.font.FontWeight
+import androidx.compose.ui.unit.dp
+import com.helywin.leggedjoystick.controller.PerfRates
+import com.helywin.leggedjoystick.controller.PerfSnapshot
+import com.helywin.leggedjoystick.controller.ratesSince
+import com.helywin.leggedjoystick.input.GamepadInputState
+import com.helywin.leggedjoystick.ui.video.VideoSessionManager
+import com.helywin.leggedjoystick.ui.video.VideoStats
+import kotlinx.coroutines.delay
+import kotlinx.coroutines.isActive
+import legged_driver.MessageType
+
+private const val SAMPLE_INTERVAL_MS = 500L
+private val HUD_WIDTH = 340.dp
+private val WARNING_COLOR = Color(0xFFFF9800)
+
+/**
+ * 浮层显示的一次采样结果
+ *
+ * @param videoFps 区间内的解码帧率，未播放视频时为 null
+ * @param videoLostFrames 区间内丢弃的视频帧数
+ */
+private class PerfHudData(
+    val snapshot: PerfSnapshot,
+    val rates: PerfRates,
+    val videoFps: Float?,
+    val videoLostFrames: Long
+)
+
+/**
+ * 性能浮层
+ * @param sample 采样函数，在主线程按低频调用
+ * @param gamepadState 游戏手柄输入状态
+ * @param modifier 修饰符
+ */
+@Composable
+fun PerfHud(
+    sample: () -> PerfSnapshot,
+    gamepadState: GamepadInputState,
+    modifier: Modifier = Modifier
+) {
+    val currentSample by rememberUpdatedState(sample)
+    var data by remember { mutableStateOf<PerfHudData?>(null) }
+
+    LaunchedEffect(Unit) {
+        var previous: PerfSnapshot? = null
+        var previousVideo: VideoStats? = null
+        while (isActive) {
+            val snapshot = currentSample()
+            val video = VideoSessionManager.sampleStats()
+            var videoFps: Float? = null
+            var videoLost = 0L
+            val lastVideo = previousVideo
+            val lastSnapshot = previous
+            if (video != null && lastVideo != null && lastSnapshot != null &&
+                video.decodedFrames >= lastVideo.decodedFrames
+            ) {
+                // 切换媒体后统计从零开始，此时跳过一个区间
+                val seconds = (snapshot.timeNanos - lastSnapshot.timeNanos) / 1e9f
+                videoFps = (video.decodedFrames - lastVideo.decodedFrames) / seconds
+                videoLost = (video.lostFrames - lastVideo.lostFrames).coerceAtLeast(0)
+            }
+            data = PerfHudData(snapshot, snapshot.ratesSince(previous), videoFps, videoLost)
+            previous = snapshot
+            previousVideo = video
+            delay(SAMPLE_INTERVAL_MS)
+        }
+    }
+
+    Column(
+        modifier = modifier.width(HUD_WIDTH)
+    ) {
+        GamepadDebugInfo(gamepadState = gamepadState)
+        data?.let { PerfMetricsCard(it) }
+    }
+}
+
+/**
+ * 性能指标卡片
+ */
+@Composable
+private fun PerfMetricsCard(data: PerfHudData) {
+    val snapshot = data.snapshot
+    val rates = data.rates
+    val loop = snapshot.controlLoop
+    val input = snapshot.inputToSendUs
+    val link = snapshot.linkStats
+
+    Card(
+        modifier = Modifier
+            .padding(horizontal = 8.dp)
+            .fillMaxWidth(),
+        elevation = CardDefaults.cardElevation(defaultElevation = 4.dp)
+    ) {
+        Column(
+            modifier = Modifier.padding(12.dp),
+            verticalArrangement = Arrangement.spacedBy(2.dp)
+        ) {
+            Text(
+                text = "性能指标",
+                style = MaterialTheme.typography.titleMedium,
+                fontWeight = FontWeight.Bold
+            )
+
+            MetricLine(
+                "控制循环",
+                "${loop.ticks}/${loop.rateHz}Hz 抖动 ${loop.meanLatenessUs}/${loop.maxLatenessUs}us",
+                warning = loop.rateHz > 0 && loop.ticks < loop.rateHz * 9 / 10
+            )
+            MetricLine(
+                "输入→发送",
+                if (input.samples == 0L) "--" else "均值 %.1fms 最大 %.1fms".format(input.meanUs / 1000f, input.maxUs / 1000f)
+            )
+            MetricLine(
+                "发送队列",
+                "${snapshot.sendQueueSize} 连续失败 ${snapshot.consecutiveFailures}",
+                warning = snapshot.consecutiveFailures > 0
+            )
+            MetricLine(
+                "往返时延",
+                if (link.hasRtt) "%.1fms p95 %.1fms".format(link.lastRttUs / 1000f, link.rttP95Us / 1000f) else "--"
+            )
+            MetricLine(
+                "接收频率",
+                "里程计 %.0f 心跳 %.0f 电量 %.0f Hz".format(
+                    rates.receiveHz(MessageType.MESSAGE_TYPE_ODOMETRY),
+                    rates.receiveHz(MessageType.MESSAGE_TYPE_HEARTBEAT),
+                    rates.receiveHz(MessageType.MESSAGE_TYPE_BATTERY_INFO)
+                )
+            )
+            MetricLine(
+                "丢弃/校验失败",
+                "${rates.droppedFrames}/${rates.decodeFailures} (累计 " +
+                        "${snapshot.linkCounters.droppedFrames}/${snapshot.linkCounters.decodeFailures})",
+                warning = rates.decodeFailures > 0
+            )
+            MetricLine(
+                "视频解码",
+                data.videoFps?.let { "%.1f fps 丢帧 %d".format(it, data.videoLostFrames) } ?: "--",
+                warning = data.videoLostFrames > 0
+            )
+            MetricLine(
+                "GC",
+                if (snapshot.gcCount < 0) "--" else "${snapshot.gcCount} (+${rates.gcCount})",
+                warning = rates.gcCount > 0
+            )
+        }
+    }
+}
+
+/**
+ * 单行指标
+ */
+@Composable
+private fun MetricLine(label: String, value: String, warning: Boolean = false) {
+    Row(
+        modifier = Modifier.fillMaxWidth(),
+        horizontalArrangement = Arrangement.SpaceBetween
+    ) {
+        Text(
+            text = label,
+            style = MaterialTheme.typography.bodySmall,
+            color = MaterialTheme.colorScheme.onSurfaceVariant
+        )
+        Text(
+            text = value,
+            style = MaterialTheme.typography.bodySmall,
+            fontFamily = FontFamily.Monospace,
+            color = if (warning) WARNING_COLOR else MaterialTheme.colorScheme.onSurface
+        )
+    }
+}
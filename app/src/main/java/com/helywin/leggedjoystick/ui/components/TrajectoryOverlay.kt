@@ -0,0 +1,205 @@
+/*********************************************************************************
+ * FileName: TrajectoryOverlay.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 小地图轨迹叠加层，以机器人为中心绘制最近的行走路径和航向
+ * Others: 路径分成若干段预分配的 Path，新样本只追加到当前段，最旧的段整体 rewind 后复用，
+ *         不会每帧从列表重建路径；有新样本时才在下一帧使绘制阶段失效，不触发重组
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.ui.components
+
+import androidx.compose.foundation.Canvas
+import androidx.compose.runtime.*
+import androidx.compose.ui.Modifier
+import androidx.compose.ui.geometry.CornerRadius
+import androidx.compose.ui.geometry.Offset
+import androidx.compose.ui.graphics.Color
+import androidx.compose.ui.graphics.Path
+import androidx.compose.ui.graphics.StrokeCap
+import androidx.compose.ui.graphics.StrokeJoin
+import androidx.compose.ui.graphics.drawscope.DrawScope
+import androidx.compose.ui.graphics.drawscope.Stroke
+import androidx.compose.ui.graphics.drawscope.clipRect
+import androidx.compose.ui.graphics.drawscope.withTransform
+import androidx.compose.ui.unit.dp
+import com.helywin.leggedjoystick.odometry.OdometryBuffer
+import com.helywin.leggedjoystick.odometry.TrajectoryWindow
+
+private const val CHUNK_COUNT = 8
+private const val POINTS_PER_CHUNK = 128
+private const val MIN_SEGMENT_METERS = 0.02f // 小于该距离的移动不追加新点
+private const val DEFAULT_METERS_ACROSS = 10f
+
+/**
+ * 轨迹叠加层，缓冲区为空时不绘制任何内容
+ * @param odometryBuffer 里程计缓冲区
+ * @param metersAcross 叠加层宽度对应的实际距离（米）
+ */
+@Composable
+fun TrajectoryOverlay(
+    odometryBuffer: OdometryBuffer,
+    modifier: Modifier = Modifier,
+    metersAcross: Float = DEFAULT_METERS_ACROSS,
+    pathColor: Color = Color(0xFF4CAF50),
+    robotColor: Color = Color.White
+) {
+    val renderer = remember(odometryBuffer) { TrajectoryRenderer(odometryBuffer) }
+    var drawVersion by remember { mutableIntStateOf(0) }
+
+    // 挂起到有新样本，再在下一帧使绘制失效；没有里程计时不占用帧回调
+    LaunchedEffect(renderer) {
+        var seen = renderer.consumedWriteCount
+        while (true) {
+            odometryBuffer.awaitWrite(seen)
+            seen = odometryBuffer.writeCount
+            withFrameNanos { drawVersion++ }
+        }
+    }
+
+    Canvas(modifier = modifier) {
+        // 只在绘制阶段读取，状态变化不触发重组
+        drawVersion
+        renderer.update()
+        if (renderer.hasPoints) {
+            renderer.draw(this, metersAcross, pathColor, robotColor)
+        }
+    }
+}
+
+/**
+ * 轨迹路径的增量维护和绘制，仅在主线程使用
+ */
+private class TrajectoryRenderer(private val buffer: OdometryBuffer) {
+    // 分段路径环：current 为正在追加的段，下一个为最旧的段
+    private val chunks = Array(CHUNK_COUNT) { Path() }
+    private val chunkPoints = IntArray(CHUNK_COUNT)
+    private var current = 0
+    private val scratch = TrajectoryWindow(OdometryBuffer.DEFAULT_CAPACITY)
+
+    private var lastX = 0f
+    private var lastY = 0f
+    private var robotX = 0f
+    private var robotY = 0f
+    private var robotYaw = 0f
+
+    // 绘制对象按尺寸缓存
+    private val robotMarker = Path()
+    private var markerSizePx = 0f
+    private var pathStroke = Stroke()
+    private var strokeScale = 0f
+
+    var consumedWriteCount = 0L
+        private set
+    var hasPoints = false
+        private set
+
+    /**
+     * 把缓冲区中的新样本追加到路径
+     */
+    fun update() {
+        val writes = buffer.copyNewer(consumedWriteCount, scratch)
+        if (writes < consumedWriteCount) {
+            // 缓冲区已清空（重新连接），轨迹从头开始
+            reset()
+        }
+        consumedWriteCount = writes
+        val n = scratch.size
+        if (n == 0) return
+        for (j in 0 until n) {
+            append(scratch.x[j], scratch.y[j])
+        }
+        robotX = scratch.x[n - 1]
+        robotY = scratch.y[n - 1]
+        robotYaw = scratch.yaw[n - 1]
+    }
+
+    private fun reset() {
+        for (i in 0 until CHUNK_COUNT) {
+            chunks[i].rewind()
+            chunkPoints[i] = 0
+        }
+        current = 0
+        hasPoints = false
+    }
+
+    private fun append(x: Float, y: Float) {
+        if (!hasPoints) {
+            chunks[current].moveTo(x, y)
+            chunkPoints[current] = 1
+            lastX = x
+            lastY = y
+            hasPoints = true
+            return
+        }
+        val dx = x - lastX
+        val dy = y - lastY
+        if (dx * dx + dy * dy < MIN_SEGMENT_METERS * MIN_SEGMENT_METERS) return
+
+        if (chunkPoints[current] >= POINTS_PER_CHUNK) {
+            // 当前段已满，复用最旧的段，从上一个点接续
+            current = (current + 1) % CHUNK_COUNT
+            chunks[current].rewind()
+            chunks[current].moveTo(lastX, lastY)
+            chunkPoints[current] = 1
+        }
+        chunks[current].lineTo(x, y)
+        chunkPoints[current]++
+        lastX = x
+        lastY = y
+    }
+
+    /**
+     * 世界坐标 x 向右、y 向上，以机器人当前位置为中心
+     */
+    fun draw(scope: DrawScope, metersAcross: Float, pathColor: Color, robotColor: Color) = with(scope) {
+        val cornerRadius = 12.dp.toPx()
+        drawRoundRect(color = Color.Black.copy(alpha = 0.45f), cornerRadius = CornerRadius(cornerRadius))
+
+        val scale = size.minDimension / metersAcross
+        if (scale != strokeScale) {
+            // 路径在世界坐标下绘制，线宽需要换算成米
+            pathStroke = Stroke(
+                width = 2.dp.toPx() / scale,
+                cap = StrokeCap.Round,
+                join = StrokeJoin.Round
+            )
+            strokeScale = scale
+        }
+
+        clipRect {
+            withTransform({
+                translate(center.x, center.y)
+                scale(scale, -scale, pivot = Offset.Zero)
+                translate(-robotX, -robotY)
+            }) {
+                // 从最旧的段开始，越旧越淡
+                for (k in 0 until CHUNK_COUNT) {
+                    val index = (current + 1 + k) % CHUNK_COUNT
+                    if (chunkPoints[index] < 2) continue
+                    val alpha = (k + 1).toFloat() / CHUNK_COUNT
+                    drawPath(chunks[index], pathColor.copy(alpha = pathColor.alpha * alpha), style = pathStroke)
+                }
+            }
+
+            val markerSize = 8.dp.toPx()
+            if (markerSize != markerSizePx) {
+                // 三角形，朝 +x 方向
+                robotMarker.rewind()
+                robotMarker.moveTo(markerSize, 0f)
+                robotMarker.lineTo(-markerSize * 0.7f, markerSize * 0.7f)
+                robotMarker.lineTo(-markerSize * 0.7f, -markerSize * 0.7f)
+                robotMarker.close()
+                markerSizePx = markerSize
+            }
+            withTransform({
+                translate(center.x, center.y)
+                // 屏幕 y 轴向下，航向角取反
+                rotate(-Math.toDegrees(robotYaw.toDouble()).toFloat(), pivot = Offset.Zero)
+            }) {
+                drawPath(robotMarker, robotColor)
+            }
+        }
+    }
+}
@@ -19,20 +19,16 @@ import androidx.compose.ui.graphics.drawscope.Stroke
 import androidx.compose.ui.input.pointer.pointerInput
 import androidx.compose.ui.input.pointer.PointerEventType
 import androidx.compose.ui.input.pointer.PointerInputChange
-import androidx.compose.ui.layout.onSizeChanged
 import androidx.compose.ui.platform.LocalDensity
 import androidx.compose.ui.tooling.preview.Preview
 import androidx.compose.ui.unit.Dp
-import androidx.compose.ui.unit.IntSize
 import androidx.compose.ui.unit.dp
-import kotlinx.coroutines.delay
-import kotlinx.coroutines.isActive
 import timber.log.Timber
 import kotlin.math.min
 
 /**
  * 方形虚拟摇杆组件
- * 支持在正方形区域内任意拖动，具有最大速度限制、自动回零和20Hz回调功能
+ * 支持在正方形区域内任意拖动，具有最大速度限制和自动回零，摇杆值每次变化时在输入事件中直接回调
  * 
  * @param modifier 修饰符
  * @param size 摇杆区域大小
@@ -41,7 +37,7 @@ import kotlin.math.min
  * @param backgroundColor 背景颜色
  * @param knobColor 摇杆把手颜色
  * @param borderColor 边框颜色
- * @param onValueChange 值变化回调，当摇杆离开零位时以20Hz频率调用
+ * @param onValueChange 值变化回调，只在摇杆值实际变化时调用（包括释放回零）
  * @param enhancedCallback 增强回调，包含释放事件
  */
 @Composable
@@ -56,25 +52,23 @@ fun SquareVirtualJoystick(
     onValueChange: JoystickCallback? = null,
     enhancedCallback: EnhancedJoystickCallback? = null
 ) {
-    var canvasSize by remember { mutableStateOf(IntSize.Zero) }
+    // 把手位置只在绘制阶段读取，拖动只触发重绘，不触发重组
     var currentValue by remember { mutableStateOf(JoystickValue.ZERO) }
-    var isDragging by remember { mutableStateOf(false) }
+    val currentOnValueChange by rememberUpdatedState(onValueChange)
+    val currentEnhancedCallback by rememberUpdatedState(enhancedCallback)
     
     val density = LocalDensity.current
     val knobSizePx = with(density) { knobSize.toPx() }
     val halfKnobSize = knobSizePx / 2f
     
-    // 20Hz回调协程
-    LaunchedEffect(currentValue, isDragging, onValueChange, enhancedCallback) {
-        if ((onValueChange != null || enhancedCallback != null) && (!currentValue.isCenter || isDragging)) {
-            while (isActive && (!currentValue.isCenter || isDragging)) {
-                onValueChange?.onValueChanged(currentValue)
-                enhancedCallback?.onValueChanged(currentValue)
-                delay(50) // 20Hz = 1000ms / 20 = 50ms
-            }
-        }
+    // 摇杆值变化时立即回调，不经过主线程上的轮询，值未变化时不重复写入
+    fun publish(value: JoystickValue) {
+        if (value == currentValue) return
+        currentValue = value
+        currentOnValueChange?.onValueChanged(value)
+        currentEnhancedCallback?.onValueChanged(value)
     }
-    
+
     Box(
         modifier = modifier
             .size(size)
@@ -83,21 +77,19 @@ fun SquareVirtualJoystick(
         Canvas(
             modifier = Modifier
                 .fillMaxSize()
-                .onSizeChanged { canvasSize = it }
                 .pointerInput(Unit) {
                     awaitEachGesture {
                         val down = awaitFirstDown()
                         
-                        // 按下时立即触发
-                        isDragging = true
-                        val center = Offset(canvasSize.width / 2f, canvasSize.height / 2f)
-                        val maxRadius = min(canvasSize.width, canvasSize.height) / 2f - halfKnobSize
+                        // size 参数是摇杆的Dp尺寸，这里取指针输入区域的像素尺寸
+                        val center = Offset(this.size.width / 2f, this.size.height / 2f)
+                        val maxRadius = min(this.size.width, this.size.height) / 2f - halfKnobSize
                         
                         // 计算初始位置 (不应用maxVelocity缩放，保持[-1,1]范围)
-                        currentValue = down.position.toJoystickValue(center, maxRadius)
+                        publish(down.position.toJoystickValue(center, maxRadius))
                         
                         // 立即触发按下回调
-                        enhancedCallback?.onPressed()
+                        currentEnhancedCallback?.onPressed()
                         Timber.d("SquareJoystick pressed: $currentValue")
                         
                         // 处理拖动
@@ -107,21 +99,19 @@ fun SquareVirtualJoystick(
                             
                             if (change.pressed) {
                                 // 更新拖动位置 (不应用maxVelocity缩放，保持[-1,1]范围)
-                                currentValue = change.position.toJoystickValue(center, maxRadius)
+                                publish(change.position.toJoystickValue(center, maxRadius))
                                 change.consume()
                             }
                         } while (event.changes.any { it.pressed })
                         
-                        // 释放时触发
-                        isDragging = false
-                        currentValue = JoystickValue.ZERO
-                        enhancedCallback?.onReleased()
+                        // 释放时回零
+                        publish(JoystickValue.ZERO)
+                        currentEnhancedCallback?.onReleased()
                         Timber.d("SquareJoystick released: $currentValue")
                     }
                 }
         ) {
             drawSquareJoystick(
-                size = canvasSize,
                 currentValue = currentValue,
                 knobSize = knobSizePx,
                 knobColor = knobColor,
@@ -135,7 +125,6 @@ fun SquareVirtualJoystick(
  * 绘制方形摇杆
  */
 private fun DrawScope.drawSquareJoystick(
-    size: IntSize,
     currentValue: JoystickValue,
     knobSize: Float,
     knobColor: Color,
@@ -149,7 +138,7 @@ private fun DrawScope.drawSquareJoystick(
     drawRect(
         color = borderColor,
         topLeft = Offset.Zero,
-        size = Size(size.width.toFloat(), size.height.toFloat()),
+        size = size,
         style = Stroke(width = 2.dp.toPx())
     )
     
@@ -29,6 +29,7 @@ import androidx.compose.ui.geometry.Offset
 import androidx.compose.ui.graphics.Brush
 import androidx.compose.ui.graphics.Color
 import androidx.compose.ui.layout.ContentScale
+import androidx.compose.ui.platform.testTag
 import androidx.compose.ui.platform.LocalConfiguration
 import androidx.compose.ui.platform.LocalDensity
 import androidx.compose.ui.text.font.FontWeight
@@ -36,21 +37,31 @@ import androidx.compose.ui.tooling.preview.Preview
 import androidx.compose.ui.unit.dp
 import androidx.compose.ui.unit.sp
 import coil.compose.rememberAsyncImagePainter
+import com.helywin.leggedjoystick.controller.ControlInputSnapshot
 import com.helywin.leggedjoystick.controller.Controller
+import com.helywin.leggedjoystick.controller.PerfSnapshot
 import com.helywin.leggedjoystick.proto.displayName
 import com.helywin.leggedjoystick.controller.RobotControllerImpl
 import com.helywin.leggedjoystick.controller.settingsState
 import com.helywin.leggedjoystick.data.ConnectionState
+import com.helywin.leggedjoystick.data.RobotProfile
 import com.helywin.leggedjoystick.data.SpeedLevel
 import com.helywin.leggedjoystick.input.GamepadInputHandler
 import com.helywin.leggedjoystick.input.GamepadInputState
+import com.helywin.leggedjoystick.odometry.OdometryBuffer
 import legged_driver.ControlMode
 import legged_driver.Mode
 import com.helywin.leggedjoystick.ui.components.ConnectionDialog
 import com.helywin.leggedjoystick.ui.components.GamepadStatusIndicator
+import com.helywin.leggedjoystick.ui.components.TrajectoryOverlay
 import com.helywin.leggedjoystick.ui.joystick.*
+import com.helywin.leggedjoystick.zmq.LinkStatsSnapshot
 import kotlin.random.Random
 
+// 摇杆的测试标签，宏基准通过资源ID找到摇杆
+const val LEFT_JOYSTICK_TAG = "left_joystick"
+const val RIGHT_JOYSTICK_TAG = "right_joystick"
+
 /**
  * 渐变点数据类
  */
@@ -72,15 +83,45 @@ fun MainControlScreen(
     onSettingsClick: () -> Unit,
     onVideoClick: () -> Unit
 ) {
-    val currentMode = settingsState.robotCtrlMode
-    val controlMode = settingsState.robotMode
+    // 这里只读取会改变页面结构的状态；电量、模式、档位等以 lambda 传给各自的组件，
+    // 状态变化只重组对应组件，不影响摇杆
     val connectionState = settingsState.connectionState
-    val batteryLevel = settingsState.batteryLevel
-    val speedLevel = settingsState.settings.speedLevel
-    val isRobotModeChanging = settingsState.isRobotCtrlModeChanging
-    val isRobotCtrlModeChanging = settingsState.isRobotCtrlModeChanging
     val mainTitle = settingsState.settings.mainTitle
     val logoPath = settingsState.settings.logoPath
+    val robots = settingsState.settings.robots
+    val activeRobotId = settingsState.settings.activeRobot.id
+
+    // 摇杆回调与界面状态无关，只创建一次；拖动事件中直接写入控制器的输入快照
+    val leftJoystickCallback = remember(controller) {
+        object : EnhancedJoystickCallback {
+            override fun onValueChanged(value: JoystickValue) {
+                controller.updateLeftJoystick(value)
+            }
+
+            override fun onPressed() {
+                controller.onLeftJoystickPressed()
+            }
+
+            override fun onReleased() {
+                controller.onLeftJoystickReleased()
+            }
+        }
+    }
+    val rightJoystickCallback = remember(controller) {
+        object : EnhancedJoystickCallback {
+            override fun onValueChanged(value: JoystickValue) {
+                controller.updateRightJoystick(value)
+            }
+
+            override fun onPressed() {
+                controller.onRightJoystickPressed()
+            }
+
+            override fun onReleased() {
+                controller.onRightJoystickReleased()
+            }
+        }
+    }
 
     // 连接状态对话框
     ConnectionDialog(
@@ -126,16 +167,27 @@ fun MainControlScreen(
                     color = MaterialTheme.colorScheme.onBackground
                 )
             }
+            // 多台机器人时显示操控对象切换
+            if (robots.size > 1) {
+                RobotSelector(
+                    robots = robots,
+                    activeRobotId = activeRobotId,
+                    connectionStates = { settingsState.robotConnectionStates },
+                    onRobotSelected = { controller.switchRobot(it) }
+                )
+            }
+
             // 顶部状态栏
             TopStatusBar(
-                batteryLevel = batteryLevel,
+                batteryLevel = { settingsState.batteryLevel },
                 connectionState = connectionState,
-                mode = controlMode,
+                linkStats = { settingsState.linkStats },
+                mode = { settingsState.robotMode },
                 gamepadInputState = gamepadInputState,
                 onVideoClick = onVideoClick,
                 onConnectClick = {
                     when (connectionState) {
-                        ConnectionState.CONNECTED -> {
+                        ConnectionState.CONNECTED, ConnectionState.RECONNECTING -> {
                             controller.disconnect()
                         }
 
@@ -158,15 +210,32 @@ fun MainControlScreen(
 
             // 模式选择按钮组
             ModeSelectionRow(
-                currentCtrlMode = currentMode,
-                isRobotModeChanging = isRobotModeChanging,
+                currentCtrlMode = { settingsState.robotCtrlMode },
+                isRobotModeChanging = { settingsState.isRobotCtrlModeChanging },
                 isConnected = connectionState == ConnectionState.CONNECTED,
                 onCtrlModeSelected = { mode ->
                     controller.setControlMode(mode)
                 }
             )
 
-            Spacer(modifier = Modifier.weight(1f))
+            // 轨迹小地图，位于模式按钮和摇杆之间的空白区域
+            Box(
+                modifier = Modifier
+                    .weight(1f)
+                    .fillMaxWidth()
+            ) {
+                if (connectionState == ConnectionState.CONNECTED) {
+                    // 切换机器人后使用新会话的里程计缓冲区
+                    key(activeRobotId) {
+                        TrajectoryOverlay(
+                            odometryBuffer = controller.odometryBuffer,
+                            modifier = Modifier
+                                .align(Alignment.Center)
+                                .size(140.dp)
+                        )
+                    }
+                }
+            }
 
             // 主控制区域
             Row(
@@ -178,25 +247,14 @@ fun MainControlScreen(
             ) {
                 // 左侧摇杆区域 - 用于移动控制 (vx, vy)
                 SquareVirtualJoystick(
+                    modifier = Modifier.testTag(LEFT_JOYSTICK_TAG),
                     size = 200.dp,
-                    enhancedCallback = object : EnhancedJoystickCallback {
-                        override fun onValueChanged(value: JoystickValue) {
-                            controller.updateLeftJoystick(value)
-                        }
-
-                        override fun onPressed() {
-                            controller.onLeftJoystickPressed()
-                        }
-
-                        override fun onReleased() {
-                            controller.onLeftJoystickReleased()
-                        }
-                    }
+                    enhancedCallback = leftJoystickCallback
                 )
 
                 // 中间速度档位选择按钮
                 SpeedLevelSelector(
-                    currentLevel = speedLevel,
+                    currentLevel = { settingsState.settings.speedLevel },
                     onLevelSelected = { level ->
                         controller.setSpeedLevel(level)
                     }
@@ -204,35 +262,69 @@ fun MainControlScreen(
 
                 // 右侧线性摇杆 - 用于转向控制 (yawRate)
                 LinearVirtualJoystick(
+                    modifier = Modifier.testTag(RIGHT_JOYSTICK_TAG),
                     width = 200.dp,
                     height = 60.dp,
-                    enhancedCallback = object : EnhancedJoystickCallback {
-                        override fun onValueChanged(value: JoystickValue) {
-                            controller.updateRightJoystick(value)
-                        }
-
-                        override fun onPressed() {
-                            controller.onRightJoystickPressed()
-                        }
-
-                        override fun onReleased() {
-                            controller.onRightJoystickReleased()
-                        }
-                    }
+                    enhancedCallback = rightJoystickCallback
                 )
             }
         }
     }
 }
 
+/**
+ * 操控对象切换，每台机器人一个选项，圆点表示该机器人会话的连接状态
+ */
+@OptIn(ExperimentalMaterial3Api::class)
+@Composable
+private fun RobotSelector(
+    robots: List<RobotProfile>,
+    activeRobotId: String,
+    connectionStates: () -> Map<String, ConnectionState>,
+    onRobotSelected: (String) -> Unit
+) {
+    val states = connectionStates()
+    Row(
+        modifier = Modifier
+            .fillMaxWidth()
+            .padding(vertical = 4.dp),
+        horizontalArrangement = Arrangement.spacedBy(8.dp, Alignment.CenterHorizontally),
+        verticalAlignment = Alignment.CenterVertically
+    ) {
+        robots.forEach { robot ->
+            val state = states[robot.id] ?: ConnectionState.DISCONNECTED
+            FilterChip(
+                selected = robot.id == activeRobotId,
+                onClick = { onRobotSelected(robot.id) },
+                label = { Text(robot.name, fontSize = 14.sp) },
+                leadingIcon = {
+                    Box(
+                        modifier = Modifier
+                            .size(8.dp)
+                            .background(
+                                color = when (state) {
+                                    ConnectionState.CONNECTED -> Color(0xFF4CAF50)
+                                    ConnectionState.CONNECTING, ConnectionState.RECONNECTING -> Color(0xFFFF9800)
+                                    else -> MaterialTheme.colorScheme.outline
+                                },
+                                shape = RoundedCornerShape(4.dp)
+                            )
+                    )
+                }
+            )
+        }
+    }
+}
+
 /**
  * 顶部状态栏
  */
 @Composable
 private fun TopStatusBar(
-    batteryLevel: Int,
+    batteryLevel: () -> Int,
     connectionState: ConnectionState,
-    mode: Mode,
+    linkStats: () -> LinkStatsSnapshot,
+    mode: () -> Mode,
     gamepadInputState: GamepadInputState?,
     onVideoClick: () -> Unit,
     onConnectClick: () -> Unit,
@@ -252,6 +344,11 @@ private fun TopStatusBar(
             // 电量显示
             BatteryIndicator(batteryLevel = batteryLevel)
 
+            // 链路质量显示
+            if (connectionState == ConnectionState.CONNECTED) {
+                LinkQualityIndicator(linkStats = linkStats)
+            }
+
             // 游戏手柄状态显示
             if (gamepadInputState != null) {
                 GamepadStatusIndicator(
@@ -279,7 +376,7 @@ private fun TopStatusBar(
                 colors = ButtonDefaults.buttonColors(
                     containerColor = when (connectionState) {
                         ConnectionState.CONNECTED -> MaterialTheme.colorScheme.error
-                        ConnectionState.CONNECTING -> MaterialTheme.colorScheme.tertiary
+                        ConnectionState.CONNECTING, ConnectionState.RECONNECTING -> MaterialTheme.colorScheme.tertiary
                         else -> MaterialTheme.colorScheme.primary
                     }
                 ),
@@ -288,7 +385,7 @@ private fun TopStatusBar(
                 Icon(
                     imageVector = when (connectionState) {
                         ConnectionState.CONNECTED -> Icons.Default.LinkOff
-                        ConnectionState.CONNECTING -> Icons.Default.Sync
+                        ConnectionState.CONNECTING, ConnectionState.RECONNECTING -> Icons.Default.Sync
                         ConnectionState.CONNECTION_FAILED, ConnectionState.CONNECTION_TIMEOUT -> Icons.Default.Refresh
                         else -> Icons.Default.Link
                     },
@@ -300,6 +397,7 @@ private fun TopStatusBar(
                     text = when (connectionState) {
                         ConnectionState.CONNECTED -> "断开"
                         ConnectionState.CONNECTING -> "连接中..."
+                        ConnectionState.RECONNECTING -> "重连中..."
                         ConnectionState.CONNECTION_FAILED -> "重试"
                         ConnectionState.CONNECTION_TIMEOUT -> "重试"
                         else -> "连接"
@@ -321,10 +419,11 @@ private fun TopStatusBar(
 }
 
 /**
- * 电量指示器
+ * 电量指示器，延迟读取电量使重组只发生在本组件内
  */
 @Composable
-private fun BatteryIndicator(batteryLevel: Int) {
+private fun BatteryIndicator(batteryLevel: () -> Int) {
+    val level = batteryLevel()
     // 电池图标与百分比显示
     Row(
         verticalAlignment = Alignment.CenterVertically,
@@ -332,48 +431,88 @@ private fun BatteryIndicator(batteryLevel: Int) {
     ) {
         Icon(
             imageVector = when {
-                batteryLevel > 90 -> Icons.Default.BatteryFull
-                batteryLevel > 60 -> Icons.Default.Battery6Bar
-                batteryLevel > 50 -> Icons.Default.Battery5Bar
-                batteryLevel > 30 -> Icons.Default.Battery4Bar
-                batteryLevel > 20 -> Icons.Default.Battery2Bar
-                batteryLevel > 10 -> Icons.Default.Battery1Bar
+                level > 90 -> Icons.Default.BatteryFull
+                level > 60 -> Icons.Default.Battery6Bar
+                level > 50 -> Icons.Default.Battery5Bar
+                level > 30 -> Icons.Default.Battery4Bar
+                level > 20 -> Icons.Default.Battery2Bar
+                level > 10 -> Icons.Default.Battery1Bar
                 else -> Icons.Default.Battery0Bar
             },
             contentDescription = "电池电量",
             tint = when {
-                batteryLevel > 50 -> Color(0xFF4CAF50)
-                batteryLevel > 20 -> Color(0xFFFF9800)
+                level > 50 -> Color(0xFF4CAF50)
+                level > 20 -> Color(0xFFFF9800)
                 else -> Color(0xFFF44336)
             },
             modifier = Modifier.size(20.dp)
         )
 
         Text(
-            text = "$batteryLevel%",
+            text = "$level%",
             fontSize = 12.sp,
             fontWeight = FontWeight.Medium,
             color = when {
-                batteryLevel > 50 -> Color(0xFF4CAF50)
-                batteryLevel > 20 -> Color(0xFFFF9800)
+                level > 50 -> Color(0xFF4CAF50)
+                level > 20 -> Color(0xFFFF9800)
                 else -> Color(0xFFF44336)
             }
         )
     }
 }
 
+/**
+ * 链路质量指示器，显示往返时延百分位和丢包率
+ * 统计每个心跳周期更新一次，延迟读取使重组只发生在本组件内
+ */
+@Composable
+private fun LinkQualityIndicator(linkStats: () -> LinkStatsSnapshot) {
+    val stats = linkStats()
+    // 对端不支持心跳回显时没有往返时延数据
+    if (!stats.hasRtt) return
+
+    val color = when {
+        stats.rttP95Us > 100_000 || stats.lossRate > 0.05f -> Color(0xFFF44336)
+        stats.rttP95Us > 30_000 || stats.lossRate > 0.01f -> Color(0xFFFF9800)
+        else -> Color(0xFF4CAF50)
+    }
+
+    Row(
+        verticalAlignment = Alignment.CenterVertically,
+        horizontalArrangement = Arrangement.spacedBy(4.dp)
+    ) {
+        Icon(
+            imageVector = Icons.Default.NetworkCheck,
+            contentDescription = "链路质量",
+            tint = color,
+            modifier = Modifier.size(20.dp)
+        )
+
+        Text(
+            text = "RTT ${formatMs(stats.rttP50Us)}/${formatMs(stats.rttP95Us)}/${formatMs(stats.rttP99Us)}ms " +
+                    "丢包${"%.1f".format(stats.lossRate * 100)}%",
+            fontSize = 12.sp,
+            fontWeight = FontWeight.Medium,
+            color = color
+        )
+    }
+}
+
+private fun formatMs(us: Long): String = "%.1f".format(us / 1000.0)
+
 /**
  * 控制模式切换按钮
  */
 @Composable
 private fun ControlModeToggle(
-    currentMode: Mode,
+    currentMode: () -> Mode,
     isConnected: Boolean,
     onModeClick: (Mode) -> Unit
 ) {
+    val mode = currentMode()
     Button(
         onClick = {
-            val newMode = if (currentMode == Mode.MODE_MANUAL) {
+            val newMode = if (mode == Mode.MODE_MANUAL) {
                 Mode.MODE_AUTO
             } else {
                 Mode.MODE_MANUAL
@@ -382,7 +521,7 @@ private fun ControlModeToggle(
         },
         enabled = isConnected,
         colors = ButtonDefaults.buttonColors(
-            containerColor = if (currentMode == Mode.MODE_AUTO) {
+            containerColor = if (mode == Mode.MODE_AUTO) {
                 MaterialTheme.colorScheme.secondary
             } else {
                 MaterialTheme.colorScheme.primary
@@ -390,13 +529,13 @@ private fun ControlModeToggle(
         )
     ) {
         Icon(
-            imageVector = if (currentMode == Mode.MODE_AUTO) Icons.Default.AutoMode else Icons.Default.ControlCamera,
+            imageVector = if (mode == Mode.MODE_AUTO) Icons.Default.AutoMode else Icons.Default.ControlCamera,
             contentDescription = null,
             modifier = Modifier.size(16.dp)
         )
         Spacer(modifier = Modifier.width(4.dp))
         Text(
-            text = currentMode.displayName,
+            text = mode.displayName,
             fontSize = 12.sp
         )
     }
@@ -407,11 +546,13 @@ private fun ControlModeToggle(
  */
 @Composable
 private fun ModeSelectionRow(
-    currentCtrlMode: ControlMode,
-    isRobotModeChanging: Boolean,
+    currentCtrlMode: () -> ControlMode,
+    isRobotModeChanging: () -> Boolean,
     isConnected: Boolean,
     onCtrlModeSelected: (ControlMode) -> Unit
 ) {
+    val selectedMode = currentCtrlMode()
+    val changing = isRobotModeChanging()
     Row(
         modifier = Modifier.fillMaxWidth(),
         horizontalArrangement = Arrangement.SpaceEvenly
@@ -421,9 +562,9 @@ private fun ModeSelectionRow(
             .forEach { mode ->
                 ModeButton(
                     mode = mode,
-                    isSelected = currentCtrlMode == mode,
-                    isEnabled = isConnected && !isRobotModeChanging,
-                    isChanging = isRobotModeChanging && currentCtrlMode != mode,
+                    isSelected = selectedMode == mode,
+                    isEnabled = isConnected && !changing,
+                    isChanging = changing && selectedMode != mode,
                     onClick = { onCtrlModeSelected(mode) }
                 )
             }
@@ -507,9 +648,10 @@ private fun ModeButton(
  */
 @Composable
 private fun SpeedLevelSelector(
-    currentLevel: SpeedLevel,
+    currentLevel: () -> SpeedLevel,
     onLevelSelected: (SpeedLevel) -> Unit
 ) {
+    val selectedLevel = currentLevel()
     Column(
         horizontalAlignment = Alignment.CenterHorizontally,
         verticalArrangement = Arrangement.spacedBy(4.dp)
@@ -527,7 +669,7 @@ private fun SpeedLevelSelector(
             SpeedLevel.entries.forEach { level ->
                 SpeedLevelButton(
                     level = level,
-                    isSelected = currentLevel == level,
+                    isSelected = selectedLevel == level,
                     onClick = { onLevelSelected(level) }
                 )
             }
@@ -594,6 +736,8 @@ fun MainControlScreenPreview() {
     // 预览时使用假的Controller实现
     val dummyController = remember {
         object : Controller {
+            override val inputSnapshot = ControlInputSnapshot()
+            override val odometryBuffer = OdometryBuffer()
             override fun connect() {}
             override fun disconnect() {}
             override fun cancelConnection() {}
@@ -611,6 +755,10 @@ fun MainControlScreenPreview() {
             override fun saveSettings(settings: com.helywin.leggedjoystick.data.AppSettings) {}
             override fun isConnected() = false
             override fun cleanup() {}
+            override fun samplePerf() = PerfSnapshot(System.nanoTime())
+            override fun replayLastSession(speed: Double) {}
+            override fun stopReplay() {}
+            override fun switchRobot(robotId: String) {}
         }
     }
 
@@ -38,17 +38,27 @@ import androidx.compose.ui.unit.sp
 import coil.compose.rememberAsyncImagePainter
 import com.helywin.leggedjoystick.BuildConfig
 import com.helywin.leggedjoystick.data.AppSettings
+import com.helywin.leggedjoystick.data.ControlRate
+import com.helywin.leggedjoystick.data.RobotProfile
+import com.helywin.leggedjoystick.data.VideoProfile
 import timber.log.Timber
+import java.util.UUID
 
 /**
  * 设置页面
+ * @param isReplaying 是否正在回放黑匣子记录
+ * @param onReplayClick 回放最近一次记录，参数为倍速
+ * @param onStopReplayClick 停止回放
  */
 @OptIn(ExperimentalMaterial3Api::class)
 @Composable
 fun SettingsScreen(
     currentSettings: AppSettings,
     onSettingsChange: (AppSettings) -> Unit,
-    onBackClick: () -> Unit
+    onBackClick: () -> Unit,
+    isReplaying: Boolean = false,
+    onReplayClick: (Double) -> Unit = {},
+    onStopReplayClick: () -> Unit = {}
 ) {
     var zmqIp by remember { mutableStateOf(currentSettings.zmqIp) }
     var zmqPort by remember { mutableStateOf(currentSettings.zmqPort.toString()) }
@@ -56,6 +66,17 @@ fun SettingsScreen(
     var mainTitle by remember { mutableStateOf(currentSettings.mainTitle) }
     var logoPath by remember { mutableStateOf(currentSettings.logoPath) }
     var keepScreenOn by remember { mutableStateOf(currentSettings.keepScreenOn) }
+    var showPerfHud by remember { mutableStateOf(currentSettings.showPerfHud) }
+    var flightRecorder by remember { mutableStateOf(currentSettings.flightRecorder) }
+    var controlRate by remember { mutableStateOf(currentSettings.controlRate) }
+    var videoProfile by remember { mutableStateOf(currentSettings.videoProfile) }
+    var autoReconnect by remember { mutableStateOf(currentSettings.autoReconnect) }
+    var autoConnect by remember { mutableStateOf(currentSettings.autoConnect) }
+    var splitTelemetry by remember { mutableStateOf(currentSettings.splitTelemetry) }
+    var telemetryPort by remember { mutableStateOf(currentSettings.telemetryPort.toString()) }
+    val extraRobots = remember {
+        mutableStateListOf<RobotDraft>().apply { addAll(currentSettings.extraRobots.map(::RobotDraft)) }
+    }
     val context = LocalContext.current
 
     // 图片选择器
@@ -149,6 +170,133 @@ fun SettingsScreen(
                         keyboardOptions = KeyboardOptions(keyboardType = KeyboardType.Number),
                         singleLine = true
                     )
+
+                    // 控制频率选择
+                    Column {
+                        Text(
+                            text = "速度指令频率",
+                            fontSize = 16.sp,
+                            fontWeight = FontWeight.Medium
+                        )
+                        Text(
+                            text = "频率越高操控越跟手，网络和机器人端负载也越高",
+                            fontSize = 12.sp,
+                            color = MaterialTheme.colorScheme.onSurfaceVariant
+                        )
+                    }
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        horizontalArrangement = Arrangement.spacedBy(8.dp)
+                    ) {
+                        ControlRate.entries.forEach { rate ->
+                            FilterChip(
+                                selected = controlRate == rate,
+                                onClick = { controlRate = rate },
+                                label = { Text(rate.displayName) }
+                            )
+                        }
+                    }
+
+                    // 自动重连开关
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        horizontalArrangement = Arrangement.SpaceBetween,
+                        verticalAlignment = Alignment.CenterVertically
+                    ) {
+                        Column(
+                            modifier = Modifier.weight(1f)
+                        ) {
+                            Text(
+                                text = "自动重连",
+                                fontSize = 16.sp,
+                                fontWeight = FontWeight.Medium
+                            )
+                            Text(
+                                text = "链路中断后保持会话并自动重新连接，恢复后同步机器人状态",
+                                fontSize = 12.sp,
+                                color = MaterialTheme.colorScheme.onSurfaceVariant
+                            )
+                        }
+                        Switch(
+                            checked = autoReconnect,
+                            onCheckedChange = { autoReconnect = it }
+                        )
+                    }
+
+                    // 启动时自动连接开关
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        horizontalArrangement = Arrangement.SpaceBetween,
+                        verticalAlignment = Alignment.CenterVertically
+                    ) {
+                        Column(
+                            modifier = Modifier.weight(1f)
+                        ) {
+                            Text(
+                                text = "启动时自动连接",
+                                fontSize = 16.sp,
+                                fontWeight = FontWeight.Medium
+                            )
+                            Text(
+                                text = "应用启动后立即用上次保存的地址连接机器人",
+                                fontSize = 12.sp,
+                                color = MaterialTheme.colorScheme.onSurfaceVariant
+                            )
+                        }
+                        Switch(
+                            checked = autoConnect,
+                            onCheckedChange = { autoConnect = it }
+                        )
+                    }
+
+                    // 独立遥测通道
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        horizontalArrangement = Arrangement.SpaceBetween,
+                        verticalAlignment = Alignment.CenterVertically
+                    ) {
+                        Column(
+                            modifier = Modifier.weight(1f)
+                        ) {
+                            Text(
+                                text = "独立遥测通道",
+                                fontSize = 16.sp,
+                                fontWeight = FontWeight.Medium
+                            )
+                            Text(
+                                text = "里程计和电量通过单独的订阅端口接收，只处理最新样本，需要机器人端支持",
+                                fontSize = 12.sp,
+                                color = MaterialTheme.colorScheme.onSurfaceVariant
+                            )
+                        }
+                        Switch(
+                            checked = splitTelemetry,
+                            onCheckedChange = { splitTelemetry = it }
+                        )
+                    }
+
+                    if (splitTelemetry) {
+                        OutlinedTextField(
+                            value = telemetryPort,
+                            onValueChange = { value ->
+                                // 只允许数字输入
+                                if (value.all { it.isDigit() } && value.length <= 5) {
+                                    telemetryPort = value
+                                }
+                            },
+                            label = { Text("遥测端口") },
+                            placeholder = { Text("33446") },
+                            leadingIcon = {
+                                Icon(
+                                    imageVector = Icons.Default.Settings,
+                                    contentDescription = "遥测端口"
+                                )
+                            },
+                            modifier = Modifier.fillMaxWidth(),
+                            keyboardOptions = KeyboardOptions(keyboardType = KeyboardType.Number),
+                            singleLine = true
+                        )
+                    }
                 }
             }
 
@@ -182,6 +330,32 @@ fun SettingsScreen(
                         modifier = Modifier.fillMaxWidth(),
                         singleLine = true
                     )
+
+                    // 播放配置选择
+                    Column {
+                        Text(
+                            text = "视频播放配置",
+                            fontSize = 16.sp,
+                            fontWeight = FontWeight.Medium
+                        )
+                        Text(
+                            text = "低延迟配置减少缓冲并丢弃迟到帧，网络较差时画面可能卡顿",
+                            fontSize = 12.sp,
+                            color = MaterialTheme.colorScheme.onSurfaceVariant
+                        )
+                    }
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        horizontalArrangement = Arrangement.spacedBy(8.dp)
+                    ) {
+                        VideoProfile.entries.forEach { profile ->
+                            FilterChip(
+                                selected = videoProfile == profile,
+                                onClick = { videoProfile = profile },
+                                label = { Text(profile.displayName) }
+                            )
+                        }
+                    }
                 }
             }
 
@@ -225,6 +399,75 @@ fun SettingsScreen(
                             onCheckedChange = { keepScreenOn = it }
                         )
                     }
+
+                    // 性能浮层开关
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        horizontalArrangement = Arrangement.SpaceBetween,
+                        verticalAlignment = Alignment.CenterVertically
+                    ) {
+                        Column(
+                            modifier = Modifier.weight(1f)
+                        ) {
+                            Text(
+                                text = "性能浮层",
+                                fontSize = 16.sp,
+                                fontWeight = FontWeight.Medium
+                            )
+                            Text(
+                                text = "显示控制频率、网络、视频和内存回收指标，手柄 SELECT 键也可切换",
+                                fontSize = 12.sp,
+                                color = MaterialTheme.colorScheme.onSurfaceVariant
+                            )
+                        }
+                        Switch(
+                            checked = showPerfHud,
+                            onCheckedChange = { showPerfHud = it }
+                        )
+                    }
+
+                    // 黑匣子记录开关
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        horizontalArrangement = Arrangement.SpaceBetween,
+                        verticalAlignment = Alignment.CenterVertically
+                    ) {
+                        Column(
+                            modifier = Modifier.weight(1f)
+                        ) {
+                            Text(
+                                text = "黑匣子记录",
+                                fontSize = 16.sp,
+                                fontWeight = FontWeight.Medium
+                            )
+                            Text(
+                                text = "记录每次连接收发的全部消息，滚动保留约64MB，未连接时可回放最近一次记录",
+                                fontSize = 12.sp,
+                                color = MaterialTheme.colorScheme.onSurfaceVariant
+                            )
+                        }
+                        Switch(
+                            checked = flightRecorder,
+                            onCheckedChange = { flightRecorder = it }
+                        )
+                    }
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        horizontalArrangement = Arrangement.spacedBy(8.dp)
+                    ) {
+                        if (isReplaying) {
+                            OutlinedButton(onClick = onStopReplayClick) {
+                                Text("停止回放")
+                            }
+                        } else {
+                            OutlinedButton(onClick = { onReplayClick(1.0) }) {
+                                Text("原速回放")
+                            }
+                            OutlinedButton(onClick = { onReplayClick(4.0) }) {
+                                Text("4倍速回放")
+                            }
+                        }
+                    }
                 }
             }
 
@@ -345,20 +588,85 @@ fun SettingsScreen(
                 }
             }
 
+            // 其他机器人
+            Card(
+                modifier = Modifier.fillMaxWidth(),
+                elevation = CardDefaults.cardElevation(defaultElevation = 4.dp)
+            ) {
+                Column(
+                    modifier = Modifier.padding(16.dp),
+                    verticalArrangement = Arrangement.spacedBy(12.dp)
+                ) {
+                    Text(
+                        text = "其他机器人",
+                        fontSize = 18.sp,
+                        fontWeight = FontWeight.Medium
+                    )
+                    Text(
+                        text = "连接后所有机器人同时保持会话，在控制界面切换操控对象，后台机器人只保持心跳",
+                        fontSize = 12.sp,
+                        color = MaterialTheme.colorScheme.onSurfaceVariant
+                    )
+
+                    extraRobots.forEachIndexed { index, robot ->
+                        RobotDraftEditor(
+                            draft = robot,
+                            onChange = { extraRobots[index] = it },
+                            onDelete = { extraRobots.removeAt(index) }
+                        )
+                    }
+
+                    OutlinedButton(
+                        onClick = {
+                            extraRobots.add(
+                                RobotDraft(
+                                    id = UUID.randomUUID().toString(),
+                                    name = "机器人${extraRobots.size + 2}",
+                                    zmqIp = "",
+                                    zmqPort = zmqPort,
+                                    rtspUrl = ""
+                                )
+                            )
+                        },
+                        modifier = Modifier.fillMaxWidth()
+                    ) {
+                        Icon(
+                            imageVector = Icons.Default.Add,
+                            contentDescription = null,
+                            modifier = Modifier.size(16.dp)
+                        )
+                        Spacer(modifier = Modifier.width(8.dp))
+                        Text("添加机器人")
+                    }
+                }
+            }
+
             // 保存按钮
             Button(
                 onClick = {
                     val port = zmqPort.toIntOrNull() ?: currentSettings.zmqPort
+                    val telemetryPortValue = telemetryPort.toIntOrNull() ?: currentSettings.telemetryPort
+                    // 未填写IP的机器人视为未完成，不保存
+                    val robots = extraRobots.filter { it.zmqIp.isNotBlank() }.map { it.toProfile(port) }
                     val newSettings = currentSettings.copy(
                         zmqIp = zmqIp.trim(),
                         zmqPort = port,
                         rtspUrl = rtspUrl.trim(),
                         mainTitle = mainTitle.trim(),
                         logoPath = logoPath,
-                        keepScreenOn = keepScreenOn
+                        keepScreenOn = keepScreenOn,
+                        showPerfHud = showPerfHud,
+                        flightRecorder = flightRecorder,
+                        controlRate = controlRate,
+                        videoProfile = videoProfile,
+                        autoReconnect = autoReconnect,
+                        autoConnect = autoConnect,
+                        splitTelemetry = splitTelemetry,
+                        telemetryPort = telemetryPortValue,
+                        extraRobots = robots
                     )
                     onSettingsChange(newSettings)
-                    Timber.i("设置已保存: IP=$zmqIp, Port=$port, RTSP=$rtspUrl, Title=$mainTitle, Logo=$logoPath, KeepScreenOn=$keepScreenOn")
+                    Timber.i("设置已保存: IP=$zmqIp, Port=$port, RTSP=$rtspUrl, Title=$mainTitle, Logo=$logoPath, KeepScreenOn=$keepScreenOn, ControlRate=${controlRate.displayName}, VideoProfile=${videoProfile.displayName}, AutoReconnect=$autoReconnect, AutoConnect=$autoConnect, SplitTelemetry=$splitTelemetry, TelemetryPort=$telemetryPortValue, PerfHud=$showPerfHud, FlightRecorder=$flightRecorder, ExtraRobots=${robots.size}")
                     Toast.makeText(
                         context,
                         "设置已保存",
@@ -423,3 +731,90 @@ fun SettingsScreen(
         }
     }
 }
+
+/**
+ * 机器人配置的编辑状态，端口保留输入的原始文本
+ */
+private data class RobotDraft(
+    val id: String,
+    val name: String,
+    val zmqIp: String,
+    val zmqPort: String,
+    val rtspUrl: String
+) {
+    constructor(profile: RobotProfile) : this(
+        profile.id, profile.name, profile.zmqIp, profile.zmqPort.toString(), profile.rtspUrl
+    )
+
+    fun toProfile(defaultPort: Int) = RobotProfile(
+        id = id,
+        name = name.trim().ifEmpty { zmqIp.trim() },
+        zmqIp = zmqIp.trim(),
+        zmqPort = zmqPort.toIntOrNull() ?: defaultPort,
+        rtspUrl = rtspUrl.trim()
+    )
+}
+
+/**
+ * 单个机器人的配置编辑行
+ */
+@Composable
+private fun RobotDraftEditor(
+    draft: RobotDraft,
+    onChange: (RobotDraft) -> Unit,
+    onDelete: () -> Unit
+) {
+    OutlinedCard(modifier = Modifier.fillMaxWidth()) {
+        Column(
+            modifier = Modifier.padding(12.dp),
+            verticalArrangement = Arrangement.spacedBy(8.dp)
+        ) {
+            Row(
+                modifier = Modifier.fillMaxWidth(),
+                verticalAlignment = Alignment.CenterVertically
+            ) {
+                OutlinedTextField(
+                    value = draft.name,
+                    onValueChange = { onChange(draft.copy(name = it)) },
+                    label = { Text("名称") },
+                    modifier = Modifier.weight(1f),
+                    singleLine = true
+                )
+                IconButton(onClick = onDelete) {
+                    Icon(Icons.Default.Delete, contentDescription = "删除机器人")
+                }
+            }
+            Row(
+                modifier = Modifier.fillMaxWidth(),
+                horizontalArrangement = Arrangement.spacedBy(8.dp)
+            ) {
+                OutlinedTextField(
+                    value = draft.zmqIp,
+                    onValueChange = { onChange(draft.copy(zmqIp = it)) },
+                    label = { Text("IP地址") },
+                    modifier = Modifier.weight(2f),
+                    singleLine = true
+                )
+                OutlinedTextField(
+                    value = draft.zmqPort,
+                    onValueChange = { value ->
+                        if (value.all { it.isDigit() } && value.length <= 5) {
+                            onChange(draft.copy(zmqPort = value))
+                        }
+                    },
+                    label = { Text("端口") },
+                    modifier = Modifier.weight(1f),
+                    keyboardOptions = KeyboardOptions(keyboardType = KeyboardType.Number),
+                    singleLine = true
+                )
+            }
+            OutlinedTextField(
+                value = draft.rtspUrl,
+                onValueChange = { onChange(draft.copy(rtspUrl = it)) },
+                label = { Text("RTSP 地址") },
+                modifier = Modifier.fillMaxWidth(),
+                singleLine = true
+            )
+        }
+    }
+}
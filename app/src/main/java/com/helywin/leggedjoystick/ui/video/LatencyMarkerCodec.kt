@@ -0,0 +1,107 @@
+/*********************************************************************************
+ * FileName: LatencyMarkerCodec.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 视频帧顶部时间戳条纹的编解码，用于端到端（glass-to-glass）延迟测量
+ * Others: 服务器在采集时把墙上时钟毫秒数画到画面最上方 1/40 高度的条纹中：
+ *         条纹横向等分为52格，白色为1、黑色为0
+ *         [0]白 [1]黑 | [2..41] 时间戳低40位（高位在前） | [42..49] 5个字节的异或校验 | [50]黑 [51]白
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.ui.video
+
+/**
+ * 时间戳条纹编解码，像素为ARGB格式
+ */
+object LatencyMarkerCodec {
+    const val CELL_COUNT = 52
+    const val TIMESTAMP_BITS = 40
+    const val TIMESTAMP_MASK = (1L shl TIMESTAMP_BITS) - 1
+
+    // 条纹高度占画面高度的比例
+    const val STRIP_HEIGHT_DIVISOR = 40
+
+    private const val DATA_START = 2
+    private const val CHECKSUM_START = DATA_START + TIMESTAMP_BITS
+    private const val CHECKSUM_BITS = 8
+    private const val MIN_CONTRAST = 64 // 同步格的最小亮度差，低于此值认为画面中没有条纹
+
+    private const val WHITE = 0xFFFFFFFF.toInt()
+    private const val BLACK = 0xFF000000.toInt()
+
+    /**
+     * 把时间戳编码成一行像素（服务器端实现参考及测试使用）
+     */
+    fun encodeRow(timestampMs: Long, width: Int): IntArray {
+        val cells = BooleanArray(CELL_COUNT)
+        cells[0] = true
+        cells[CELL_COUNT - 1] = true
+        val value = timestampMs and TIMESTAMP_MASK
+        for (i in 0 until TIMESTAMP_BITS) {
+            cells[DATA_START + i] = (value ushr (TIMESTAMP_BITS - 1 - i)) and 1L == 1L
+        }
+        val checksum = checksum(value)
+        for (i in 0 until CHECKSUM_BITS) {
+            cells[CHECKSUM_START + i] = (checksum ushr (CHECKSUM_BITS - 1 - i)) and 1 == 1
+        }
+        return IntArray(width) { x -> if (cells[x * CELL_COUNT / width]) WHITE else BLACK }
+    }
+
+    /**
+     * 从一行像素中解码时间戳低40位
+     * @return 时间戳低40位，没有有效条纹时返回 -1
+     */
+    fun decodeRow(pixels: IntArray, width: Int): Long {
+        if (width < CELL_COUNT) return -1
+
+        val white = luminance(sampleCell(pixels, width, 0))
+        val black = luminance(sampleCell(pixels, width, 1))
+        if (white - black < MIN_CONTRAST) return -1
+        val threshold = (white + black) / 2
+
+        fun bit(cell: Int) = luminance(sampleCell(pixels, width, cell)) > threshold
+
+        if (bit(CELL_COUNT - 2) || !bit(CELL_COUNT - 1)) return -1
+
+        var value = 0L
+        for (i in 0 until TIMESTAMP_BITS) {
+            value = (value shl 1) or (if (bit(DATA_START + i)) 1L else 0L)
+        }
+        var checksum = 0
+        for (i in 0 until CHECKSUM_BITS) {
+            checksum = (checksum shl 1) or (if (bit(CHECKSUM_START + i)) 1 else 0)
+        }
+        return if (checksum == checksum(value)) value else -1
+    }
+
+    /**
+     * 由时间戳低40位恢复完整时间戳，取离 [referenceMs] 最近的值
+     */
+    fun expand(lowBits: Long, referenceMs: Long): Long {
+        val period = 1L shl TIMESTAMP_BITS
+        var full = (referenceMs and TIMESTAMP_MASK.inv()) or lowBits
+        if (full - referenceMs > period / 2) full -= period
+        else if (referenceMs - full > period / 2) full += period
+        return full
+    }
+
+    private fun checksum(value: Long): Int {
+        var result = 0
+        for (i in 0 until TIMESTAMP_BITS / 8) {
+            result = result xor ((value ushr (i * 8)) and 0xFF).toInt()
+        }
+        return result
+    }
+
+    // 取格子中心的像素
+    private fun sampleCell(pixels: IntArray, width: Int, cell: Int): Int =
+        pixels[((cell * 2 + 1) * width / (CELL_COUNT * 2)).coerceIn(0, width - 1)]
+
+    private fun luminance(argb: Int): Int {
+        val r = (argb shr 16) and 0xFF
+        val g = (argb shr 8) and 0xFF
+        val b = argb and 0xFF
+        return (r * 299 + g * 587 + b * 114) / 1000
+    }
+}
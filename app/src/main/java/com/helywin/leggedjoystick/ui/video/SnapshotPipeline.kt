@@ -0,0 +1,193 @@
+/*********************************************************************************
+ * FileName: SnapshotPipeline.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 截图流水线：PixelCopy 在独立 HandlerThread 上回调，JPEG 编码和相册写入在有界队列的后台线程执行
+ * Others: 位图从池中复用，连拍时不重复分配整帧位图；队列满时丢弃本次截图而不是阻塞界面。
+ *         PixelCopy 的目标位图必须可写，不能使用 HARDWARE 位图，因此池中为 ARGB_8888 位图
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.ui.video
+
+import android.content.ContentValues
+import android.content.Context
+import android.graphics.Bitmap
+import android.os.Build
+import android.os.Environment
+import android.os.Handler
+import android.os.HandlerThread
+import android.os.Looper
+import android.provider.MediaStore
+import android.view.PixelCopy
+import android.view.SurfaceView
+import timber.log.Timber
+import java.io.File
+import java.io.FileOutputStream
+import java.text.SimpleDateFormat
+import java.util.Date
+import java.util.Locale
+import java.util.concurrent.ArrayBlockingQueue
+import java.util.concurrent.RejectedExecutionException
+import java.util.concurrent.ThreadPoolExecutor
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * 截图结果
+ */
+sealed class SnapshotResult {
+    data class Saved(val displayName: String) : SnapshotResult()
+    data class Failed(val reason: String) : SnapshotResult()
+    /** 编码队列已满，本次截图被丢弃 */
+    object Busy : SnapshotResult()
+}
+
+/**
+ * 截图流水线
+ *
+ * @param onResult 结果回调（主线程）
+ */
+class SnapshotPipeline(
+    context: Context,
+    private val onResult: (SnapshotResult) -> Unit
+) {
+    companion object {
+        private const val MAX_PENDING_ENCODES = 4
+        private const val JPEG_QUALITY = 90
+        private const val GALLERY_DIR = "LeggedJoystick"
+    }
+
+    private val appContext = context.applicationContext
+    private val mainHandler = Handler(Looper.getMainLooper())
+    private val copyThread = HandlerThread("SnapshotCopy").apply { start() }
+    private val copyHandler = Handler(copyThread.looper)
+
+    // 单个编码线程 + 有界队列，超出时拒绝
+    private val encodeExecutor = ThreadPoolExecutor(
+        1, 1, 0L, TimeUnit.MILLISECONDS,
+        ArrayBlockingQueue(MAX_PENDING_ENCODES)
+    ) { runnable -> Thread(runnable, "SnapshotEncode").apply { isDaemon = true } }
+
+    // 位图池：正在编码的位图 + 一个正在拷贝的位图
+    private val bitmapPool = ArrayBlockingQueue<Bitmap>(MAX_PENDING_ENCODES + 2)
+    private val inFlight = AtomicInteger(0)
+    private val nameFormat = SimpleDateFormat("yyyyMMdd_HHmmss_SSS", Locale.getDefault())
+
+    /**
+     * 截取当前画面，主线程调用
+     * @return 是否已提交截图请求
+     */
+    fun capture(surfaceView: SurfaceView): Boolean {
+        val width = surfaceView.width
+        val height = surfaceView.height
+        if (width <= 0 || height <= 0 || !surfaceView.holder.surface.isValid) {
+            onResult(SnapshotResult.Failed("视频画面未准备好"))
+            return false
+        }
+        if (inFlight.get() > MAX_PENDING_ENCODES) {
+            onResult(SnapshotResult.Busy)
+            return false
+        }
+
+        val bitmap = acquireBitmap(width, height)
+        inFlight.incrementAndGet()
+        try {
+            PixelCopy.request(surfaceView, bitmap, { copyResult ->
+                if (copyResult == PixelCopy.SUCCESS) {
+                    submitEncode(bitmap)
+                } else {
+                    Timber.e("[Snapshot] PixelCopy 失败: $copyResult")
+                    finish(bitmap, SnapshotResult.Failed("截图失败: $copyResult"))
+                }
+            }, copyHandler)
+        } catch (e: IllegalArgumentException) {
+            Timber.e(e, "[Snapshot] PixelCopy 请求失败")
+            finish(bitmap, SnapshotResult.Failed("无法获取视频表面"))
+            return false
+        }
+        return true
+    }
+
+    /**
+     * 释放线程和位图，已排队的编码会先完成
+     */
+    fun release() {
+        encodeExecutor.shutdown()
+        copyThread.quitSafely()
+        // 正在编码的位图完成后会被归还，这里只回收空闲的
+        while (true) {
+            (bitmapPool.poll() ?: break).recycle()
+        }
+    }
+
+    private fun acquireBitmap(width: Int, height: Int): Bitmap {
+        while (true) {
+            val pooled = bitmapPool.poll() ?: break
+            if (pooled.width == width && pooled.height == height && !pooled.isRecycled) {
+                return pooled
+            }
+            // 画面尺寸变化，旧位图不再可用
+            pooled.recycle()
+        }
+        return Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888)
+    }
+
+    private fun submitEncode(bitmap: Bitmap) {
+        try {
+            encodeExecutor.execute {
+                val result = try {
+                    SnapshotResult.Saved(writeToGallery(bitmap))
+                } catch (e: Exception) {
+                    Timber.e(e, "[Snapshot] 保存截图失败")
+                    SnapshotResult.Failed("保存截图失败")
+                }
+                finish(bitmap, result)
+            }
+        } catch (e: RejectedExecutionException) {
+            finish(bitmap, SnapshotResult.Busy)
+        }
+    }
+
+    private fun finish(bitmap: Bitmap, result: SnapshotResult) {
+        if (encodeExecutor.isShutdown || !bitmapPool.offer(bitmap)) {
+            bitmap.recycle()
+        }
+        inFlight.decrementAndGet()
+        mainHandler.post { onResult(result) }
+    }
+
+    /**
+     * JPEG 编码写入相册（编码线程）
+     */
+    private fun writeToGallery(bitmap: Bitmap): String {
+        val fileName = synchronized(nameFormat) { "snapshot_${nameFormat.format(Date())}.jpg" }
+
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) {
+            val resolver = appContext.contentResolver
+            val contentValues = ContentValues().apply {
+                put(MediaStore.Images.Media.DISPLAY_NAME, fileName)
+                put(MediaStore.Images.Media.MIME_TYPE, "image/jpeg")
+                put(MediaStore.Images.Media.RELATIVE_PATH, Environment.DIRECTORY_PICTURES + "/" + GALLERY_DIR)
+                put(MediaStore.Images.Media.IS_PENDING, 1)
+            }
+            val uri = resolver.insert(MediaStore.Images.Media.EXTERNAL_CONTENT_URI, contentValues)
+                ?: throw IllegalStateException("无法创建 MediaStore URI")
+            resolver.openOutputStream(uri)?.use { output ->
+                bitmap.compress(Bitmap.CompressFormat.JPEG, JPEG_QUALITY, output)
+            }
+            contentValues.clear()
+            contentValues.put(MediaStore.Images.Media.IS_PENDING, 0)
+            resolver.update(uri, contentValues, null, null)
+        } else {
+            @Suppress("DEPRECATION")
+            val appDir = File(Environment.getExternalStoragePublicDirectory(Environment.DIRECTORY_PICTURES), GALLERY_DIR)
+            if (!appDir.exists()) appDir.mkdirs()
+            FileOutputStream(File(appDir, fileName)).use { output ->
+                bitmap.compress(Bitmap.CompressFormat.JPEG, JPEG_QUALITY, output)
+            }
+        }
+        Timber.i("[Snapshot] 截图已保存: $fileName")
+        return fileName
+    }
+}
@@ -0,0 +1,152 @@
+/*********************************************************************************
+ * FileName: VideoLatencyProbe.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 端到端视频延迟测量，定时截取画面顶部时间戳条纹并与本机时钟比较
+ * Others: 服务器时间戳通过心跳估计的时钟偏差换算到本机时钟；
+ *         PixelCopy 截取的是 SurfaceView 的 Surface 缓冲区（解码器最新输出的一帧），不是合成后的屏幕，
+ *         结果包含网络、缓冲和解码延迟，不含 SurfaceFlinger 合成和屏幕扫描输出
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.ui.video
+
+import android.graphics.Bitmap
+import android.graphics.Rect
+import android.os.Handler
+import android.os.HandlerThread
+import android.os.Looper
+import android.view.PixelCopy
+import android.view.SurfaceView
+import com.helywin.leggedjoystick.metrics.RollingSampleWindow
+import timber.log.Timber
+import kotlin.math.abs
+
+/**
+ * 视频延迟统计
+ *
+ * @param samples 窗口内的有效样本数
+ * @param missedMarkers 未识别到时间戳条纹的累计次数
+ */
+data class VideoLatencyStats(
+    val samples: Int = 0,
+    val lastMs: Long = 0,
+    val p50Ms: Long = 0,
+    val p95Ms: Long = 0,
+    val jitterMs: Long = 0,
+    val missedMarkers: Long = 0
+)
+
+/**
+ * 视频延迟探测器，截图和解码在独立的 HandlerThread 上进行，结果回调到主线程
+ *
+ * @param surfaceProvider 当前视频 SurfaceView
+ * @param clockOffsetMs 服务器时钟相对本机时钟的偏差（服务器 - 本机）
+ * @param onStats 统计更新回调（主线程）
+ */
+class VideoLatencyProbe(
+    private val surfaceProvider: () -> SurfaceView?,
+    private val clockOffsetMs: () -> Long,
+    private val onStats: (VideoLatencyStats) -> Unit
+) {
+    companion object {
+        private const val SAMPLE_INTERVAL_MS = 200L
+        private const val LOG_INTERVAL_MS = 5000L
+        private const val WINDOW_SIZE = 50
+        private const val BITMAP_WIDTH = LatencyMarkerCodec.CELL_COUNT * 4
+        private val PERCENTILES = doubleArrayOf(50.0, 95.0)
+    }
+
+    private val mainHandler = Handler(Looper.getMainLooper())
+    private var thread: HandlerThread? = null
+    private var handler: Handler? = null
+
+    // 以下状态只在探测线程上访问
+    private val bitmap = Bitmap.createBitmap(BITMAP_WIDTH, 1, Bitmap.Config.ARGB_8888)
+    private val row = IntArray(BITMAP_WIDTH)
+    private val srcRect = Rect()
+    private val window = RollingSampleWindow(WINDOW_SIZE)
+    private val percentileOut = LongArray(PERCENTILES.size)
+    private var jitterMs = 0L
+    private var missedMarkers = 0L
+    private var lastLogTime = 0L
+
+    private val sampleRunnable = object : Runnable {
+        override fun run() {
+            requestSample()
+            handler?.postDelayed(this, SAMPLE_INTERVAL_MS)
+        }
+    }
+
+    fun start() {
+        if (thread != null) return
+        val newThread = HandlerThread("VideoLatencyProbe").apply { start() }
+        thread = newThread
+        handler = Handler(newThread.looper).apply { post(sampleRunnable) }
+        Timber.i("[VideoLatencyProbe] 开始测量端到端延迟")
+    }
+
+    fun stop() {
+        handler?.removeCallbacksAndMessages(null)
+        thread?.quitSafely()
+        thread = null
+        handler = null
+        Timber.i("[VideoLatencyProbe] 停止测量端到端延迟")
+    }
+
+    /**
+     * 从 Surface 缓冲区截取条纹中间一行，缩放到 BITMAP_WIDTH 像素宽
+     */
+    private fun requestSample() {
+        val surfaceView = surfaceProvider() ?: return
+        val probeHandler = handler ?: return
+        if (surfaceView.width < LatencyMarkerCodec.CELL_COUNT || !surfaceView.holder.surface.isValid) return
+
+        val stripHeight = maxOf(surfaceView.height / LatencyMarkerCodec.STRIP_HEIGHT_DIVISOR, 2)
+        srcRect.set(0, stripHeight / 4, surfaceView.width, stripHeight / 4 + maxOf(stripHeight / 2, 1))
+        val requestTimeMs = System.currentTimeMillis()
+
+        try {
+            PixelCopy.request(surfaceView, srcRect, bitmap, { result ->
+                if (result == PixelCopy.SUCCESS) {
+                    onSample(requestTimeMs)
+                }
+            }, probeHandler)
+        } catch (e: IllegalArgumentException) {
+            // Surface 已销毁
+            Timber.w(e, "[VideoLatencyProbe] 截取画面失败")
+        }
+    }
+
+    private fun onSample(requestTimeMs: Long) {
+        bitmap.getPixels(row, 0, BITMAP_WIDTH, 0, 0, BITMAP_WIDTH, 1)
+        val lowBits = LatencyMarkerCodec.decodeRow(row, BITMAP_WIDTH)
+        if (lowBits < 0) {
+            missedMarkers++
+        } else {
+            val offset = clockOffsetMs()
+            val serverTimeMs = LatencyMarkerCodec.expand(lowBits, requestTimeMs + offset)
+            val latencyMs = requestTimeMs - (serverTimeMs - offset)
+            val previous = window.last(latencyMs)
+            jitterMs += (abs(latencyMs - previous) - jitterMs) / 16
+            window.add(latencyMs)
+        }
+
+        window.percentiles(PERCENTILES, percentileOut)
+        val stats = VideoLatencyStats(
+            samples = window.count,
+            lastMs = window.last(),
+            p50Ms = percentileOut[0],
+            p95Ms = percentileOut[1],
+            jitterMs = jitterMs,
+            missedMarkers = missedMarkers
+        )
+        mainHandler.post { onStats(stats) }
+
+        if (requestTimeMs - lastLogTime >= LOG_INTERVAL_MS) {
+            lastLogTime = requestTimeMs
+            Timber.i("[VideoLatencyProbe] 端到端延迟 p50=${stats.p50Ms}ms p95=${stats.p95Ms}ms " +
+                    "抖动=${stats.jitterMs}ms 样本=${stats.samples} 未识别=${stats.missedMarkers} 时钟偏差=${clockOffsetMs()}ms")
+        }
+    }
+}
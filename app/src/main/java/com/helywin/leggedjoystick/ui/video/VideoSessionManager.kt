@@ -0,0 +1,414 @@
+/*********************************************************************************
+ * FileName: VideoSessionManager.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 进程级视频会话，持有唯一的 LibVLC / MediaPlayer，跨界面切换保持解码器和RTSP会话
+ * Others: 没有界面时把视频输出到离屏 ImageReader（只丢弃帧），进入视频界面只需切换输出 Surface，
+ *         不重新初始化 LibVLC，也不重新进行 RTSP DESCRIBE/SETUP；
+ *         冷启动首帧之后在后台线程预先创建 LibVLC（加载原生库和插件缓存），不阻塞首帧
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.ui.video
+
+import android.content.Context
+import android.graphics.ImageFormat
+import android.media.ImageReader
+import android.os.Handler
+import android.os.Looper
+import androidx.compose.runtime.getValue
+import androidx.compose.runtime.mutableStateOf
+import androidx.compose.runtime.setValue
+import com.helywin.leggedjoystick.data.VideoProfile
+import org.videolan.libvlc.LibVLC
+import org.videolan.libvlc.MediaPlayer
+import org.videolan.libvlc.util.VLCVideoLayout
+import timber.log.Timber
+
+/**
+ * 视频解码统计，均为当前媒体开始播放以来的累计值
+ *
+ * @param decodedFrames 已解码的视频帧数
+ * @param displayedFrames 已显示的视频帧数
+ * @param lostFrames 解码或显示阶段丢弃的视频帧数
+ */
+data class VideoStats(
+    val decodedFrames: Long,
+    val displayedFrames: Long,
+    val lostFrames: Long
+)
+
+/**
+ * 视频会话管理器，所有方法在主线程调用
+ */
+object VideoSessionManager {
+    // 离屏输出尺寸，只用于维持解码，不显示
+    private const val WARM_SINK_WIDTH = 640
+    private const val WARM_SINK_HEIGHT = 360
+    private const val WARM_SINK_MAX_IMAGES = 2
+
+    private val mainHandler = Handler(Looper.getMainLooper())
+
+    private var appContext: Context? = null
+    private var libVLC: LibVLC? = null
+    private var profile: VideoProfile? = null
+    private var rtspUrl: String? = null
+    private var useTcpFallback = false
+    private var warmSink: ImageReader? = null
+    private var attachedLayout: VLCVideoLayout? = null
+
+    // 后台预创建的 LibVLC，首次建立会话时配置一致则直接使用
+    private var prewarmedLibVLC: LibVLC? = null
+    private var prewarmedProfile: VideoProfile? = null
+    private var warming = false
+
+    // 进入后台前是否在播放，用于回到前台后恢复
+    private var suspendedWhilePlaying = false
+
+    /**
+     * 当前播放器，会话未建立时为 null
+     */
+    var mediaPlayer: MediaPlayer? = null
+        private set
+
+    // 界面状态
+    var playbackState by mutableStateOf(VideoPlaybackState.IDLE)
+        private set
+    var errorMessage by mutableStateOf<String?>(null)
+        private set
+    var hasVideoOutput by mutableStateOf(false)
+        private set
+
+    private val tcpFallbackCheck = Runnable {
+        val player = mediaPlayer ?: return@Runnable
+        if (!hasVideoOutput && !useTcpFallback) {
+            Timber.w("[VideoSession] UDP ${UDP_FALLBACK_TIMEOUT_MS}ms 内无画面，回退到 RTSP over TCP")
+            useTcpFallback = true
+            player.stop()
+            play()
+        }
+    }
+
+    /**
+     * 读取当前媒体的解码统计，未在播放时返回 null
+     */
+    fun sampleStats(): VideoStats? {
+        val player = mediaPlayer ?: return null
+        if (!player.isPlaying) return null
+        // getMedia() 会增加引用计数，用完需要释放
+        val media = player.media ?: return null
+        try {
+            val stats = media.stats ?: return null
+            return VideoStats(
+                decodedFrames = stats.decodedVideo.toLong(),
+                displayedFrames = stats.displayedPictures.toLong(),
+                lostFrames = stats.lostPictures.toLong()
+            )
+        } finally {
+            media.release()
+        }
+    }
+
+    /**
+     * 在后台线程预创建 LibVLC，已有会话或正在预创建时忽略
+     */
+    fun warmUp(context: Context, videoProfile: VideoProfile) {
+        if (appContext == null) appContext = context.applicationContext
+        val app = appContext ?: return
+        if (libVLC != null || prewarmedLibVLC != null || warming) return
+        warming = true
+        Thread({
+            val vlc = try {
+                LibVLC(app, videoProfile.libVlcOptions())
+            } catch (e: Exception) {
+                Timber.w(e, "[VideoSession] 预创建 LibVLC 失败")
+                null
+            }
+            mainHandler.post {
+                warming = false
+                if (vlc == null) return@post
+                if (libVLC != null || prewarmedLibVLC != null) {
+                    // 预创建期间会话已经按需建立
+                    vlc.release()
+                } else {
+                    prewarmedLibVLC = vlc
+                    prewarmedProfile = videoProfile
+                    Timber.d("[VideoSession] LibVLC 预创建完成，视频播放配置: ${videoProfile.displayName}")
+                }
+            }
+        }, "VlcWarmUp").apply { isDaemon = true }.start()
+    }
+
+    /**
+     * 预连接：在控制界面建立 RTSP 会话并解码到离屏输出，进入视频界面时画面立即可用
+     */
+    fun preconnect(context: Context, url: String, videoProfile: VideoProfile) {
+        ensureSession(context, url, videoProfile)
+        if (attachedLayout == null) {
+            attachWarmSink()
+        }
+        if (mediaPlayer?.isPlaying != true && playbackState != VideoPlaybackState.LOADING) {
+            play()
+        }
+    }
+
+    /**
+     * 把视频输出切换到界面上的 VLCVideoLayout，必要时建立会话
+     */
+    fun attachView(context: Context, layout: VLCVideoLayout, url: String, videoProfile: VideoProfile) {
+        ensureSession(context, url, videoProfile)
+        val player = mediaPlayer ?: return
+        if (attachedLayout === layout) return
+
+        player.detachViews()
+        releaseWarmSink()
+        player.attachViews(layout, null, false, false)
+        attachedLayout = layout
+        Timber.d("[VideoSession] 视频输出切换到界面")
+
+        if (player.isPlaying) {
+            recreateVideoOutput(player)
+        } else if (playbackState != VideoPlaybackState.LOADING) {
+            play()
+        }
+    }
+
+    /**
+     * 界面离开时调用
+     * @param keepWarm 为true时切换回离屏输出继续保持会话，否则停止播放
+     */
+    fun detachView(layout: VLCVideoLayout, keepWarm: Boolean) {
+        if (attachedLayout !== layout) return
+        val player = mediaPlayer ?: return
+        player.detachViews()
+        attachedLayout = null
+
+        if (keepWarm) {
+            attachWarmSink()
+            if (player.isPlaying) recreateVideoOutput(player)
+            Timber.d("[VideoSession] 视频输出切换到离屏，保持会话")
+        } else {
+            stop()
+        }
+    }
+
+    /**
+     * 重新建立RTSP会话（用户点重试或回到前台时调用）
+     */
+    fun restart() {
+        val player = mediaPlayer ?: return
+        player.stop()
+        useTcpFallback = false
+        play()
+    }
+
+    /**
+     * 停止播放，保留 LibVLC 实例
+     */
+    fun stop() {
+        mainHandler.removeCallbacks(tcpFallbackCheck)
+        mediaPlayer?.let { player ->
+            if (player.isPlaying || playbackState != VideoPlaybackState.IDLE) {
+                player.stop()
+            }
+        }
+        hasVideoOutput = false
+        playbackState = VideoPlaybackState.IDLE
+    }
+
+    /**
+     * 应用进入后台时停止拉流
+     */
+    fun suspend() {
+        suspendedWhilePlaying = playbackState == VideoPlaybackState.PLAYING ||
+                playbackState == VideoPlaybackState.LOADING
+        if (suspendedWhilePlaying) {
+            stop()
+            Timber.d("[VideoSession] 应用进入后台，停止拉流")
+        }
+    }
+
+    /**
+     * 应用回到前台时恢复拉流
+     */
+    fun resume() {
+        if (suspendedWhilePlaying && mediaPlayer != null) {
+            suspendedWhilePlaying = false
+            play()
+            Timber.d("[VideoSession] 应用恢复到前台，重新拉流")
+        }
+    }
+
+    /**
+     * 释放全部资源（进程退出或配置变化需要重建 LibVLC 时）
+     */
+    fun release() {
+        stop()
+        mediaPlayer?.let { player ->
+            player.setEventListener(null)
+            player.detachViews()
+            player.release()
+        }
+        mediaPlayer = null
+        releaseWarmSink()
+        attachedLayout = null
+        libVLC?.release()
+        libVLC = null
+        profile = null
+        rtspUrl = null
+        prewarmedLibVLC?.release()
+        prewarmedLibVLC = null
+        prewarmedProfile = null
+        Timber.d("[VideoSession] VLC 资源已释放")
+    }
+
+    /**
+     * 保证会话与配置一致：配置变化重建 LibVLC（实例参数只能在创建时指定），地址变化只重新拉流
+     */
+    private fun ensureSession(context: Context, url: String, videoProfile: VideoProfile) {
+        if (appContext == null) appContext = context.applicationContext
+
+        if (libVLC != null && profile != videoProfile) {
+            Timber.i("[VideoSession] 视频播放配置变更为 ${videoProfile.displayName}，重建 LibVLC")
+            val layout = attachedLayout
+            release()
+            createSession(videoProfile)
+            rtspUrl = url
+            layout?.let { attachView(context, it, url, videoProfile) }
+            return
+        }
+
+        if (libVLC == null) {
+            createSession(videoProfile)
+        }
+
+        if (rtspUrl != url) {
+            val wasActive = rtspUrl != null && playbackState != VideoPlaybackState.IDLE
+            rtspUrl = url
+            useTcpFallback = false
+            if (wasActive) {
+                mediaPlayer?.stop()
+                play()
+            }
+        }
+    }
+
+    private fun createSession(videoProfile: VideoProfile) {
+        val context = appContext ?: return
+        val prewarmed = prewarmedLibVLC
+        prewarmedLibVLC = null
+        val vlc = if (prewarmed != null && prewarmedProfile == videoProfile) {
+            Timber.i("[VideoSession] 使用预创建的 LibVLC，视频播放配置: ${videoProfile.displayName}")
+            prewarmed
+        } else {
+            prewarmed?.release()
+            Timber.i("[VideoSession] 创建 LibVLC，视频播放配置: ${videoProfile.displayName}")
+            LibVLC(context, videoProfile.libVlcOptions())
+        }
+        prewarmedProfile = null
+        libVLC = vlc
+        profile = videoProfile
+        mediaPlayer = MediaPlayer(vlc).apply {
+            setEventListener(MediaPlayer.EventListener { event -> onPlayerEvent(event) })
+        }
+    }
+
+    private fun play() {
+        val vlc = libVLC ?: return
+        val player = mediaPlayer ?: return
+        val url = rtspUrl ?: return
+        val videoProfile = profile ?: return
+
+        playbackState = VideoPlaybackState.LOADING
+        errorMessage = null
+        hasVideoOutput = false
+        try {
+            val media = videoProfile.createMedia(vlc, url, useTcpFallback)
+            player.media = media
+            media.release()
+            player.play()
+            Timber.i("[VideoSession] 开始加载 RTSP 流: $url")
+        } catch (e: Exception) {
+            playbackState = VideoPlaybackState.ERROR
+            errorMessage = e.message ?: "加载失败"
+            Timber.e(e, "[VideoSession] RTSP 流加载失败")
+            return
+        }
+
+        // UDP 被防火墙或NAT阻断时收不到数据，超时后改用TCP重新加载
+        mainHandler.removeCallbacks(tcpFallbackCheck)
+        if (videoProfile.preferUdp && !useTcpFallback) {
+            mainHandler.postDelayed(tcpFallbackCheck, UDP_FALLBACK_TIMEOUT_MS)
+        }
+    }
+
+    /**
+     * 在播放中更换输出 Surface 后，重新启用视频轨道让 VLC 在新 Surface 上创建视频输出
+     */
+    private fun recreateVideoOutput(player: MediaPlayer) {
+        player.setVideoTrackEnabled(false)
+        player.setVideoTrackEnabled(true)
+    }
+
+    private fun attachWarmSink() {
+        val player = mediaPlayer ?: return
+        if (warmSink != null) return
+        val reader = ImageReader.newInstance(
+            WARM_SINK_WIDTH, WARM_SINK_HEIGHT, ImageFormat.PRIVATE, WARM_SINK_MAX_IMAGES
+        )
+        // 只取出并丢弃帧，保证解码器不会因输出队列满而阻塞
+        reader.setOnImageAvailableListener({ it.acquireLatestImage()?.close() }, mainHandler)
+        warmSink = reader
+
+        val vout = player.vlcVout
+        vout.setVideoSurface(reader.surface, null)
+        vout.setWindowSize(WARM_SINK_WIDTH, WARM_SINK_HEIGHT)
+        vout.attachViews()
+    }
+
+    private fun releaseWarmSink() {
+        warmSink?.let { reader ->
+            mediaPlayer?.vlcVout?.let { vout ->
+                if (vout.areViewsAttached()) vout.detachViews()
+            }
+            reader.close()
+        }
+        warmSink = null
+    }
+
+    private fun onPlayerEvent(event: MediaPlayer.Event) {
+        when (event.type) {
+            MediaPlayer.Event.Opening -> {
+                playbackState = VideoPlaybackState.LOADING
+                Timber.d("[VideoSession] VLC 正在打开流")
+            }
+            MediaPlayer.Event.Buffering -> {
+                if (event.buffering >= 100f) {
+                    playbackState = VideoPlaybackState.PLAYING
+                } else if (playbackState != VideoPlaybackState.PLAYING) {
+                    playbackState = VideoPlaybackState.LOADING
+                }
+            }
+            MediaPlayer.Event.Playing -> {
+                playbackState = VideoPlaybackState.PLAYING
+                Timber.d("[VideoSession] VLC 正在播放")
+            }
+            MediaPlayer.Event.Vout -> {
+                hasVideoOutput = event.voutCount > 0
+            }
+            MediaPlayer.Event.Stopped -> {
+                playbackState = VideoPlaybackState.IDLE
+                Timber.d("[VideoSession] VLC 已停止")
+            }
+            MediaPlayer.Event.EndReached -> {
+                playbackState = VideoPlaybackState.IDLE
+                Timber.d("[VideoSession] VLC 播放结束")
+            }
+            MediaPlayer.Event.EncounteredError -> {
+                playbackState = VideoPlaybackState.ERROR
+                errorMessage = "视频流播放错误"
+                Timber.e("[VideoSession] VLC 播放错误")
+            }
+        }
+    }
+}
@@ -0,0 +1,49 @@
+/*********************************************************************************
+ * FileName: VlcProfileOptions.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 根据视频播放配置生成 LibVLC 实例参数和 Media 选项
+ * Others: 不开启 -vvv 等详细日志，日志输出在解码路径上会增加延迟
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.ui.video
+
+import android.net.Uri
+import com.helywin.leggedjoystick.data.VideoProfile
+import org.videolan.libvlc.LibVLC
+import org.videolan.libvlc.Media
+
+/**
+ * 优先UDP时，超过此时间仍未出现画面则回退到RTSP over TCP
+ */
+const val UDP_FALLBACK_TIMEOUT_MS = 3000L
+
+/**
+ * LibVLC 实例参数
+ */
+fun VideoProfile.libVlcOptions(): ArrayList<String> = arrayListOf(
+    "--network-caching=$networkCachingMs",
+    "--clock-jitter=$clockJitterMs",
+    "--clock-synchro=${if (clockSynchro) 1 else 0}",
+    if (dropLateFrames) "--drop-late-frames" else "--no-drop-late-frames",
+    if (dropLateFrames) "--skip-frames" else "--no-skip-frames"
+).apply {
+    if (!preferUdp) add("--rtsp-tcp")
+}
+
+/**
+ * 按配置创建 RTSP 媒体
+ * @param forceTcp UDP无画面回退时为true
+ */
+fun VideoProfile.createMedia(libVLC: LibVLC, rtspUrl: String, forceTcp: Boolean): Media {
+    val media = Media(libVLC, Uri.parse(rtspUrl))
+    media.setHWDecoderEnabled(true, forceHwDecoder)
+    media.addOption(":network-caching=$networkCachingMs")
+    media.addOption(":clock-jitter=$clockJitterMs")
+    media.addOption(":clock-synchro=${if (clockSynchro) 1 else 0}")
+    if (!preferUdp || forceTcp) {
+        media.addOption(":rtsp-tcp")
+    }
+    return media
+}
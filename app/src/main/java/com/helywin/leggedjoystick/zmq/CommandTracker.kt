@@ -0,0 +1,236 @@
+/*********************************************************************************
+ * FileName: CommandTracker.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 模式设置/控制模式设置的在途指令表：请求ID关联、确认超时、有限次重发
+ * Others: 对端回复 CommandAck 或回报的当前状态与目标一致时完成；同类指令同一目标只保留一条在途，
+ *         重复点击复用同一个结果，不会重复发送。时间基准为 System.nanoTime()
+ *         旧版本对端不回复确认，只约每秒广播一次当前状态：会话内从未收到过确认时，
+ *         重发次数用完后继续等待到首次发送后 legacyConfirmTimeoutMs，期间匹配的状态广播即视为确认
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.zmq
+
+import kotlinx.coroutines.suspendCancellableCoroutine
+import java.util.concurrent.CompletableFuture
+import java.util.concurrent.TimeUnit
+import kotlin.coroutines.resume
+import kotlin.coroutines.resumeWithException
+
+/**
+ * 需要确认的指令种类，同一种类同时只有一个目标在途
+ */
+enum class CommandKind {
+    MODE,
+    CONTROL_MODE
+}
+
+/**
+ * 指令完成状态
+ */
+enum class CommandStatus(val displayName: String) {
+    ACKED("已确认"),
+    REJECTED("被拒绝"),
+    TIMEOUT("确认超时"),
+    SUPERSEDED("被新指令取代"),
+    DISCONNECTED("连接已断开")
+}
+
+/**
+ * 指令结果
+ *
+ * @param requestId 请求ID，未发送时为0
+ * @param attempts 发送次数
+ * @param latencyMs 从首次发送到完成的时间
+ */
+data class CommandResult(
+    val requestId: Int,
+    val status: CommandStatus,
+    val attempts: Int = 0,
+    val latencyMs: Long = 0,
+    val reason: String = ""
+) {
+    val isSuccess: Boolean
+        get() = status == CommandStatus.ACKED
+}
+
+/**
+ * 在途指令表，可在任意线程提交，确认和超时检查通常在I/O线程调用
+ * 结果回调在锁外完成，不会在持锁时执行调用方代码
+ *
+ * @param legacyConfirmTimeoutMs 未收到过确认时的最长等待时间，需长于旧版本对端的状态广播周期
+ */
+class CommandTracker(
+    ackTimeoutMs: Long = DEFAULT_ACK_TIMEOUT_MS,
+    private val maxAttempts: Int = DEFAULT_MAX_ATTEMPTS,
+    legacyConfirmTimeoutMs: Long = DEFAULT_LEGACY_CONFIRM_TIMEOUT_MS
+) {
+    companion object {
+        const val DEFAULT_ACK_TIMEOUT_MS = 300L // 单次发送等待确认的时间
+        const val DEFAULT_MAX_ATTEMPTS = 3      // 包括首次发送
+        const val DEFAULT_LEGACY_CONFIRM_TIMEOUT_MS = 1500L // 旧版本对端约1秒广播一次状态
+    }
+
+    private class InFlight(
+        val requestId: Int,
+        val target: Int,
+        val frame: ByteArray,
+        val startNanos: Long,
+        val future: CompletableFuture<CommandResult>
+    ) {
+        var attempts = 1
+        var deadlineNanos = 0L
+    }
+
+    private val ackTimeoutNanos = TimeUnit.MILLISECONDS.toNanos(ackTimeoutMs)
+    private val legacyConfirmTimeoutNanos = TimeUnit.MILLISECONDS.toNanos(legacyConfirmTimeoutMs)
+    private val lock = Any()
+
+    // 本次会话是否收到过确认，收到过说明对端支持确认，超时不再放宽（锁内访问）
+    private var ackSupported = false
+    private val inFlight = arrayOfNulls<InFlight>(CommandKind.entries.size)
+    private var lastRequestId = 0
+
+    // 超时检查的临时结果，避免每次检查分配
+    private val retryScratch = arrayOfNulls<ByteArray>(CommandKind.entries.size)
+    private val expiredScratch = arrayOfNulls<InFlight>(CommandKind.entries.size)
+
+    /**
+     * 提交一条指令
+     * 同类指令已有相同目标在途时直接返回其结果，不再发送；目标不同时旧指令以 SUPERSEDED 结束
+     * @param target 目标值（枚举的 value）
+     * @param encode 按请求ID编码发送帧
+     * @param send 发送帧，在锁外调用
+     */
+    fun submit(
+        kind: CommandKind,
+        target: Int,
+        now: Long,
+        encode: (requestId: Int) -> ByteArray,
+        send: (ByteArray) -> Unit
+    ): CompletableFuture<CommandResult> {
+        val superseded: InFlight?
+        val entry: InFlight
+        synchronized(lock) {
+            val existing = inFlight[kind.ordinal]
+            if (existing != null && existing.target == target) {
+                return existing.future
+            }
+            superseded = existing
+            lastRequestId = if (lastRequestId == Int.MAX_VALUE) 1 else lastRequestId + 1
+            entry = InFlight(lastRequestId, target, encode(lastRequestId), now, CompletableFuture())
+            entry.deadlineNanos = now + ackTimeoutNanos
+            inFlight[kind.ordinal] = entry
+        }
+        superseded?.let { complete(it, CommandStatus.SUPERSEDED, now) }
+        send(entry.frame)
+        return entry.future
+    }
+
+    /**
+     * 处理对端确认
+     * @return 是否匹配到在途指令
+     */
+    fun onAck(requestId: Int, accepted: Boolean, reason: String, now: Long): Boolean {
+        val entry = synchronized(lock) {
+            ackSupported = true
+            val index = inFlight.indexOfFirst { it?.requestId == requestId }
+            if (index < 0) return false
+            inFlight[index].also { inFlight[index] = null }
+        } ?: return false
+        complete(entry, if (accepted) CommandStatus.ACKED else CommandStatus.REJECTED, now, reason)
+        return true
+    }
+
+    /**
+     * 对端回报的当前状态与在途目标一致时视为已确认，兼容不回复确认的旧版本对端
+     */
+    fun onStateReport(kind: CommandKind, value: Int, now: Long) {
+        val entry = synchronized(lock) {
+            val existing = inFlight[kind.ordinal]
+            if (existing == null || existing.target != value) return
+            inFlight[kind.ordinal] = null
+            existing
+        }
+        complete(entry, CommandStatus.ACKED, now)
+    }
+
+    /**
+     * 检查确认超时：未达到发送次数上限时重发同一帧（请求ID不变，对端据此去重），否则以 TIMEOUT 结束；
+     * 从未收到过确认时，TIMEOUT 推迟到首次发送后 legacyConfirmTimeoutMs，等待状态广播
+     * 只应在单个线程（I/O线程）调用
+     * @param resend 重发帧，在锁外调用
+     */
+    fun checkDeadlines(now: Long, resend: (ByteArray) -> Unit) {
+        synchronized(lock) {
+            for (i in inFlight.indices) {
+                val entry = inFlight[i]
+                retryScratch[i] = null
+                expiredScratch[i] = null
+                if (entry == null || now < entry.deadlineNanos) continue
+                if (entry.attempts < maxAttempts) {
+                    entry.attempts++
+                    entry.deadlineNanos = now + ackTimeoutNanos
+                    retryScratch[i] = entry.frame
+                } else if (!ackSupported && now < entry.startNanos + legacyConfirmTimeoutNanos) {
+                    entry.deadlineNanos = entry.startNanos + legacyConfirmTimeoutNanos
+                } else {
+                    inFlight[i] = null
+                    expiredScratch[i] = entry
+                }
+            }
+        }
+        for (i in retryScratch.indices) {
+            retryScratch[i]?.let(resend)
+            expiredScratch[i]?.let { complete(it, CommandStatus.TIMEOUT, now) }
+        }
+    }
+
+    /**
+     * 结束所有在途指令（会话结束时），下次会话重新判断对端是否支持确认
+     */
+    fun failAll(status: CommandStatus, now: Long) {
+        val entries = synchronized(lock) {
+            val pending = inFlight.filterNotNull()
+            inFlight.fill(null)
+            ackSupported = false
+            pending
+        }
+        entries.forEach { complete(it, status, now) }
+    }
+
+    /**
+     * 在途指令数
+     */
+    val size: Int
+        get() = synchronized(lock) { inFlight.count { it != null } }
+
+    private fun complete(entry: InFlight, status: CommandStatus, now: Long, reason: String = "") {
+        entry.future.complete(
+            CommandResult(
+                requestId = entry.requestId,
+                status = status,
+                attempts = entry.attempts,
+                latencyMs = TimeUnit.NANOSECONDS.toMillis(now - entry.startNanos),
+                reason = reason
+            )
+        )
+    }
+}
+
+/**
+ * 挂起等待指令结果；协程取消时只停止等待，不影响共享同一结果的其他调用方
+ */
+suspend fun CompletableFuture<CommandResult>.awaitResult(): CommandResult {
+    if (isDone) return get()
+    return suspendCancellableCoroutine { continuation ->
+        whenComplete { result, error ->
+            if (error != null) {
+                continuation.resumeWithException(error)
+            } else {
+                continuation.resume(result)
+            }
+        }
+    }
+}
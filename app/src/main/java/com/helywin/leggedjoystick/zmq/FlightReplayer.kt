@@ -0,0 +1,94 @@
+/*********************************************************************************
+ * FileName: FlightReplayer.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 黑匣子回放：把记录的入站帧按原始节奏或加速送回 NewZmqClient 的分发路径
+ * Others: 入站帧经过与套接字接收相同的校验、状态更新和消息回调（即控制器），出站帧只计数；
+ *         speed <= 0 时不等待，逐帧尽快分发，可作为分发路径的确定性基准
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.zmq
+
+import com.helywin.leggedjoystick.recording.FlightFrame
+import com.helywin.leggedjoystick.recording.FrameDirection
+import java.util.concurrent.locks.LockSupport
+
+/**
+ * 回放结果
+ *
+ * @param inboundFrames 分发的入站帧数
+ * @param outboundFrames 记录中的出站帧数（不发送）
+ * @param invalidFrames 校验失败的入站帧数
+ * @param recordedNanos 记录覆盖的时长
+ * @param elapsedNanos 回放实际耗时
+ * @param dispatchNanos 分发入站帧的累计耗时（不含等待）
+ */
+data class ReplayReport(
+    val inboundFrames: Int,
+    val outboundFrames: Int,
+    val invalidFrames: Int,
+    val recordedNanos: Long,
+    val elapsedNanos: Long,
+    val dispatchNanos: Long,
+    val cancelled: Boolean
+) {
+    val dispatchNanosPerFrame: Long
+        get() = if (inboundFrames == 0) 0 else dispatchNanos / inboundFrames
+}
+
+/**
+ * 黑匣子回放器，[run] 在调用线程上阻塞执行
+ */
+class FlightReplayer(private val client: NewZmqClient) {
+    @Volatile
+    private var cancelRequested = false
+
+    /**
+     * 请求停止正在进行的回放
+     */
+    fun cancel() {
+        cancelRequested = true
+    }
+
+    /**
+     * 回放一组记录帧
+     * @param speed 回放倍速，1 为原始节奏，<= 0 表示不等待
+     */
+    fun run(frames: List<FlightFrame>, speed: Double = 1.0): ReplayReport {
+        cancelRequested = false
+        var inbound = 0
+        var outbound = 0
+        var invalid = 0
+        var dispatchNanos = 0L
+        val firstTime = frames.firstOrNull()?.timeNanos ?: 0L
+        val start = System.nanoTime()
+
+        for (frame in frames) {
+            if (cancelRequested) break
+            if (frame.direction == FrameDirection.OUTBOUND) {
+                outbound++
+                continue
+            }
+            if (speed > 0) {
+                val target = start + ((frame.timeNanos - firstTime) / speed).toLong()
+                val wait = target - System.nanoTime()
+                if (wait > 0) LockSupport.parkNanos(wait)
+            }
+            val before = System.nanoTime()
+            if (!client.replayInboundFrame(frame.bytes)) invalid++
+            dispatchNanos += System.nanoTime() - before
+            inbound++
+        }
+
+        return ReplayReport(
+            inboundFrames = inbound,
+            outboundFrames = outbound,
+            invalidFrames = invalid,
+            recordedNanos = if (frames.isEmpty()) 0 else frames.last().timeNanos - firstTime,
+            elapsedNanos = System.nanoTime() - start,
+            dispatchNanos = dispatchNanos,
+            cancelled = cancelRequested
+        )
+    }
+}
@@ -0,0 +1,56 @@
+/*********************************************************************************
+ * FileName: LinkCounters.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 链路收发计数：按消息类型统计接收帧数，以及校验失败帧和被丢弃的速度指令帧
+ * Others: 只由I/O线程和发送方做原子累加，读取方按需采样后自行求速率
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.zmq
+
+import legged_driver.MessageType
+import java.util.concurrent.atomic.AtomicLong
+import java.util.concurrent.atomic.AtomicLongArray
+
+/**
+ * 链路计数快照，均为会话以来的累计值
+ *
+ * @param receivedByType 各消息类型（按 [MessageType.ordinal]）的接收帧数
+ * @param decodeFailures CRC32校验或解码失败的帧数
+ * @param droppedFrames 被更新指令覆盖或链路未连通时丢弃的速度指令帧数
+ */
+class LinkCountersSnapshot(
+    val receivedByType: LongArray,
+    val decodeFailures: Long,
+    val droppedFrames: Long
+) {
+    fun received(type: MessageType): Long = receivedByType[type.ordinal]
+}
+
+/**
+ * 链路计数器
+ */
+class LinkCounters {
+    private val receivedByType = AtomicLongArray(MessageType.entries.size)
+    private val decodeFailures = AtomicLong(0)
+    private val droppedFrames = AtomicLong(0)
+
+    fun onReceived(type: MessageType) {
+        receivedByType.incrementAndGet(type.ordinal)
+    }
+
+    fun onDecodeFailure() {
+        decodeFailures.incrementAndGet()
+    }
+
+    fun onFrameDropped() {
+        droppedFrames.incrementAndGet()
+    }
+
+    fun snapshot(): LinkCountersSnapshot = LinkCountersSnapshot(
+        receivedByType = LongArray(receivedByType.length()) { receivedByType.get(it) },
+        decodeFailures = decodeFailures.get(),
+        droppedFrames = droppedFrames.get()
+    )
+}
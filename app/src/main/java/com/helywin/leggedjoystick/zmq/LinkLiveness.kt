@@ -0,0 +1,133 @@
+/*********************************************************************************
+ * FileName: LinkLiveness.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 链路存活判断：按下行帧间隔决定何时探测，按未回应请求的时长判断断链
+ * Others: 稳态下不增加流量：下行按自身节奏到达时不会探测，空闲时只有 heartbeatIntervalMs 的保活心跳；
+ *         只有下行静默超出预期或发出的请求（心跳、指令）未被回应时才按较短间隔探测
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.zmq
+
+import java.util.concurrent.TimeUnit
+
+/**
+ * 链路存活状态，只在I/O线程使用，时间均为 System.nanoTime
+ *
+ * @param heartbeatIntervalMs 保活心跳间隔，同时是探测阈值的上限
+ */
+internal class LinkLiveness(heartbeatIntervalMs: Long) {
+    companion object {
+        const val PROBE_AFTER_SILENCE_MS = 80L // 探测阈值下限，下行帧间隔很短时也至少静默这么久才探测
+        const val PROBE_INTERVAL_MS = 40L // 请求未被回应时的探测间隔
+        const val SILENCE_GAP_FACTOR = 3 // 静默超过帧间隔的倍数后探测
+        const val LINK_TIMEOUT_MARGIN_MS = 20L // 对端处理时间余量
+        const val MIN_LINK_TIMEOUT_MS = 50L
+        const val MAX_LINK_TIMEOUT_MS = 180L // 同时作为没有往返时延数据时的超时，探测阈值 + 探测间隔 + 超时 ≤ 300ms
+        private const val GAP_DECAY_SHIFT = 4 // 帧间隔峰值每收到一帧衰减 1/16
+
+        /**
+         * 根据往返时延和抖动计算断链超时，没有数据时使用上限
+         */
+        fun linkTimeoutNanos(stats: LinkStatsSnapshot): Long {
+            val timeoutMs = if (stats.hasRtt) {
+                ((stats.rttP99Us + 4 * stats.jitterUs) / 1000 + LINK_TIMEOUT_MARGIN_MS)
+                    .coerceIn(MIN_LINK_TIMEOUT_MS, MAX_LINK_TIMEOUT_MS)
+            } else {
+                MAX_LINK_TIMEOUT_MS
+            }
+            return TimeUnit.MILLISECONDS.toNanos(timeoutMs)
+        }
+    }
+
+    private val heartbeatIntervalNanos = TimeUnit.MILLISECONDS.toNanos(heartbeatIntervalMs)
+    private val probeAfterMinNanos = TimeUnit.MILLISECONDS.toNanos(PROBE_AFTER_SILENCE_MS)
+    private val probeIntervalNanos = TimeUnit.MILLISECONDS.toNanos(PROBE_INTERVAL_MS)
+
+    /**
+     * 上次收到任意帧（包括遥测和校验失败的帧）的时间
+     */
+    var lastInboundNanos = 0L
+        private set
+
+    // 下行帧间隔的峰值，缓慢衰减，突发的多帧不会把它拉低
+    private var inboundGapNanos = 0L
+
+    // 最早一个未被回应的请求的发送时间，0 表示没有
+    private var awaitingSinceNanos = 0L
+    private var lastRequestNanos = 0L
+
+    /**
+     * 当前断链超时，由 [updateLinkTimeout] 按链路统计更新
+     */
+    var linkTimeoutNanos = TimeUnit.MILLISECONDS.toNanos(MAX_LINK_TIMEOUT_MS)
+        private set
+
+    /**
+     * 会话开始时重置
+     */
+    fun reset(now: Long) {
+        lastInboundNanos = now
+        inboundGapNanos = 0L
+        awaitingSinceNanos = 0L
+        lastRequestNanos = 0L
+        linkTimeoutNanos = TimeUnit.MILLISECONDS.toNanos(MAX_LINK_TIMEOUT_MS)
+    }
+
+    /**
+     * 收到任意帧：对端存活，之前的请求都视为已回应
+     */
+    fun onInbound(now: Long) {
+        val gap = now - lastInboundNanos
+        inboundGapNanos = maxOf(gap, inboundGapNanos - (inboundGapNanos shr GAP_DECAY_SHIFT))
+        lastInboundNanos = now
+        awaitingSinceNanos = 0L
+    }
+
+    /**
+     * 发出了期待对端回应的帧（心跳、模式指令）
+     */
+    fun onRequestSent(now: Long) {
+        lastRequestNanos = now
+        if (awaitingSinceNanos == 0L) awaitingSinceNanos = now
+    }
+
+    /**
+     * 下行静默多久后开始探测：帧间隔峰值的 [SILENCE_GAP_FACTOR] 倍，限制在探测阈值下限和心跳间隔之间
+     */
+    fun probeAfterNanos(): Long =
+        (inboundGapNanos * SILENCE_GAP_FACTOR).coerceIn(probeAfterMinNanos, maxOf(probeAfterMinNanos, heartbeatIntervalNanos))
+
+    /**
+     * 是否需要发送探测心跳：有请求未被回应时按探测间隔重发，否则下行静默超过探测阈值时发一次
+     */
+    fun shouldProbe(now: Long): Boolean =
+        if (awaitingSinceNanos != 0L) {
+            now - lastRequestNanos >= probeIntervalNanos
+        } else {
+            now - lastInboundNanos >= probeAfterNanos()
+        }
+
+    /**
+     * 最早的未回应请求已等待的时间，没有时为0
+     */
+    fun unansweredNanos(now: Long): Long = if (awaitingSinceNanos == 0L) 0L else now - awaitingSinceNanos
+
+    /**
+     * 请求未被回应超过 探测间隔 + 断链超时，判断断链
+     */
+    fun isLinkDead(now: Long): Boolean = unansweredNanos(now) > deadAfterNanos()
+
+    /**
+     * 判断断链的未回应时长
+     */
+    fun deadAfterNanos(): Long = probeIntervalNanos + linkTimeoutNanos
+
+    /**
+     * 按最新的链路统计更新断链超时
+     */
+    fun updateLinkTimeout(stats: LinkStatsSnapshot) {
+        linkTimeoutNanos = linkTimeoutNanos(stats)
+    }
+}
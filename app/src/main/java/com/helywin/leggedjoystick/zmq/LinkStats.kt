@@ -0,0 +1,165 @@
+/*********************************************************************************
+ * FileName: LinkStats.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 基于心跳回显的链路质量统计：往返时延百分位、抖动、丢包率和时钟偏差
+ * Others: 时间基准为 System.nanoTime()，只在本端计算，不依赖两端时钟同步
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.zmq
+
+import com.helywin.leggedjoystick.metrics.RollingSampleWindow
+import com.helywin.leggedjoystick.proto.HeartbeatFields
+import legged_driver.HeartbeatMessage
+import kotlin.math.abs
+
+/**
+ * 链路统计快照
+ *
+ * @param rttSamples 窗口内的往返时延样本数，为0表示对端不支持心跳回显
+ * @param lastRttUs 最近一次往返时延
+ * @param rttP50Us 往返时延中位数
+ * @param rttP95Us 往返时延95百分位
+ * @param rttP99Us 往返时延99百分位
+ * @param jitterUs 往返时延抖动（相邻样本差值的平滑平均）
+ * @param lossRate 对端心跳丢失率（按对端心跳序号缺口统计）
+ * @param clockOffsetMs 对端时间戳相对本机时钟的偏差估计
+ */
+data class LinkStatsSnapshot(
+    val rttSamples: Int = 0,
+    val lastRttUs: Long = 0,
+    val rttP50Us: Long = 0,
+    val rttP95Us: Long = 0,
+    val rttP99Us: Long = 0,
+    val jitterUs: Long = 0,
+    val lossRate: Float = 0f,
+    val clockOffsetMs: Long = 0
+) {
+    val hasRtt: Boolean
+        get() = rttSamples > 0
+}
+
+/**
+ * 链路统计，I/O线程记录对端心跳并生成本端心跳字段，快照可在任意线程读取
+ */
+class LinkStats(windowSize: Int = DEFAULT_WINDOW_SIZE) {
+    companion object {
+        private const val DEFAULT_WINDOW_SIZE = 128
+        private const val JITTER_GAIN = 16 // RFC 3550 抖动平滑系数
+        private const val CLOCK_OFFSET_GAIN = 8
+        private val PERCENTILES = doubleArrayOf(50.0, 95.0, 99.0)
+    }
+
+    private val lock = Any()
+    private val rttWindow = RollingSampleWindow(windowSize)
+    private val receivedGaps = RollingSampleWindow(windowSize)
+    private val percentileOut = LongArray(PERCENTILES.size)
+
+    // 本端心跳
+    private var localSequence = 0
+
+    // 最近收到的对端心跳
+    private var peerSequence = 0
+    private var peerSendTimeUs = 0L
+    private var peerReceivedAtNanos = 0L
+
+    // 往返时延
+    private var lastEchoSequence = 0
+    private var jitterUs = 0L
+    private var clockOffsetMs = 0L
+    private var hasClockOffset = false
+
+    /**
+     * 重置所有统计（新连接时调用）
+     */
+    fun reset() = synchronized(lock) {
+        rttWindow.clear()
+        receivedGaps.clear()
+        localSequence = 0
+        peerSequence = 0
+        peerSendTimeUs = 0
+        peerReceivedAtNanos = 0
+        lastEchoSequence = 0
+        jitterUs = 0
+        clockOffsetMs = 0
+        hasClockOffset = false
+    }
+
+    /**
+     * 填充下一次发送的心跳字段
+     */
+    fun prepareHeartbeat(nowNanos: Long, fields: HeartbeatFields) = synchronized(lock) {
+        localSequence++
+        if (localSequence == 0) localSequence = 1 // 0 表示不支持，溢出回绕时跳过
+        fields.sequence = localSequence
+        fields.sendTimeUs = nowNanos / 1000
+        fields.echoSequence = peerSequence
+        fields.echoTimeUs = peerSendTimeUs
+        fields.echoDelayUs = if (peerReceivedAtNanos == 0L) 0
+            else ((nowNanos - peerReceivedAtNanos) / 1000).coerceIn(0, Int.MAX_VALUE.toLong()).toInt()
+    }
+
+    /**
+     * 记录收到的对端心跳
+     * @param peerTimestampMs 对端消息的 timestamp_ms（对端墙上时钟）
+     * @param nowNanos 收到时刻
+     * @param nowWallMs 收到时刻的本机墙上时钟
+     */
+    fun onPeerHeartbeat(heartbeat: HeartbeatMessage, peerTimestampMs: Long, nowNanos: Long, nowWallMs: Long) =
+        synchronized(lock) {
+            // 对端序号缺口即丢失的心跳
+            val sequence = heartbeat.sequence
+            if (sequence != 0) {
+                if (peerSequence != 0 && sequence > peerSequence) {
+                    receivedGaps.add((sequence - peerSequence - 1).toLong())
+                } else {
+                    // 首个心跳或对端重启
+                    receivedGaps.add(0)
+                }
+                peerSequence = sequence
+                peerSendTimeUs = heartbeat.send_time_us
+                peerReceivedAtNanos = nowNanos
+            }
+
+            // 对端回显了本端心跳，计算往返时延（同一回显只计一次）
+            val echoSequence = heartbeat.echo_sequence
+            if (echoSequence == 0 || echoSequence == lastEchoSequence || heartbeat.echo_time_us == 0L) {
+                return@synchronized
+            }
+            lastEchoSequence = echoSequence
+
+            val rttUs = nowNanos / 1000 - heartbeat.echo_time_us - heartbeat.echo_delay_us
+            if (rttUs < 0) return@synchronized
+
+            val previousRtt = rttWindow.last(rttUs)
+            jitterUs += (abs(rttUs - previousRtt) - jitterUs) / JITTER_GAIN
+            rttWindow.add(rttUs)
+
+            // 假设上下行对称，对端时间戳对应本机的 nowWallMs - rtt/2
+            if (peerTimestampMs != 0L) {
+                val offset = peerTimestampMs - (nowWallMs - rttUs / 2000)
+                clockOffsetMs = if (hasClockOffset) clockOffsetMs + (offset - clockOffsetMs) / CLOCK_OFFSET_GAIN else offset
+                hasClockOffset = true
+            }
+        }
+
+    /**
+     * 获取当前统计快照
+     */
+    fun snapshot(): LinkStatsSnapshot = synchronized(lock) {
+        rttWindow.percentiles(PERCENTILES, percentileOut)
+        val lost = receivedGaps.sum()
+        val total = lost + receivedGaps.count
+        LinkStatsSnapshot(
+            rttSamples = rttWindow.count,
+            lastRttUs = rttWindow.last(),
+            rttP50Us = percentileOut[0],
+            rttP95Us = percentileOut[1],
+            rttP99Us = percentileOut[2],
+            jitterUs = jitterUs,
+            lossRate = if (total == 0L) 0f else lost.toFloat() / total,
+            clockOffsetMs = clockOffsetMs
+        )
+    }
+}
@@ -0,0 +1,183 @@
+/*********************************************************************************
+ * FileName: MessageDispatcher.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 按消息类型订阅的分发器，每个订阅指定在哪个线程上投递
+ * Others: 分发在I/O线程（或回放线程）上进行；没有订阅的消息类型由客户端跳过完整解码；
+ *         主线程订阅按显示帧合并，同一帧内的多条消息只投递最新一条，一帧最多触发一次界面更新
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.zmq
+
+import android.view.Choreographer
+import legged_driver.LeggedDriverMessage
+import legged_driver.MessageType
+import timber.log.Timber
+import java.util.concurrent.ExecutorService
+import java.util.concurrent.Executors
+import java.util.concurrent.atomic.AtomicBoolean
+import java.util.concurrent.atomic.AtomicReference
+
+/**
+ * 订阅的投递方式
+ */
+enum class DeliveryMode {
+    INLINE,         // 在分发线程上直接调用，回调必须很快且不能访问界面状态
+    MAIN_COALESCED, // 在下一个显示帧的主线程回调中投递，只保留最新一条
+    BACKGROUND      // 在后台单线程上按顺序逐条投递
+}
+
+/**
+ * 显示帧调度，默认使用 [Choreographer]，测试中可替换
+ */
+fun interface FrameScheduler {
+    fun postFrameCallback(callback: Choreographer.FrameCallback)
+}
+
+/**
+ * 一个订阅，由 [MessageDispatcher.subscribe] 返回，用于取消订阅
+ */
+class MessageSubscription internal constructor(
+    val type: MessageType,
+    val mode: DeliveryMode,
+    internal val callback: MessageCallback
+) {
+    // MAIN_COALESCED 下等待下一帧投递的最新消息
+    internal val pending = AtomicReference<LeggedDriverMessage?>(null)
+}
+
+/**
+ * 消息分发器
+ * [subscribe] / [unsubscribe] 可在任意线程调用，但 MAIN_COALESCED 的首个订阅须在主线程注册；
+ * [dispatch] 只应在单个分发线程上调用
+ */
+class MessageDispatcher(
+    @Volatile private var frameScheduler: FrameScheduler? = null
+) : Choreographer.FrameCallback {
+    companion object {
+        private val TYPE_SLOTS = MessageType.entries.maxOf { it.value } + 1
+        private val NO_SUBSCRIPTIONS = emptyArray<MessageSubscription>()
+    }
+
+    private val lock = Any()
+
+    // 按 MessageType.value 索引的订阅列表，写时复制，分发线程无锁读取
+    @Volatile
+    private var byType: Array<Array<MessageSubscription>> = Array(TYPE_SLOTS) { NO_SUBSCRIPTIONS }
+
+    @Volatile
+    private var mainSubscriptions: Array<MessageSubscription> = NO_SUBSCRIPTIONS
+
+    private val frameScheduled = AtomicBoolean(false)
+
+    @Volatile
+    private var backgroundExecutor: ExecutorService? = null
+
+    /**
+     * 订阅一种消息类型
+     */
+    fun subscribe(type: MessageType, mode: DeliveryMode, callback: MessageCallback): MessageSubscription {
+        val subscription = MessageSubscription(type, mode, callback)
+        synchronized(lock) {
+            when (mode) {
+                DeliveryMode.MAIN_COALESCED -> {
+                    if (frameScheduler == null) {
+                        // Choreographer 与线程绑定，必须在主线程获取
+                        val choreographer = Choreographer.getInstance()
+                        frameScheduler = FrameScheduler { choreographer.postFrameCallback(it) }
+                    }
+                    mainSubscriptions += subscription
+                }
+                DeliveryMode.BACKGROUND -> {
+                    if (backgroundExecutor == null) {
+                        backgroundExecutor = Executors.newSingleThreadExecutor { runnable ->
+                            Thread(runnable, "MessageDispatch").apply { isDaemon = true }
+                        }
+                    }
+                }
+                DeliveryMode.INLINE -> Unit
+            }
+            val slots = byType.copyOf()
+            slots[type.value] = slots[type.value] + subscription
+            byType = slots
+        }
+        return subscription
+    }
+
+    /**
+     * 取消订阅，已合并但尚未投递的消息一并丢弃
+     */
+    fun unsubscribe(subscription: MessageSubscription) {
+        synchronized(lock) {
+            val slots = byType.copyOf()
+            slots[subscription.type.value] = slots[subscription.type.value]
+                .filter { it !== subscription }
+                .toTypedArray()
+            byType = slots
+            if (subscription.mode == DeliveryMode.MAIN_COALESCED) {
+                mainSubscriptions = mainSubscriptions.filter { it !== subscription }.toTypedArray()
+            }
+        }
+        subscription.pending.set(null)
+    }
+
+    /**
+     * 该消息类型（枚举值）是否有订阅，没有订阅时调用方可以跳过解码
+     */
+    fun hasSubscribers(typeValue: Int): Boolean {
+        val slots = byType
+        return typeValue in slots.indices && slots[typeValue].isNotEmpty()
+    }
+
+    /**
+     * 分发一条已解码的消息（分发线程）
+     */
+    fun dispatch(message: LeggedDriverMessage) {
+        val typeValue = message.message_type.value
+        val slots = byType
+        if (typeValue !in slots.indices) return
+        for (subscription in slots[typeValue]) {
+            when (subscription.mode) {
+                DeliveryMode.INLINE -> deliver(subscription, message)
+                DeliveryMode.MAIN_COALESCED -> {
+                    subscription.pending.set(message)
+                    if (frameScheduled.compareAndSet(false, true)) {
+                        frameScheduler?.postFrameCallback(this)
+                    }
+                }
+                DeliveryMode.BACKGROUND -> backgroundExecutor?.execute { deliver(subscription, message) }
+            }
+        }
+    }
+
+    /**
+     * 显示帧回调（主线程），投递本帧内合并的消息
+     */
+    override fun doFrame(frameTimeNanos: Long) {
+        // 先清除标记：投递过程中到达的消息会安排下一帧
+        frameScheduled.set(false)
+        for (subscription in mainSubscriptions) {
+            val message = subscription.pending.getAndSet(null) ?: continue
+            deliver(subscription, message)
+        }
+    }
+
+    private fun deliver(subscription: MessageSubscription, message: LeggedDriverMessage) {
+        try {
+            subscription.callback(message)
+        } catch (e: Exception) {
+            Timber.e(e, "[MessageDispatcher] ${subscription.type} 订阅回调异常")
+        }
+    }
+
+    /**
+     * 停止后台投递线程
+     */
+    fun close() {
+        synchronized(lock) {
+            backgroundExecutor?.shutdown()
+            backgroundExecutor = null
+        }
+    }
+}
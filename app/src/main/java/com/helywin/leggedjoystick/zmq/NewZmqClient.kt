@@ -4,14 +4,29 @@
  * Version: 0.1.0
  * Date: 2025-09-16
  * Description: 重构后的ZMQ客户端，使用更稳定的线程管理和错误处理机制
- * Others: 修复了可能导致App卡死的线程同步和资源管理问题
+ * Others: 套接字只在 [ZmqIoLoop] 的I/O线程上收发，多个客户端（多机器人）可共享同一个循环；
+ *         链路中断后进入重连状态，由 ZMQ 自身重连加应用层退避恢复，不重建上下文和线程；
+ *         可选的遥测通道为开启 CONFLATE 的 SUB 套接字，与指令 DEALER 由同一个 poller 复用
  *********************************************************************************/
 
 package com.helywin.leggedjoystick.zmq
 
 import legged_driver.*
+import com.helywin.leggedjoystick.proto.FrameBuffer
+import com.helywin.leggedjoystick.proto.FrameBufferPool
+import com.helywin.leggedjoystick.proto.HeartbeatFields
+import com.helywin.leggedjoystick.proto.HotPathEncoder
 import com.helywin.leggedjoystick.proto.MessageUtils
 import com.helywin.leggedjoystick.data.ConnectionState
+import com.helywin.leggedjoystick.odometry.OdometryBuffer
+import com.helywin.leggedjoystick.BuildConfig
+import com.helywin.leggedjoystick.log.HotEvent
+import com.helywin.leggedjoystick.log.HotLog
+import com.helywin.leggedjoystick.recording.FlightRecorder
+import com.helywin.leggedjoystick.recording.FrameDirection
+import com.helywin.leggedjoystick.recording.TelemetryRecorder
+import com.helywin.leggedjoystick.trace.PerfTrace
+import com.helywin.leggedjoystick.trace.TraceNames
 import org.zeromq.SocketType
 import org.zeromq.ZContext
 import org.zeromq.ZMQ
@@ -22,7 +37,6 @@ import java.util.concurrent.atomic.AtomicBoolean
 import java.util.concurrent.atomic.AtomicReference
 import java.util.concurrent.atomic.AtomicLong
 import java.util.concurrent.atomic.AtomicInteger
-import kotlin.getValue
 
 /**
  * 消息回调函数类型
@@ -44,61 +58,167 @@ typealias ConnectionLostCallback = () -> Unit
  */
 typealias ConnectionStateChangeCallback = (ConnectionState) -> Unit
 
+/**
+ * 链路统计回调
+ */
+typealias LinkStatsCallback = (LinkStatsSnapshot) -> Unit
+
 /**
  * 新的ZMQ客户端实现
- * 使用ExecutorService管理线程池，提供更稳定的连接管理
+ * I/O循环的线程负责收发和链路保活，生产者只写入发送通道并唤醒I/O线程
+ *
+ * @param ioLoop 共享的I/O循环，为 null 时首次连接创建本客户端独占的循环，关闭客户端时一并关闭
  */
 class NewZmqClient(
     val deviceType: DeviceType = DeviceType.DEVICE_TYPE_REMOTE_CONTROLLER,
     var tcpEndpoint: String = DEFAULT_TCP_ENDPOINT,
-    val heartbeatIntervalMs: Long = DEFAULT_HEARTBEAT_INTERVAL_MS
+    val heartbeatIntervalMs: Long = DEFAULT_HEARTBEAT_INTERVAL_MS,
+    ioLoop: ZmqIoLoop? = null
 ) {
     companion object {
         private const val DEFAULT_TCP_ENDPOINT = "tcp://127.0.0.1:33445"
         private const val DEFAULT_HEARTBEAT_INTERVAL_MS = 1000L
         private const val SOCKET_RECV_TIMEOUT_MS = 100
+        private const val MAX_FRAMES_PER_WAKEUP = 256 // 单次唤醒最多处理的帧数，避免长时间占用I/O线程
         private const val SOCKET_SEND_TIMEOUT_MS = 1000
-        private const val MAX_SEND_QUEUE_SIZE = 1000 // 限制发送队列大小
-        private const val THREAD_SHUTDOWN_TIMEOUT_MS = 5000L
+        private const val MAX_SEND_QUEUE_SIZE = 64 // 可靠发送通道队列上限（模式/控制模式）
         private const val MAX_CONSECUTIVE_FAILURES = 3
         private const val CONNECTION_VERIFY_TIMEOUT_MS = 2000L // 连接验证超时时间
-        private const val HEARTBEAT_RESPONSE_TIMEOUT_MS = 2500L // 心跳响应超时时间，超过此时间未收到服务器心跳则判断连接丢失
+
+        // 链路保活：上行空闲满 heartbeatIntervalMs 才发送心跳，探测和断链判断见 LinkLiveness
+        private const val CONNECT_PROBE_INTERVAL_MS = 40L // 连接验证期间的心跳间隔
+        private const val LINK_STATS_PUBLISH_INTERVAL_MS = 1000L
+
+        // 自动重连：TCP层由ZMQ按 ivl..ivlMax 指数退避重拨，ZMTP心跳负责发现半开连接；
+        // 应用层按退避间隔发探测心跳，长时间无响应时重建套接字
+        private const val ZMQ_RECONNECT_IVL_MS = 20
+        private const val ZMQ_RECONNECT_IVL_MAX_MS = 250
+        private const val ZMTP_HEARTBEAT_IVL_MS = 250
+        private const val ZMTP_HEARTBEAT_TIMEOUT_MS = 750
+        private const val RECONNECT_PROBE_MIN_MS = 20L
+        private const val RECONNECT_PROBE_MAX_MS = 250L
+        private const val REDIAL_BASE_MS = 2000L
+        private const val REDIAL_MAX_MS = 8000L
+        private const val RECONNECT_GIVE_UP_MS = 120_000L
+        private const val STATE_RESYNC_TIMEOUT_MS = 1000L // 恢复后请求对端状态的最长时间
+        private const val MAX_TELEMETRY_FRAMES_PER_WAKEUP = 16 // CONFLATE 下每次通常只有一帧
+        private const val NO_IO_SESSION = -1
     }
 
-    // ZMQ相关
-    @Volatile
-    private var zmqContext: ZContext? = null
+    /**
+     * 单次套接字会话的结束原因
+     */
+    private enum class SocketExit {
+        SESSION_ENDED, // 断开连接、连接失败或客户端关闭
+        REDIAL         // 重连期间长时间无响应，重建套接字
+    }
 
+    // I/O循环（ZMQ上下文和I/O线程），共享的由外部传入，否则首次连接时创建，在客户端生命周期内只创建一次
     @Volatile
-    private var socket: ZMQ.Socket? = null
+    private var ioLoop: ZmqIoLoop? = ioLoop
+    private val ownsIoLoop = ioLoop == null
+    private val closed = AtomicBoolean(false)
 
-    // 状态控制
+    // 状态控制：running 表示会话处于活动状态（包括重连中），sessionGeneration 每次连接/断开递增
     private val running = AtomicBoolean(false)
+    private val sessionGeneration = AtomicInteger(0)
+    @Volatile
+    private var sessionEndpoint: String? = null
+    @Volatile
+    private var sessionTelemetryEndpoint: String? = null
     private val connectionState = AtomicReference(ConnectionState.DISCONNECTED)
 
-    // 线程池管理
+    /**
+     * 是否在链路中断后自动重连，关闭时中断即进入连接失败状态
+     */
+    @Volatile
+    var autoReconnect = true
+
+    /**
+     * 是否为正在操控的机器人会话，后台会话只保活（心跳），不发送速度指令
+     */
+    @Volatile
+    var isForeground = true
+        private set
+
+    // 转入后台后I/O线程需要补发一次零速度指令
+    private val stopOnBackground = AtomicBoolean(false)
+
+    // 当前套接字会话（仅I/O线程访问）
+    private var ioGeneration = NO_IO_SESSION
+    private var ioSocket: ZMQ.Socket? = null
+    private var ioTelemetrySocket: ZMQ.Socket? = null
+    private var socketIndex = -1
+    private var telemetryIndex = -1
+    private var redialPending = false
+
+    // 发送帧缓冲池，覆盖可靠通道、待重试帧和速度指令槽的最大占用
+    private val framePool = FrameBufferPool(MAX_SEND_QUEUE_SIZE + 4)
+
+    // 可靠发送通道 - 模式设置和控制模式设置按顺序发送，使用有界队列防止内存泄漏
+    private val sendQueue = ArrayBlockingQueue<FrameBuffer>(MAX_SEND_QUEUE_SIZE)
+
+    // 可靠通道中发送失败、等待重试的帧（仅I/O线程修改），保证重试时不打乱顺序
     @Volatile
-    private var executorService: ExecutorService? = null
+    private var pendingReliableFrame: FrameBuffer? = null
 
-    // 任务Future，用于控制任务的取消
-    private val receiveFuture = AtomicReference<Future<*>?>()
-    private val sendFuture = AtomicReference<Future<*>?>()
-    private val heartbeatFuture = AtomicReference<Future<*>?>()
+    // 速度指令最新值槽 - 新指令直接覆盖尚未发送的旧指令，排队延迟最多一帧
+    private val latestVelocityFrame = AtomicReference<FrameBuffer?>(null)
 
-    // 发送队列 - 使用有界队列防止内存泄漏
-    private val sendQueue = LinkedBlockingQueue<ByteArray>(MAX_SEND_QUEUE_SIZE)
+    // 心跳和停止指令由I/O线程直接编码发送，使用独立的缓冲区
+    private val controlFrame = FrameBuffer()
+    private val heartbeatRequested = AtomicBoolean(false)
 
     // 统计信息
     private val lastHeartbeatTime = AtomicLong(0)
-    private val lastServerHeartbeatTime = AtomicLong(0) // 上次收到服务器心跳的时间
+    private val lastOutboundNanos = AtomicLong(0) // 上次成功发送任意帧的时间（System.nanoTime）
     private val consecutiveFailures = AtomicInteger(0)
+    private val linkCounters = LinkCounters()
+
+    // 黑匣子记录器，为 null 时不记录
+    @Volatile
+    private var flightRecorder: FlightRecorder? = null
+
+    // 以下仅在I/O线程访问
+    private var sessionStartNanos = 0L
+    private var lastProbeNanos = 0L
+    private var lastStatsNanos = 0L
+    private val liveness = LinkLiveness(heartbeatIntervalMs)
+    private var linkFailureDetected = false
+    private var linkLostNanos = 0L
+    private var reconnectProbeIntervalNanos = 0L
+    private var socketOpenedNanos = 0L
+    private var redialAttempt = 0
+    private var stateResyncDeadlineNanos = 0L
+
+    // 状态同步：恢复后等待对端回复当前模式和控制模式
+    private val stateResyncPending = AtomicBoolean(false)
+    private val modeSynced = AtomicBoolean(false)
+    private val controlModeSynced = AtomicBoolean(false)
+
+    // 需要确认的模式/控制模式指令（请求ID关联、超时重发）
+    private val commandTracker = CommandTracker()
+
+    // 链路质量统计（心跳回显）
+    private val linkStats = LinkStats()
+    private val heartbeatFields = HeartbeatFields()
+
+    // 里程计环形缓冲区（I/O线程写入）
+    private val odometryBuffer = OdometryBuffer()
 
     // 客户端信息
-    private var deviceId: String = MessageUtils.generateDeviceId(deviceType)
+    private val deviceId: String = MessageUtils.generateDeviceId(deviceType)
+
+    // 速度指令和心跳的预编码编码器
+    private val hotPathEncoder = HotPathEncoder(deviceType, deviceId)
+
+    // 按消息类型订阅的分发器，客户端自身的状态更新也作为 INLINE 订阅注册
+    private val dispatcher = MessageDispatcher()
 
     // 回调
     private var messageCallback: MessageCallback? = null
     private var connectionStateCallback: ConnectionStateCallback? = null
+    private var linkStatsCallback: LinkStatsCallback? = null
 
     // 服务器状态缓存
     private val serverConnected = AtomicBoolean(false)
@@ -106,6 +226,17 @@ class NewZmqClient(
     private val currentControlMode = AtomicReference(ControlMode.CONTROL_MODE_STAND_UP)
     private val batteryLevel = AtomicReference(0)
 
+    init {
+        dispatcher.subscribe(MessageType.MESSAGE_TYPE_HEARTBEAT, DeliveryMode.INLINE, ::handleHeartbeatMessage)
+        dispatcher.subscribe(MessageType.MESSAGE_TYPE_BATTERY_INFO, DeliveryMode.INLINE, ::handleBatteryInfoMessage)
+        dispatcher.subscribe(MessageType.MESSAGE_TYPE_CURRENT_MODE, DeliveryMode.INLINE, ::handleCurrentModeMessage)
+        dispatcher.subscribe(
+            MessageType.MESSAGE_TYPE_CURRENT_CONTROL_MODE, DeliveryMode.INLINE, ::handleCurrentControlModeMessage
+        )
+        dispatcher.subscribe(MessageType.MESSAGE_TYPE_ODOMETRY, DeliveryMode.INLINE, ::handleOdometryMessage)
+        dispatcher.subscribe(MessageType.MESSAGE_TYPE_COMMAND_ACK, DeliveryMode.INLINE, ::handleCommandAckMessage)
+    }
+
     /**
      * 设置连接端点
      */
@@ -114,12 +245,34 @@ class NewZmqClient(
         Timber.d("[NewZmqClient] 连接端点已设置为: $endpoint")
     }
 
+    /**
+     * 遥测通道端点（PUB/SUB），为 null 时里程计和电量等遥测与指令共用DEALER
+     * 在下次连接时生效
+     */
+    @Volatile
+    var telemetryEndpoint: String? = null
+        private set
+
+    /**
+     * 设置遥测通道端点，传入 null 关闭独立遥测通道
+     */
+    fun setTelemetryEndpoint(endpoint: String?) {
+        telemetryEndpoint = endpoint
+        Timber.d("[NewZmqClient] 遥测端点已设置为: ${endpoint ?: "无（与指令通道共用）"}")
+    }
+
     /**
      * 连接到服务器
+     * 只提交连接请求，建立套接字和验证连接在I/O线程上进行，结果通过连接状态回调通知
      */
     fun connect() {
+        if (closed.get()) {
+            Timber.w("[NewZmqClient] 客户端已关闭，忽略连接请求")
+            return
+        }
+
         val currentState = connectionState.get()
-        if (currentState == ConnectionState.CONNECTED) {
+        if (currentState == ConnectionState.CONNECTED || currentState == ConnectionState.RECONNECTING) {
             Timber.w("[NewZmqClient] 客户端已经连接")
         }
 
@@ -132,41 +285,18 @@ class NewZmqClient(
 
         Timber.i("[NewZmqClient] 开始连接到服务器: $tcpEndpoint")
 
-        // 确保线程池可用
-        ensureExecutorService()
+        // 确保I/O循环可用（上下文和线程只在首次连接时创建）
+        ensureIoLoop()
 
-        // 创建ZMQ上下文和socket
-        val newContext = ZContext()
-        val newSocket = newContext.createSocket(SocketType.DEALER).apply {
-            receiveTimeOut = SOCKET_RECV_TIMEOUT_MS
-            sendTimeOut = SOCKET_SEND_TIMEOUT_MS
-            linger = 0
-        }
-
-        // ZMQ的connect是异步的，总是返回true
-        newSocket.connect(tcpEndpoint)
-
-        // 更新实例变量
-        zmqContext = newContext
-        socket = newSocket
-
-        Timber.i("[NewZmqClient] ZMQ socket已建立，开始验证服务器连接...")
-
-        // 重置状态变量
-        resetConnectionState()
-
-        // 验证连接
-        startConnectionVerification()
-
-        // 启动工作任务但不设置为已连接
+        sessionEndpoint = tcpEndpoint
+        sessionTelemetryEndpoint = telemetryEndpoint
+        sessionGeneration.incrementAndGet()
         running.set(true)
-        startWorkerTasks()
-
-
+        wakeupIo()
     }
 
     /**
-     * 断开连接
+     * 断开连接，I/O线程关闭套接字后回到空闲状态，上下文和线程保留
      */
     fun disconnect() {
         val currentState = connectionState.get()
@@ -182,13 +312,11 @@ class NewZmqClient(
 
         // 停止状态标志
         running.set(false)
+        sessionGeneration.incrementAndGet()
         updateConnectionState(ConnectionState.DISCONNECTED)
 
-        // 取消所有任务
-        cancelAllTasks()
-
-        // 清理资源
-        cleanup()
+        // 唤醒阻塞在poller上的I/O线程
+        wakeupIo()
 
         Timber.i("[NewZmqClient] 客户端已断开连接")
     }
@@ -199,292 +327,302 @@ class NewZmqClient(
     private fun updateConnectionState(newState: ConnectionState) {
         val oldState = connectionState.getAndSet(newState)
         if (oldState != newState) {
-            Timber.d("[NewZmqClient] 连接状态变更: $oldState -> $newState")
+            HotLog.log(HotEvent.CONNECTION_STATE, oldState.ordinal.toLong(), newState.ordinal.toLong())
             connectionStateCallback?.invoke(newState)
         }
     }
 
     /**
-     * 启动异步连接验证
+     * 确保I/O循环可用并挂载本客户端
      */
-    private fun startConnectionVerification() {
-        val executor = executorService ?: return
-
-        executor.submit {
-            try {
-                Timber.d("[NewZmqClient] 开始异步验证连接，发送测试心跳...")
-
-                // 发送测试心跳
-                sendHeartbeat()
-
-                // 等待服务器响应
-                val startTime = System.currentTimeMillis()
-                var connectionVerified = false
-
-                while (System.currentTimeMillis() - startTime < CONNECTION_VERIFY_TIMEOUT_MS && running.get()) {
-                    if (serverConnected.get()) {
-                        connectionVerified = true
-                        break
-                    }
-                    Thread.sleep(100)
-                }
+    @Synchronized
+    private fun ensureIoLoop() {
+        val loop = ioLoop ?: ZmqIoLoop().also { ioLoop = it }
+        loop.attach(this)
+        loop.start()
+    }
 
-                if (connectionVerified) {
-                    updateConnectionState(ConnectionState.CONNECTED)
-                    Timber.i("[NewZmqClient] 服务器连接验证成功")
-                } else {
-                    Timber.w("[NewZmqClient] 连接验证超时，未收到服务器响应")
-                    updateConnectionState(ConnectionState.CONNECTION_TIMEOUT)
+    /**
+     * 会话是否仍是 [generation] 对应的那一次连接
+     */
+    private fun isCurrent(generation: Int): Boolean =
+        running.get() && sessionGeneration.get() == generation && !closed.get()
 
-                    // 清理资源
-                    running.set(false)
-                    cancelAllTasks()
-                    cleanup()
-                }
+    /**
+     * 是否有打开的套接字会话（I/O线程）
+     */
+    internal val hasIoSession: Boolean
+        get() = ioGeneration != NO_IO_SESSION
 
-            } catch (e: Exception) {
-                Timber.e(e, "[NewZmqClient] 连接验证过程中发生异常")
-                updateConnectionState(ConnectionState.CONNECTION_FAILED)
+    /**
+     * 已关闭且套接字已销毁，可以从I/O循环移除（I/O线程）
+     */
+    internal val isReleasable: Boolean
+        get() = closed.get() && ioGeneration == NO_IO_SESSION
 
-                // 清理资源
-                running.set(false)
-                cancelAllTasks()
-                cleanup()
-            }
+    /**
+     * 按连接请求开关套接字（I/O线程，每轮 poll 前调用）：
+     * 连接请求被新的连接/断开替换时结束旧会话，有新的连接请求时开始会话，
+     * 重连期间长时间无响应时重建指令套接字；遥测套接字在整个会话内保持
+     * @return 套接字是否发生变化（需要重新注册到 poller）
+     */
+    internal fun prepareIo(context: ZContext): Boolean {
+        val generation = sessionGeneration.get()
+        val endpoint = sessionEndpoint
+        val wanted = isCurrent(generation) && endpoint != null
+        var changed = false
+
+        if (ioGeneration != NO_IO_SESSION && (!wanted || ioGeneration != generation)) {
+            endIoSession(context)
+            changed = true
         }
+        if (wanted && ioGeneration == NO_IO_SESSION) {
+            beginIoSession(context, endpoint!!, sessionTelemetryEndpoint, generation)
+            changed = true
+        } else if (redialPending && ioGeneration != NO_IO_SESSION) {
+            redialPending = false
+            ioSocket?.let { context.destroySocket(it) }
+            ioSocket = null
+            redialAttempt++
+            Timber.i("[NewZmqClient] 重连期间无响应，重建套接字（第${redialAttempt}次）")
+            openCommandSocket(context, ioGeneration)
+            changed = true
+        }
+        return changed
     }
 
     /**
-     * 启动带回调的连接验证
+     * 把本会话的套接字注册到 poller（I/O线程，poller 重建时调用）
      */
-    private fun startConnectionVerificationWithCallback(result: CompletableFuture<Boolean>) {
-        val executor = executorService ?: return
-
-        executor.submit {
-            try {
-                Timber.d("[NewZmqClient] 开始验证连接，发送测试心跳...")
+    internal fun registerIo(poller: ZMQ.Poller) {
+        socketIndex = ioSocket?.let { poller.register(it, ZMQ.Poller.POLLIN) } ?: -1
+        telemetryIndex = ioTelemetrySocket?.let { poller.register(it, ZMQ.Poller.POLLIN) } ?: -1
+    }
 
-                // 发送测试心跳
-                sendHeartbeat()
+    /**
+     * 处理一次唤醒（I/O线程）：读空入站帧 -> 读取最新遥测 -> 发送通道 -> 保活检查
+     */
+    internal fun serviceIo(poller: ZMQ.Poller) {
+        val socket = ioSocket ?: return
+        val generation = ioGeneration
+        if (socketIndex < 0 || !isCurrent(generation)) return
+
+        if (poller.pollin(socketIndex)) {
+            var frames = 0
+            while (frames < MAX_FRAMES_PER_WAKEUP && isCurrent(generation) && processReceiveOnce(socket)) {
+                frames++
+            }
+        }
 
-                // 等待服务器响应
-                val startTime = System.currentTimeMillis()
-                var connectionVerified = false
+        val telemetrySocket = ioTelemetrySocket
+        if (telemetrySocket != null && telemetryIndex >= 0 && poller.pollin(telemetryIndex)) {
+            var frames = 0
+            while (frames < MAX_TELEMETRY_FRAMES_PER_WAKEUP && isCurrent(generation) &&
+                processTelemetryOnce(telemetrySocket)) {
+                frames++
+            }
+        }
 
-                while (System.currentTimeMillis() - startTime < CONNECTION_VERIFY_TIMEOUT_MS && running.get()) {
-                    if (serverConnected.get()) {
-                        connectionVerified = true
-                        break
-                    }
-                    Thread.sleep(100)
-                }
+        // 转入后台：丢弃未发出的速度指令并让机器人停下
+        if (stopOnBackground.getAndSet(false) && connectionState.get() == ConnectionState.CONNECTED) {
+            latestVelocityFrame.getAndSet(null)?.let { framePool.release(it) }
+            sendStopFrameNow(socket)
+        }
 
-                if (connectionVerified) {
-                    updateConnectionState(ConnectionState.CONNECTED)
-                    Timber.i("[NewZmqClient] 服务器连接验证成功")
-                    result.complete(true)
-                } else {
-                    Timber.w("[NewZmqClient] 连接验证超时，未收到服务器响应")
-                    updateConnectionState(ConnectionState.CONNECTION_TIMEOUT)
+        // 超时未确认的指令重新进入可靠通道，本轮即可发出
+        commandTracker.checkDeadlines(System.nanoTime(), ::resendCommandFrame)
 
-                    // 清理资源
-                    running.set(false)
-                    cancelAllTasks()
-                    cleanup()
-                    result.complete(false)
-                }
+        if (BuildConfig.ENABLE_TRACING) {
+            PerfTrace.counter(TraceNames.ZMQ_SEND_QUEUE, getSendQueueSize())
+        }
+        PerfTrace.section(TraceNames.ZMQ_SEND) {
+            flushSendLanes(socket)
+        }
 
-            } catch (e: Exception) {
-                Timber.e(e, "[NewZmqClient] 连接验证过程中发生异常")
-                updateConnectionState(ConnectionState.CONNECTION_FAILED)
-
-                // 清理资源
-                running.set(false)
-                cancelAllTasks()
-                cleanup()
-                result.complete(false)
-            }
+        // 会话结束时连接状态已经更新，下一轮 prepareIo 销毁套接字
+        if (checkLiveness(socket, generation) == SocketExit.REDIAL) {
+            redialPending = true
         }
     }
 
     /**
-     * 验证连接是否真的建立成功（已弃用，保留用于兼容）
+     * I/O循环异常或上下文终止（I/O线程）
      */
-    @Deprecated("使用异步验证替代")
-    private fun verifyConnection(): Boolean {
-        Timber.d("[NewZmqClient] 开始验证连接，发送测试心跳...")
-
-        try {
-            // 发送测试心跳
-            sendHeartbeat()
-
-            // 等待服务器响应
-            val startTime = System.currentTimeMillis()
-            while (System.currentTimeMillis() - startTime < CONNECTION_VERIFY_TIMEOUT_MS) {
-                if (serverConnected.get()) {
-                    Timber.d("[NewZmqClient] 连接验证成功，收到服务器响应")
-                    return true
-                }
-                Thread.sleep(100)
-            }
-
-            Timber.w("[NewZmqClient] 连接验证超时，未收到服务器响应")
-            return false
-
-        } catch (e: Exception) {
-            Timber.e(e, "[NewZmqClient] 连接验证过程中发生异常")
-            return false
+    internal fun onIoFailure() {
+        if (ioGeneration != NO_IO_SESSION) {
+            endSession(ioGeneration, ConnectionState.CONNECTION_FAILED)
         }
     }
 
     /**
-     * 清理资源
+     * I/O线程退出时销毁套接字
      */
-    private fun cleanup() {
-        try {
-            socket?.close()
-            zmqContext?.close()
-        } catch (e: Exception) {
-            Timber.w(e, "[NewZmqClient] 清理ZMQ资源时出现异常")
-        } finally {
-            socket = null
-            zmqContext = null
-            sendQueue.clear()
+    internal fun releaseIo(context: ZContext) {
+        if (ioGeneration != NO_IO_SESSION) {
+            endIoSession(context)
         }
     }
 
     /**
-     * 确保线程池可用
+     * 开始一次连接会话（I/O线程）
      */
-    private fun ensureExecutorService() {
-        val currentExecutor = executorService
-        if (currentExecutor == null || currentExecutor.isShutdown) {
-            executorService = Executors.newFixedThreadPool(3) { runnable ->
-                Thread(runnable).apply {
-                    isDaemon = true
-                    name = "ZMQ-Worker-${System.currentTimeMillis()}"
-                }
+    private fun beginIoSession(context: ZContext, endpoint: String, telemetryEndpoint: String?, generation: Int) {
+        resetConnectionState()
+        sessionStartNanos = System.nanoTime()
+        redialAttempt = 0
+        redialPending = false
+        ioGeneration = generation
+
+        // 遥测通道只承载可丢弃的最新值数据，创建失败时退回单通道，不影响指令链路
+        ioTelemetrySocket = telemetryEndpoint?.let {
+            try {
+                openTelemetrySocket(context, it)
+            } catch (e: Exception) {
+                Timber.e(e, "[NewZmqClient] 创建遥测socket失败: $it")
+                null
             }
-            Timber.d("[NewZmqClient] 创建新的线程池")
         }
+        openCommandSocket(context, generation)
     }
 
     /**
-     * 重置连接状态
+     * 创建指令套接字，失败时结束会话
      */
-    private fun resetConnectionState() {
-        consecutiveFailures.set(0)
-        lastHeartbeatTime.set(0)
-        lastServerHeartbeatTime.set(0) // 重置服务器心跳时间
-        serverConnected.set(false)
-        sendQueue.clear()
+    private fun openCommandSocket(context: ZContext, generation: Int) {
+        val endpoint = sessionEndpoint ?: return
+        ioSocket = try {
+            openSocket(context, endpoint)
+        } catch (e: Exception) {
+            Timber.e(e, "[NewZmqClient] 创建socket失败: $endpoint")
+            endSession(generation, ConnectionState.CONNECTION_FAILED)
+            null
+        }
     }
 
     /**
-     * 启动工作任务
+     * 结束当前套接字会话（I/O线程）：销毁套接字，清空发送通道，在途指令以连接断开结束
      */
-    private fun startWorkerTasks() {
-        try {
-            val executor =
-                executorService ?: throw IllegalStateException("ExecutorService 未初始化")
-
-            // 启动接收任务
-            receiveFuture.set(executor.submit { receiveTask() })
-
-            // 启动发送任务
-            sendFuture.set(executor.submit { sendTask() })
-
-            // 启动心跳任务
-            heartbeatFuture.set(executor.submit { heartbeatTask() })
+    private fun endIoSession(context: ZContext) {
+        ioSocket?.let { context.destroySocket(it) }
+        ioTelemetrySocket?.let { context.destroySocket(it) }
+        ioSocket = null
+        ioTelemetrySocket = null
+        socketIndex = -1
+        telemetryIndex = -1
+        redialPending = false
+        ioGeneration = NO_IO_SESSION
+        clearSendLanes()
+        commandTracker.failAll(CommandStatus.DISCONNECTED, System.nanoTime())
+    }
 
-            Timber.d("[NewZmqClient] 所有工作任务已启动")
-        } catch (e: Exception) {
-            Timber.e(e, "[NewZmqClient] 启动工作任务失败")
-            throw e
+    /**
+     * 创建并连接DEALER套接字
+     */
+    private fun openSocket(context: ZContext, endpoint: String): ZMQ.Socket {
+        val newSocket = context.createSocket(SocketType.DEALER).apply {
+            receiveTimeOut = SOCKET_RECV_TIMEOUT_MS
+            sendTimeOut = SOCKET_SEND_TIMEOUT_MS
+            linger = 0
+            // 只向已建立的连接排队，断链期间发送立即失败，恢复后不会冲出过期指令
+            setImmediate(true)
+            setReconnectIVL(ZMQ_RECONNECT_IVL_MS)
+            setReconnectIVLMax(ZMQ_RECONNECT_IVL_MAX_MS)
+            setHeartbeatIvl(ZMTP_HEARTBEAT_IVL_MS)
+            setHeartbeatTimeout(ZMTP_HEARTBEAT_TIMEOUT_MS)
         }
+        // ZMQ的connect是异步的，总是返回true
+        newSocket.connect(endpoint)
+        socketOpenedNanos = System.nanoTime()
+        Timber.i("[NewZmqClient] ZMQ socket已建立: $endpoint")
+        return newSocket
     }
 
     /**
-     * 取消所有任务
+     * 创建并连接遥测SUB套接字
+     * CONFLATE 只保留最新一帧，I/O线程忙时积压的旧样本直接被覆盖；
+     * CONFLATE 作用于整个套接字，对端应只在该端口发布可被新样本替代的周期性数据
      */
-    private fun cancelAllTasks() {
-        val futures = listOf(receiveFuture, sendFuture, heartbeatFuture)
-
-        futures.forEach { futureRef ->
-            futureRef.get()?.let { future ->
-                if (!future.isDone) {
-                    future.cancel(true)
-                }
-            }
-            futureRef.set(null)
+    private fun openTelemetrySocket(context: ZContext, endpoint: String): ZMQ.Socket {
+        val newSocket = context.createSocket(SocketType.SUB).apply {
+            linger = 0
+            // 必须在 connect 之前设置
+            setConflate(true)
+            setReconnectIVL(ZMQ_RECONNECT_IVL_MS)
+            setReconnectIVLMax(ZMQ_RECONNECT_IVL_MAX_MS)
+            subscribe(ZMQ.SUBSCRIPTION_ALL)
         }
+        newSocket.connect(endpoint)
+        Timber.i("[NewZmqClient] 遥测socket已建立: $endpoint")
+        return newSocket
     }
 
     /**
-     * 关闭线程池（仅在完全关闭客户端时调用）
+     * 结束会话并设置最终状态（仅当会话未被新的连接/断开请求替换时）
      */
-    private fun shutdownExecutorService() {
-        val executor = executorService ?: return
-
-        try {
-            executor.shutdown()
-            if (!executor.awaitTermination(THREAD_SHUTDOWN_TIMEOUT_MS, TimeUnit.MILLISECONDS)) {
-                Timber.w("[NewZmqClient] 执行器服务未能在规定时间内关闭，强制关闭")
-                executor.shutdownNow()
-            }
-        } catch (e: InterruptedException) {
-            Timber.w("[NewZmqClient] 等待执行器服务关闭时被中断")
-            executor.shutdownNow()
-            Thread.currentThread().interrupt()
-        } finally {
-            executorService = null
+    private fun endSession(generation: Int, finalState: ConnectionState) {
+        if (sessionGeneration.get() == generation && running.compareAndSet(true, false)) {
+            updateConnectionState(finalState)
         }
     }
 
     /**
-     * 接收任务
+     * 唤醒I/O线程
      */
-    private fun receiveTask() {
-        Timber.i("[NewZmqClient] 接收任务启动")
+    private fun wakeupIo() {
+        ioLoop?.wakeup()
+    }
 
-        try {
-            while (running.get() && !Thread.currentThread().isInterrupted) {
-                processReceiveOnce()
+    /**
+     * 重置连接状态（I/O线程，会话开始时）
+     */
+    private fun resetConnectionState() {
+        stopOnBackground.set(false)
+        consecutiveFailures.set(0)
+        lastHeartbeatTime.set(0)
+        liveness.reset(System.nanoTime())
+        lastOutboundNanos.set(0)
+        serverConnected.set(false)
+        linkFailureDetected = false
+        lastProbeNanos = 0L
+        lastStatsNanos = System.nanoTime()
+        linkStats.reset()
+        odometryBuffer.clear()
+        requestStateResync(System.nanoTime())
+        clearSendLanes()
+    }
 
-                // 短暂休眠避免CPU占用过高
-                Thread.sleep(10)
-            }
-        } catch (e: InterruptedException) {
-            Timber.i("[NewZmqClient] 接收任务被中断")
-        } catch (e: Exception) {
-            Timber.e(e, "[NewZmqClient] 接收任务异常退出")
-            handleTaskFailure("接收任务")
-        } finally {
-            Timber.i("[NewZmqClient] 接收任务结束")
+    /**
+     * 清空所有发送通道
+     */
+    private fun clearSendLanes() {
+        while (true) {
+            framePool.release(sendQueue.poll() ?: break)
         }
+        pendingReliableFrame?.let { framePool.release(it) }
+        pendingReliableFrame = null
+        latestVelocityFrame.getAndSet(null)?.let { framePool.release(it) }
     }
 
     /**
-     * 处理单次接收操作
+     * 处理单次接收操作（I/O线程）
+     * @return 是否读取到了一帧数据
      */
-    private fun processReceiveOnce() {
+    private fun processReceiveOnce(socket: ZMQ.Socket): Boolean {
         try {
-            val currentSocket = socket ?: return
-
-            val data = currentSocket.recv(ZMQ.NOBLOCK)
-            if (data != null) {
-                val message = MessageUtils.deserializeMessage(data)
-
-                if (MessageUtils.verifyMessage(message)) {
-                    processReceivedMessage(message)
-                    messageCallback?.invoke(message)
-
-                    // 重置失败计数
-                    consecutiveFailures.set(0)
-                } else {
-                    Timber.w("[NewZmqClient] CRC32校验失败")
-                }
+            val data = socket.recv(ZMQ.NOBLOCK) ?: return false
+            // 任何入站帧（包括校验失败的帧）都证明链路存活
+            val now = System.nanoTime()
+            liveness.onInbound(now)
+            flightRecorder?.record(FrameDirection.INBOUND, data, 0, data.size, now)
+
+            val valid = PerfTrace.section(TraceNames.ZMQ_RECEIVE) {
+                dispatchFrame(data)
             }
+            if (!valid) return true
+
+            // 重置失败计数
+            consecutiveFailures.set(0)
+            return true
 
         } catch (e: ZMQException) {
             if (e.errorCode != ZMQ.Error.EAGAIN.code) {
@@ -493,145 +631,329 @@ class NewZmqClient(
         } catch (e: Exception) {
             Timber.e(e, "[NewZmqClient] 消息处理异常")
             incrementFailureCount()
+            return true
         }
+        return false
     }
 
     /**
-     * 发送任务
+     * 校验并分发一帧：按消息类型交给订阅者，最后交给消息回调（I/O线程或回放线程）
+     * 先在原始字节上校验CRC32并读取消息类型，没有订阅者的帧不做完整解码
+     * @return 是否通过校验
      */
-    private fun sendTask() {
-        Timber.i("[NewZmqClient] 发送任务启动")
+    private fun dispatchFrame(data: ByteArray): Boolean {
+        if (!MessageUtils.verifyFrame(data)) {
+            HotLog.log(HotEvent.CRC_FAILED, data.size.toLong())
+            linkCounters.onDecodeFailure()
+            return false
+        }
+        val typeValue = MessageUtils.peekMessageType(data)
+        val type = MessageType.fromValue(typeValue)
+        if (type == null) {
+            linkCounters.onDecodeFailure()
+            return false
+        }
+        linkCounters.onReceived(type)
+        val callback = messageCallback
+        if (callback == null && !dispatcher.hasSubscribers(typeValue)) return true
+
+        val message = try {
+            MessageUtils.deserializeMessage(data)
+        } catch (e: Exception) {
+            Timber.w(e, "[NewZmqClient] 消息解码失败")
+            linkCounters.onDecodeFailure()
+            return false
+        }
+        dispatcher.dispatch(message)
+        callback?.invoke(message)
+        return true
+    }
 
+    /**
+     * 读取一帧遥测（I/O线程），遥测同样证明对端存活
+     * @return 是否读取到了一帧数据
+     */
+    private fun processTelemetryOnce(socket: ZMQ.Socket): Boolean {
         try {
-            while (running.get() && !Thread.currentThread().isInterrupted) {
-                processSendOnce()
+            val data = socket.recv(ZMQ.NOBLOCK) ?: return false
+            val now = System.nanoTime()
+            liveness.onInbound(now)
+            flightRecorder?.record(FrameDirection.INBOUND, data, 0, data.size, now)
+            PerfTrace.section(TraceNames.ZMQ_RECEIVE_TELEMETRY) {
+                dispatchFrame(data)
+            }
+            return true
+        } catch (e: ZMQException) {
+            if (e.errorCode != ZMQ.Error.EAGAIN.code) {
+                Timber.e(e, "[NewZmqClient] 遥测接收错误")
             }
-        } catch (e: InterruptedException) {
-            Timber.i("[NewZmqClient] 发送任务被中断")
         } catch (e: Exception) {
-            Timber.e(e, "[NewZmqClient] 发送任务异常退出")
-            handleTaskFailure("发送任务")
-        } finally {
-            Timber.i("[NewZmqClient] 发送任务结束")
+            Timber.e(e, "[NewZmqClient] 遥测消息处理异常")
+            return true
         }
+        return false
     }
 
     /**
-     * 处理单次发送操作
+     * 发送通道（I/O线程）
+     * 先按顺序发送可靠通道中的帧，再发送速度指令槽中的最新帧；
+     * 链路未连通时速度指令已经过期，直接丢弃
      */
-    private fun processSendOnce() {
+    private fun flushSendLanes(socket: ZMQ.Socket) {
+        val linkUp = connectionState.get() == ConnectionState.CONNECTED
         try {
-            val data = sendQueue.poll(100, TimeUnit.MILLISECONDS) ?: return
-            val currentSocket = socket ?: return
+            // 可靠通道：发送失败的帧保留在队首，下次优先重试
+            // send(bytes, offset, length, flags)会拷贝数据，发送后缓冲区可立即归还
+            while (true) {
+                val frame = pendingReliableFrame ?: sendQueue.poll() ?: break
+                if (!socket.send(frame.bytes, 0, frame.length, ZMQ.NOBLOCK)) {
+                    pendingReliableFrame = frame
+                    if (linkUp) incrementFailureCount()
+                    break
+                }
+                pendingReliableFrame = null
+                recordOutbound(frame.bytes, frame.length)
+                framePool.release(frame)
+                val sentNanos = System.nanoTime()
+                lastOutboundNanos.set(sentNanos)
+                // 模式指令期待回应（确认或状态广播）
+                liveness.onRequestSent(sentNanos)
+                consecutiveFailures.set(0)
+            }
 
-            if (currentSocket.send(data, ZMQ.NOBLOCK)) {
+            // 最新值通道：发送失败时只在没有更新的指令时放回，避免重放过期指令
+            // 链路未连通或会话已转入后台时速度指令直接丢弃
+            val velocityFrame = latestVelocityFrame.getAndSet(null) ?: return
+            if (!linkUp || !isForeground) {
+                framePool.release(velocityFrame)
+                linkCounters.onFrameDropped()
+                return
+            }
+            if (socket.send(velocityFrame.bytes, 0, velocityFrame.length, ZMQ.NOBLOCK)) {
+                recordOutbound(velocityFrame.bytes, velocityFrame.length)
+                framePool.release(velocityFrame)
+                lastOutboundNanos.set(System.nanoTime())
                 consecutiveFailures.set(0)
             } else {
-                // 发送失败，重新入队（如果队列未满）
-                if (!sendQueue.offer(data)) {
-                    Timber.w("[NewZmqClient] 发送队列已满，丢弃消息")
+                if (!latestVelocityFrame.compareAndSet(null, velocityFrame)) {
+                    framePool.release(velocityFrame)
+                    linkCounters.onFrameDropped()
                 }
                 incrementFailureCount()
             }
 
         } catch (e: ZMQException) {
             Timber.e(e, "[NewZmqClient] 发送消息失败")
-            incrementFailureCount()
-        } catch (e: InterruptedException) {
-            Thread.currentThread().interrupt()
-        } catch (e: Exception) {
-            Timber.e(e, "[NewZmqClient] 发送操作异常")
-            incrementFailureCount()
+            if (linkUp) incrementFailureCount()
         }
     }
 
     /**
-     * 心跳任务
+     * 记录已发送的帧（I/O线程）
+     */
+    private fun recordOutbound(bytes: ByteArray, length: Int) {
+        flightRecorder?.record(FrameDirection.OUTBOUND, bytes, 0, length, System.nanoTime())
+    }
+
+    /**
+     * 直接在I/O线程上发送一帧零速度指令（断链时调用，不经过发送通道）
      */
-    private fun heartbeatTask() {
-        Timber.i("[NewZmqClient] 心跳任务启动")
+    private fun sendStopFrameNow(socket: ZMQ.Socket) {
+        try {
+            hotPathEncoder.encodeVelocityCommand(controlFrame, MessageUtils.getCurrentTimestampMs(), 0f, 0f, 0f)
+            if (socket.send(controlFrame.bytes, 0, controlFrame.length, ZMQ.NOBLOCK)) {
+                recordOutbound(controlFrame.bytes, controlFrame.length)
+                Timber.i("[NewZmqClient] 已发送零速度停止指令")
+            } else {
+                Timber.w("[NewZmqClient] 零速度停止指令发送失败")
+            }
+        } catch (e: Exception) {
+            Timber.w(e, "[NewZmqClient] 发送零速度停止指令异常")
+        }
+    }
 
+    /**
+     * 直接在I/O线程上发送心跳，链路未连通时发送失败不计入失败次数
+     */
+    private fun sendHeartbeatNow(socket: ZMQ.Socket, now: Long) {
+        heartbeatFields.requestState = stateResyncPending.get()
+        linkStats.prepareHeartbeat(now, heartbeatFields)
+        hotPathEncoder.encodeHeartbeat(controlFrame, MessageUtils.getCurrentTimestampMs(), true, heartbeatFields)
         try {
-            while (running.get() && !Thread.currentThread().isInterrupted) {
-                sendHeartbeat()
+            if (socket.send(controlFrame.bytes, 0, controlFrame.length, ZMQ.NOBLOCK)) {
+                recordOutbound(controlFrame.bytes, controlFrame.length)
+                lastOutboundNanos.set(now)
+                liveness.onRequestSent(now)
                 lastHeartbeatTime.set(System.currentTimeMillis())
+            }
+        } catch (e: ZMQException) {
+            Timber.w(e, "[NewZmqClient] 发送心跳失败")
+        }
+    }
 
-                // 检查服务器心跳响应超时
-                // 只有在已连接状态下才检测超时
-                if (connectionState.get() == ConnectionState.CONNECTED) {
-                    val lastServerTime = lastServerHeartbeatTime.get()
-                    val currentTime = System.currentTimeMillis()
-
-                    // 如果上次收到服务器心跳的时间不为0（已经收到过心跳），且超时
-                    if (lastServerTime > 0 && (currentTime - lastServerTime) > HEARTBEAT_RESPONSE_TIMEOUT_MS) {
-                        Timber.w("[NewZmqClient] 服务器心跳响应超时，距离上次心跳已超过 ${HEARTBEAT_RESPONSE_TIMEOUT_MS}ms，判断连接丢失")
-                        handleConnectionLost()
-                        break
+    /**
+     * 链路保活和状态机（I/O线程，每次唤醒调用）
+     * - 连接中：按探测间隔发送心跳，收到服务器心跳即连接成功，超时则连接超时
+     * - 已连接：上行空闲时发送保活心跳；下行静默超出按帧间隔估计的阈值时探测一次，
+     *   请求未被回应时按较短间隔继续探测，未回应超过 探测间隔 + 基于往返时延的超时 后判断断链
+     * - 重连中：探测间隔指数退避，收到任意帧即恢复并同步状态，长时间无响应时重建套接字
+     * @return 需要结束当前套接字时返回原因，否则返回 null
+     */
+    private fun checkLiveness(socket: ZMQ.Socket, generation: Int): SocketExit? {
+        val now = System.nanoTime()
+
+        if (now - lastStatsNanos >= TimeUnit.MILLISECONDS.toNanos(LINK_STATS_PUBLISH_INTERVAL_MS)) {
+            lastStatsNanos = now
+            val stats = linkStats.snapshot()
+            liveness.updateLinkTimeout(stats)
+            linkStatsCallback?.invoke(stats)
+        }
+
+        if (stateResyncPending.get() && (now > stateResyncDeadlineNanos ||
+                    (modeSynced.get() && controlModeSynced.get()))) {
+            stateResyncPending.set(false)
+        }
+
+        when (connectionState.get()) {
+            ConnectionState.CONNECTING -> {
+                if (serverConnected.get()) {
+                    onLinkUp(now, generation, recovered = false)
+                } else if (now - sessionStartNanos > TimeUnit.MILLISECONDS.toNanos(CONNECTION_VERIFY_TIMEOUT_MS)) {
+                    Timber.w("[NewZmqClient] 连接验证超时，未收到服务器响应")
+                    endSession(generation, ConnectionState.CONNECTION_TIMEOUT)
+                    return SocketExit.SESSION_ENDED
+                } else if (now - lastProbeNanos >= TimeUnit.MILLISECONDS.toNanos(CONNECT_PROBE_INTERVAL_MS)) {
+                    lastProbeNanos = now
+                    sendHeartbeatNow(socket, now)
+                }
+            }
+
+            ConnectionState.CONNECTED -> {
+                // 上行空闲时发送保活心跳，有其他流量时不额外发送；下行静默超出预期或请求未被回应时探测
+                var sendNow = heartbeatRequested.getAndSet(false) ||
+                        now - lastOutboundNanos.get() >= TimeUnit.MILLISECONDS.toNanos(heartbeatIntervalMs) ||
+                        liveness.shouldProbe(now)
+                if (stateResyncPending.get() &&
+                    now - lastProbeNanos >= TimeUnit.MILLISECONDS.toNanos(LinkLiveness.PROBE_INTERVAL_MS)) {
+                    sendNow = true
+                }
+                if (sendNow) {
+                    lastProbeNanos = now
+                    sendHeartbeatNow(socket, now)
+                }
+
+                if (liveness.isLinkDead(now) || linkFailureDetected) {
+                    if (linkFailureDetected) {
+                        Timber.w("[NewZmqClient] 连续收发失败，判断连接丢失")
+                    } else {
+                        Timber.w("[NewZmqClient] 请求${TimeUnit.NANOSECONDS.toMillis(liveness.unansweredNanos(now))}ms未被回应，" +
+                                "超过阈值${TimeUnit.NANOSECONDS.toMillis(liveness.deadAfterNanos())}ms，判断连接丢失")
                     }
+                    return onLinkDead(socket, now, generation)
                 }
+            }
 
-                Thread.sleep(heartbeatIntervalMs)
+            ConnectionState.RECONNECTING -> {
+                if (liveness.lastInboundNanos > linkLostNanos) {
+                    onLinkUp(now, generation, recovered = true)
+                    return null
+                }
+                if (now - lastProbeNanos >= reconnectProbeIntervalNanos) {
+                    lastProbeNanos = now
+                    sendHeartbeatNow(socket, now)
+                    reconnectProbeIntervalNanos = minOf(
+                        reconnectProbeIntervalNanos * 2,
+                        TimeUnit.MILLISECONDS.toNanos(RECONNECT_PROBE_MAX_MS)
+                    )
+                }
+                if (now - linkLostNanos > TimeUnit.MILLISECONDS.toNanos(RECONNECT_GIVE_UP_MS)) {
+                    Timber.w("[NewZmqClient] 重连${RECONNECT_GIVE_UP_MS / 1000}秒仍未恢复，放弃重连")
+                    endSession(generation, ConnectionState.CONNECTION_FAILED)
+                    return SocketExit.SESSION_ENDED
+                }
+                val redialAfterMs = minOf(REDIAL_BASE_MS shl minOf(redialAttempt, 3), REDIAL_MAX_MS)
+                if (now - socketOpenedNanos > TimeUnit.MILLISECONDS.toNanos(redialAfterMs)) {
+                    return SocketExit.REDIAL
+                }
             }
-        } catch (e: InterruptedException) {
-            Timber.i("[NewZmqClient] 心跳任务被中断")
-        } catch (e: Exception) {
-            Timber.e(e, "[NewZmqClient] 心跳任务异常退出")
-            handleTaskFailure("心跳任务")
-        } finally {
-            Timber.i("[NewZmqClient] 心跳任务结束")
+
+            else -> {}
         }
+        return null
     }
 
     /**
-     * 处理接收错误
+     * 判断断链：补发零速度指令，开启自动重连时进入重连状态，否则结束会话
      */
-    private fun handleReceiveError(e: ZMQException) {
-        Timber.e(e, "[NewZmqClient] 接收错误")
-        incrementFailureCount()
+    private fun onLinkDead(socket: ZMQ.Socket, now: Long, generation: Int): SocketExit? {
+        sendStopFrameNow(socket)
+        linkFailureDetected = false
+        consecutiveFailures.set(0)
+        latestVelocityFrame.getAndSet(null)?.let { framePool.release(it) }
+
+        if (!autoReconnect) {
+            endSession(generation, ConnectionState.CONNECTION_FAILED)
+            return SocketExit.SESSION_ENDED
+        }
+        linkLostNanos = now
+        lastProbeNanos = 0L
+        reconnectProbeIntervalNanos = TimeUnit.MILLISECONDS.toNanos(RECONNECT_PROBE_MIN_MS)
+        redialAttempt = 0
+        socketOpenedNanos = now
+        if (isCurrent(generation)) {
+            updateConnectionState(ConnectionState.RECONNECTING)
+            Timber.i("[NewZmqClient] 链路中断，开始自动重连")
+        }
+        return null
     }
 
     /**
-     * 递增失败计数
+     * 链路连通：初次连接验证成功或重连恢复
+     * 恢复时丢弃中断前的速度指令并请求对端立即发送当前模式和控制模式
      */
-    private fun incrementFailureCount() {
-        val failures = consecutiveFailures.incrementAndGet()
-        if (failures >= MAX_CONSECUTIVE_FAILURES) {
-            Timber.e("[NewZmqClient] 连续失败${failures}次，判断连接丢失")
-            handleConnectionLost()
+    private fun onLinkUp(now: Long, generation: Int, recovered: Boolean) {
+        consecutiveFailures.set(0)
+        linkFailureDetected = false
+        if (recovered) {
+            latestVelocityFrame.getAndSet(null)?.let { framePool.release(it) }
+            requestStateResync(now)
+            lastProbeNanos = 0L
+            redialAttempt = 0
+            Timber.i("[NewZmqClient] 链路已恢复，中断${TimeUnit.NANOSECONDS.toMillis(now - linkLostNanos)}ms，同步机器人状态")
+        } else {
+            Timber.i("[NewZmqClient] 服务器连接验证成功")
+        }
+        if (isCurrent(generation)) {
+            updateConnectionState(ConnectionState.CONNECTED)
         }
     }
 
     /**
-     * 处理任务失败
+     * 在随后的心跳中请求对端发送当前状态，直到两种状态都收到或超时
      */
-    private fun handleTaskFailure(taskName: String) {
-        Timber.e("[NewZmqClient] $taskName 失败")
-        handleConnectionLost()
+    private fun requestStateResync(now: Long) {
+        modeSynced.set(false)
+        controlModeSynced.set(false)
+        stateResyncDeadlineNanos = now + TimeUnit.MILLISECONDS.toNanos(STATE_RESYNC_TIMEOUT_MS)
+        stateResyncPending.set(true)
     }
 
     /**
-     * 处理连接丢失
+     * 处理接收错误
      */
-    private fun handleConnectionLost() {
-        if (running.compareAndSet(true, false)) {
-            updateConnectionState(ConnectionState.CONNECTION_FAILED)
-        }
+    private fun handleReceiveError(e: ZMQException) {
+        Timber.e(e, "[NewZmqClient] 接收错误")
+        incrementFailureCount()
     }
 
     /**
-     * 处理接收到的消息
+     * 递增失败计数（I/O线程），达到上限时由保活检查按断链处理
      */
-    private fun processReceivedMessage(message: LeggedDriverMessage) {
-        when (message.message_type) {
-            MessageType.MESSAGE_TYPE_HEARTBEAT -> handleHeartbeatMessage(message)
-            MessageType.MESSAGE_TYPE_BATTERY_INFO -> handleBatteryInfoMessage(message)
-            MessageType.MESSAGE_TYPE_CURRENT_MODE -> handleCurrentModeMessage(message)
-            MessageType.MESSAGE_TYPE_CURRENT_CONTROL_MODE -> handleCurrentControlModeMessage(message)
-            MessageType.MESSAGE_TYPE_ODOMETRY -> handleOdometryMessage(message)
-            else -> {
-                // 其他消息类型暂不处理
-//                Timber.d("[NewZmqClient] 收到消息类型: ${message.message_type}")
-            }
+    private fun incrementFailureCount() {
+        val failures = consecutiveFailures.incrementAndGet()
+        if (failures >= MAX_CONSECUTIVE_FAILURES && !linkFailureDetected) {
+            Timber.e("[NewZmqClient] 连续失败${failures}次")
+            linkFailureDetected = true
         }
     }
 
@@ -641,9 +963,7 @@ class NewZmqClient(
     private fun handleHeartbeatMessage(message: LeggedDriverMessage) {
         message.heartbeat?.let { heartbeat ->
             serverConnected.set(heartbeat.is_connected)
-            // 记录收到服务器心跳的时间
-            lastServerHeartbeatTime.set(System.currentTimeMillis())
-//            Timber.d("[NewZmqClient] 收到服务器心跳，连接状态: ${heartbeat.is_connected}")
+            linkStats.onPeerHeartbeat(heartbeat, message.timestamp_ms, System.nanoTime(), System.currentTimeMillis())
         }
     }
 
@@ -653,7 +973,6 @@ class NewZmqClient(
     private fun handleBatteryInfoMessage(message: LeggedDriverMessage) {
         message.battery_info?.let { batteryInfo ->
             batteryLevel.set(batteryInfo.battery_level)
-//            Timber.d("[NewZmqClient] 收到电池信息，电量: ${batteryInfo.battery_level}%")
         }
     }
 
@@ -663,7 +982,8 @@ class NewZmqClient(
     private fun handleCurrentModeMessage(message: LeggedDriverMessage) {
         message.current_mode?.let { currentModeMsg ->
             currentMode.set(currentModeMsg.mode)
-//            Timber.d("[NewZmqClient] 收到当前模式: ${currentModeMsg.mode}")
+            modeSynced.set(true)
+            commandTracker.onStateReport(CommandKind.MODE, currentModeMsg.mode.value, System.nanoTime())
         }
     }
 
@@ -673,7 +993,25 @@ class NewZmqClient(
     private fun handleCurrentControlModeMessage(message: LeggedDriverMessage) {
         message.current_control_mode?.let { currentControlModeMsg ->
             currentControlMode.set(currentControlModeMsg.control_mode)
-//            Timber.d("[NewZmqClient] 收到当前控制模式: ${currentControlModeMsg.control_mode}")
+            controlModeSynced.set(true)
+            commandTracker.onStateReport(
+                CommandKind.CONTROL_MODE,
+                currentControlModeMsg.control_mode.value,
+                System.nanoTime()
+            )
+        }
+    }
+
+    /**
+     * 处理指令确认消息
+     */
+    private fun handleCommandAckMessage(message: LeggedDriverMessage) {
+        message.command_ack?.let { ack ->
+            if (!commandTracker.onAck(ack.request_id, ack.accepted, ack.reason, System.nanoTime())) {
+                HotLog.log(HotEvent.STALE_ACK, ack.request_id.toLong())
+            } else if (!ack.accepted) {
+                Timber.w("[NewZmqClient] 指令${ack.request_id}被拒绝: ${ack.reason}")
+            }
         }
     }
 
@@ -682,31 +1020,94 @@ class NewZmqClient(
      */
     private fun handleOdometryMessage(message: LeggedDriverMessage) {
         message.odometry?.let { odom ->
-//            Timber.d("[NewZmqClient] 收到里程计信息: pos(${odom.position?.x},${odom.position?.y},${odom.position?.z})")
+            val position = odom.position
+            val orientation = odom.orientation
+            val linear = odom.linear_velocity
+            val angular = odom.angular_velocity
+            val px = position?.x ?: 0f
+            val py = position?.y ?: 0f
+            val pz = position?.z ?: 0f
+            val qx = orientation?.x ?: 0f
+            val qy = orientation?.y ?: 0f
+            val qz = orientation?.z ?: 0f
+            val qw = orientation?.w ?: 1f
+            val vx = linear?.x ?: 0f
+            val vy = linear?.y ?: 0f
+            val wz = angular?.z ?: 0f
+
+            odometryBuffer.add(
+                System.nanoTime(),
+                px, py, pz,
+                qx, qy, qz, qw,
+                vx, vy, linear?.z ?: 0f,
+                angular?.x ?: 0f, angular?.y ?: 0f, wz
+            )
+            if (isForeground && TelemetryRecorder.isActive) {
+                TelemetryRecorder.recordOdometry(px, py, pz, qx, qy, qz, qw, vx, vy, wz)
+            }
         }
     }
 
     /**
-     * 发送消息
+     * 将已编码的指令帧放入可靠发送通道
+     */
+    private fun enqueueCommandFrame(bytes: ByteArray) {
+        val frame = framePool.acquire()
+        frame.set(bytes)
+        enqueueReliableFrame(frame)
+    }
+
+    /**
+     * 重发未确认的指令（I/O线程），链路未连通时本次不发送，但仍计入发送次数
+     */
+    private fun resendCommandFrame(bytes: ByteArray) {
+        if (connectionState.get() != ConnectionState.CONNECTED) return
+        HotLog.log(HotEvent.COMMAND_RESENT)
+        enqueueCommandFrame(bytes)
+    }
+
+    /**
+     * 提交需要确认的指令，同一目标已在途时复用其结果
      */
-    private fun sendMessage(message: LeggedDriverMessage) {
+    private fun submitCommand(
+        kind: CommandKind,
+        target: Int,
+        build: (requestId: Int) -> LeggedDriverMessage
+    ): CompletableFuture<CommandResult> {
         if (!running.get()) {
             Timber.w("[NewZmqClient] 客户端未运行，忽略消息发送")
-            return
+            return CompletableFuture.completedFuture(CommandResult(0, CommandStatus.DISCONNECTED))
         }
+        return commandTracker.submit(
+            kind,
+            target,
+            System.nanoTime(),
+            encode = { requestId -> MessageUtils.encodeFrame(build(requestId)) },
+            send = ::enqueueCommandFrame
+        )
+    }
 
-        try {
-            val data = MessageUtils.serializeMessage(message)
+    /**
+     * 将帧放入可靠发送通道
+     */
+    private fun enqueueReliableFrame(frame: FrameBuffer) {
+        if (!sendQueue.offer(frame)) {
+            framePool.release(frame)
+            Timber.w("[NewZmqClient] 可靠发送队列已满，丢弃消息")
+            return
+        }
+        wakeupIo()
+    }
 
-            // 尝试添加到发送队列
-            if (!sendQueue.offer(data)) {
-                Timber.w("[NewZmqClient] 发送队列已满，丢弃最旧的消息")
-                sendQueue.poll() // 移除最旧的消息
-                sendQueue.offer(data) // 重新尝试添加
-            }
-        } catch (e: Exception) {
-            Timber.e(e, "[NewZmqClient] 序列化消息失败")
+    /**
+     * 将帧放入速度指令槽，覆盖尚未发送的旧指令
+     */
+    private fun publishVelocityFrame(frame: FrameBuffer) {
+        latestVelocityFrame.getAndSet(frame)?.let {
+            framePool.release(it)
+            linkCounters.onFrameDropped()
         }
+        wakeupIo()
     }
 
     /**
@@ -730,12 +1131,61 @@ class NewZmqClient(
     fun getConsecutiveFailures(): Int = consecutiveFailures.get()
 
     /**
-     * 获取发送队列大小
+     * 获取链路质量统计快照
+     */
+    fun getLinkStats(): LinkStatsSnapshot = linkStats.snapshot()
+
+    /**
+     * 设置黑匣子记录器，收发的每一帧原始字节都会写入记录
+     */
+    fun setFlightRecorder(recorder: FlightRecorder?) {
+        flightRecorder = recorder
+    }
+
+    /**
+     * 回放一帧入站数据，与从套接字收到的帧走相同的校验和分发路径
+     * 只应在未连接时从单个回放线程调用
+     * @return 是否通过校验
+     */
+    fun replayInboundFrame(data: ByteArray): Boolean = dispatchFrame(data)
+
+    /**
+     * 获取链路收发计数（累计值）
+     */
+    fun getLinkCounters(): LinkCountersSnapshot = linkCounters.snapshot()
+
+    /**
+     * 获取里程计缓冲区，界面和记录按需查询最近的轨迹
+     */
+    fun getOdometryBuffer(): OdometryBuffer = odometryBuffer
+
+    /**
+     * 获取发送队列大小（可靠通道 + 待重试帧 + 速度指令槽）
+     */
+    fun getSendQueueSize(): Int {
+        var size = sendQueue.size
+        if (pendingReliableFrame != null) size++
+        if (latestVelocityFrame.get() != null) size++
+        return size
+    }
+
+    /**
+     * 订阅一种消息类型，回调按 [mode] 指定的线程投递
+     * MAIN_COALESCED 订阅应在主线程注册
      */
-    fun getSendQueueSize(): Int = sendQueue.size
+    fun subscribe(type: MessageType, mode: DeliveryMode, callback: MessageCallback): MessageSubscription =
+        dispatcher.subscribe(type, mode, callback)
+
+    /**
+     * 取消订阅
+     */
+    fun unsubscribe(subscription: MessageSubscription) {
+        dispatcher.unsubscribe(subscription)
+    }
 
     /**
-     * 设置消息回调
+     * 设置消息回调（在I/O线程中调用）
+     * 设置后所有通过校验的帧都会完整解码，仅用于测试和调试，业务逻辑请使用 [subscribe]
      */
     fun setMessageCallback(callback: MessageCallback?) {
         this.messageCallback = callback
@@ -749,45 +1199,65 @@ class NewZmqClient(
     }
 
     /**
-     * 发送心跳
+     * 设置链路统计回调，每秒在I/O线程中调用一次
+     */
+    fun setLinkStatsCallback(callback: LinkStatsCallback?) {
+        this.linkStatsCallback = callback
+    }
+
+    /**
+     * 请求I/O线程立即发送一次心跳
      */
     fun sendHeartbeat() {
-        val message = MessageUtils.createHeartbeatMessage(
-            deviceType, deviceId, true
-        )
-        sendMessage(message)
+        if (!running.get()) {
+            Timber.w("[NewZmqClient] 客户端未运行，忽略消息发送")
+            return
+        }
+        heartbeatRequested.set(true)
+        wakeupIo()
     }
 
     /**
      * 设置模式（只有遥控器端可调用）
+     * @return 对端确认、拒绝、超时或连接断开时完成
      */
-    fun setMode(mode: Mode): Boolean {
+    fun setMode(mode: Mode): CompletableFuture<CommandResult> {
         if (deviceType != DeviceType.DEVICE_TYPE_REMOTE_CONTROLLER) {
             Timber.w("[NewZmqClient] 只有遥控器客户端可以设置模式")
-            return false
+            return CompletableFuture.completedFuture(
+                CommandResult(0, CommandStatus.REJECTED, reason = "只有遥控器客户端可以设置模式")
+            )
         }
 
-        val message = MessageUtils.createModeSetMessage(deviceType, deviceId, mode)
-        sendMessage(message)
         Timber.i("[NewZmqClient] 发送模式设置: $mode")
-        return true
+        return submitCommand(CommandKind.MODE, mode.value) { requestId ->
+            MessageUtils.createModeSetMessage(deviceType, deviceId, mode, requestId)
+        }
     }
 
     /**
      * 设置控制模式（只有遥控器端可调用）
+     * @return 对端确认、拒绝、超时或连接断开时完成
      */
-    fun setControlMode(controlMode: ControlMode): Boolean {
+    fun setControlMode(controlMode: ControlMode): CompletableFuture<CommandResult> {
         if (deviceType != DeviceType.DEVICE_TYPE_REMOTE_CONTROLLER) {
             Timber.w("[NewZmqClient] 只有遥控器客户端可以设置控制模式")
-            return false
+            return CompletableFuture.completedFuture(
+                CommandResult(0, CommandStatus.REJECTED, reason = "只有遥控器客户端可以设置控制模式")
+            )
         }
 
-        val message = MessageUtils.createControlModeSetMessage(deviceType, deviceId, controlMode)
-        sendMessage(message)
         Timber.i("[NewZmqClient] 发送控制模式设置: $controlMode")
-        return true
+        return submitCommand(CommandKind.CONTROL_MODE, controlMode.value) { requestId ->
+            MessageUtils.createControlModeSetMessage(deviceType, deviceId, controlMode, requestId)
+        }
     }
 
+    /**
+     * 在途的待确认指令数
+     */
+    fun getPendingCommandCount(): Int = commandTracker.size
+
     /**
      * 发送速度指令
      */
@@ -796,15 +1266,23 @@ class NewZmqClient(
         val filteredVx = applyVxLimit(vx)
         val filteredVy = applyVyLimit(vy)
 
-        val message = MessageUtils.createVelocityCommandMessage(
-            deviceType,
-            deviceId,
+        if (!running.get()) {
+            Timber.w("[NewZmqClient] 客户端未运行，忽略消息发送")
+            return
+        }
+        if (!isForeground) return
+
+        // 直接编码到池化缓冲区，不创建Wire消息对象
+        val frame = framePool.acquire()
+        hotPathEncoder.encodeVelocityCommand(
+            frame,
+            MessageUtils.getCurrentTimestampMs(),
             filteredVx,
             filteredVy,
             yawRate
         )
-        sendMessage(message)
-        Timber.v("[NewZmqClient] 发送速度指令: vx=$filteredVx, vy=$filteredVy, yawRate=$yawRate")
+        publishVelocityFrame(frame)
+        TelemetryRecorder.recordVelocity(filteredVx, filteredVy, yawRate)
     }
 
     /**
@@ -847,12 +1325,28 @@ class NewZmqClient(
     fun getBatteryLevel(): Int = batteryLevel.get()
 
     /**
-     * 清理资源
+     * 切换前台/后台：后台会话只保持心跳，转入后台时补发一次零速度指令
+     */
+    fun setForeground(foreground: Boolean) {
+        if (isForeground == foreground) return
+        isForeground = foreground
+        if (!foreground) {
+            stopOnBackground.set(true)
+            wakeupIo()
+        }
+        Timber.d("[NewZmqClient] 会话转入${if (foreground) "前台" else "后台"}: $tcpEndpoint")
+    }
+
+    /**
+     * 清理资源：结束会话；独占的I/O循环一并关闭，共享的只移除本客户端
      */
     fun close() {
+        if (!closed.compareAndSet(false, true)) return
         disconnect()
 
-        // 关闭线程池
-        shutdownExecutorService()
+        ioLoop?.let { loop ->
+            if (ownsIoLoop) loop.close() else loop.release(this)
+        }
+        dispatcher.close()
     }
 }
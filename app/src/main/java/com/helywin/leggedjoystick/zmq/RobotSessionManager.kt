@@ -0,0 +1,111 @@
+/*********************************************************************************
+ * FileName: RobotSessionManager.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 多机器人会话管理：每个机器人一个 NewZmqClient，全部挂在同一个 ZmqIoLoop 上
+ * Others: 只有当前操控的会话在前台发送速度指令，其余会话在后台只保持心跳；
+ *         切换操控对象只是切换前台会话，不断开也不重新建立任何连接
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.zmq
+
+import com.helywin.leggedjoystick.data.RobotProfile
+import timber.log.Timber
+
+/**
+ * 一个机器人的连接会话
+ */
+class RobotSession internal constructor(
+    val robotId: String,
+    val client: NewZmqClient,
+    @Volatile var profile: RobotProfile
+)
+
+/**
+ * 机器人会话管理器，[sync] / [activate] / [close] 在主线程调用，[active] 可在任意线程读取
+ */
+class RobotSessionManager(
+    private val ioLoop: ZmqIoLoop = ZmqIoLoop()
+) {
+    // 按配置顺序保存的会话
+    private val sessions = LinkedHashMap<String, RobotSession>()
+
+    /**
+     * 当前操控的会话，首次 [sync] 之前为 null
+     */
+    @Volatile
+    var active: RobotSession? = null
+        private set
+
+    /**
+     * 全部会话，按配置顺序
+     */
+    val all: List<RobotSession>
+        get() = sessions.values.toList()
+
+    /**
+     * 按机器人配置增删会话，并把 [activeId] 对应的会话设为前台（找不到时使用第一个）
+     * 被移除的机器人会话直接关闭
+     * @return 新建的会话，调用方据此注册回调和订阅
+     */
+    fun sync(robots: List<RobotProfile>, activeId: String): List<RobotSession> {
+        val ids = robots.map { it.id }.toSet()
+        val removed = sessions.values.filter { it.robotId !in ids }
+        removed.forEach { session ->
+            sessions.remove(session.robotId)
+            if (active === session) active = null
+            session.client.close()
+            Timber.i("[RobotSessionManager] 移除机器人会话: ${session.profile.name}")
+        }
+
+        val created = mutableListOf<RobotSession>()
+        val ordered = LinkedHashMap<String, RobotSession>()
+        for (robot in robots) {
+            val session = sessions[robot.id]?.also { it.profile = robot } ?: RobotSession(
+                robot.id,
+                NewZmqClient(tcpEndpoint = robot.endpoint, ioLoop = ioLoop).apply { setForeground(false) },
+                robot
+            ).also {
+                created += it
+                Timber.i("[RobotSessionManager] 新建机器人会话: ${robot.name} ${robot.endpoint}")
+            }
+            ordered[robot.id] = session
+        }
+        sessions.clear()
+        sessions.putAll(ordered)
+
+        activate(if (activeId in sessions) activeId else robots.first().id)
+        return created
+    }
+
+    /**
+     * 切换前台会话：原会话转入后台（补发零速度指令），新会话开始接收速度指令
+     * @return 新的前台会话，找不到时返回 null
+     */
+    fun activate(robotId: String): RobotSession? {
+        val target = sessions[robotId] ?: return null
+        val previous = active
+        if (previous === target) return target
+        previous?.client?.setForeground(false)
+        target.client.setForeground(true)
+        active = target
+        Timber.i("[RobotSessionManager] 操控对象切换为: ${target.profile.name}")
+        return target
+    }
+
+    /**
+     * 按ID查找会话
+     */
+    fun session(robotId: String): RobotSession? = sessions[robotId]
+
+    /**
+     * 关闭全部会话和共享的I/O循环
+     */
+    fun close() {
+        sessions.values.forEach { it.client.close() }
+        sessions.clear()
+        active = null
+        ioLoop.close()
+    }
+}
@@ -0,0 +1,239 @@
+/*********************************************************************************
+ * FileName: ZmqIoLoop.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 共享的ZMQ I/O循环：一个 ZContext、一个唤醒通道和一个 poller 线程承载多个客户端会话
+ * Others: 所有客户端的套接字注册在同一个 poller 上，增加机器人不增加线程和上下文；
+ *         上下文和线程在首次连接时创建，套接字的创建、收发和销毁都只在该线程上进行
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.zmq
+
+import org.zeromq.ZContext
+import org.zeromq.ZMQ
+import timber.log.Timber
+import java.nio.ByteBuffer
+import java.nio.channels.Pipe
+import java.util.concurrent.atomic.AtomicBoolean
+
+/**
+ * I/O循环，[attach] / [release] / [wakeup] 可在任意线程调用
+ */
+class ZmqIoLoop(private val threadName: String = DEFAULT_THREAD_NAME) {
+    companion object {
+        const val DEFAULT_THREAD_NAME = "ZMQ-IO"
+        private const val IDLE_POLL_TIMEOUT_MS = 1000L // 没有会话时I/O线程的最长阻塞时间
+        private const val LIVENESS_CHECK_INTERVAL_MS = 10L // 有会话时poll的最长阻塞时间，同时是保活检查周期
+        private const val THREAD_SHUTDOWN_TIMEOUT_MS = 5000L
+    }
+
+    private val lock = Any()
+    private val closed = AtomicBoolean(false)
+
+    @Volatile
+    private var zmqContext: ZContext? = null
+
+    @Volatile
+    private var wakeupPipe: Pipe? = null
+
+    @Volatile
+    private var ioThread: Thread? = null
+
+    // 挂在循环上的客户端，写时复制，I/O线程无锁读取
+    @Volatile
+    private var clients: Array<NewZmqClient> = emptyArray()
+
+    // 客户端列表变化后需要重建 poller
+    private val clientsChanged = AtomicBoolean(true)
+
+    /**
+     * 挂载客户端，重复挂载忽略
+     */
+    internal fun attach(client: NewZmqClient) {
+        synchronized(lock) {
+            if (clients.any { it === client }) return
+            clients += client
+        }
+        clientsChanged.set(true)
+    }
+
+    /**
+     * 客户端关闭后调用：I/O线程未运行时直接移除，否则由I/O线程销毁套接字后移除
+     */
+    internal fun release(client: NewZmqClient) {
+        synchronized(lock) {
+            if (ioThread?.isAlive != true) {
+                clients = clients.filter { it !== client }.toTypedArray()
+            }
+        }
+        clientsChanged.set(true)
+        wakeup()
+    }
+
+    /**
+     * 确保上下文、唤醒通道和I/O线程可用（只在首次连接时创建）
+     */
+    internal fun start() {
+        synchronized(lock) {
+            if (closed.get()) return
+            if (zmqContext == null) {
+                zmqContext = ZContext()
+                wakeupPipe = createWakeupPipe()
+                Timber.d("[ZmqIoLoop] 创建ZMQ上下文")
+            }
+            if (ioThread?.isAlive != true) {
+                ioThread = Thread(::ioLoop, threadName).apply {
+                    isDaemon = true
+                    start()
+                }
+                Timber.d("[ZmqIoLoop] 启动I/O线程")
+            }
+        }
+    }
+
+    /**
+     * 唤醒I/O线程，通道已满时说明已有未处理的唤醒，直接忽略
+     */
+    fun wakeup() {
+        try {
+            wakeupPipe?.sink()?.write(ByteBuffer.wrap(byteArrayOf(0)))
+        } catch (e: Exception) {
+            Timber.w(e, "[ZmqIoLoop] 唤醒I/O线程失败")
+        }
+    }
+
+    /**
+     * 当前挂载的客户端数
+     */
+    val clientCount: Int
+        get() = clients.size
+
+    /**
+     * I/O线程主循环：每轮先让各客户端按连接请求开关套接字，再统一 poll 并逐个处理
+     */
+    private fun ioLoop() {
+        Timber.i("[ZmqIoLoop] I/O线程启动")
+        val context = zmqContext
+        val pipe = wakeupPipe
+        if (context == null || pipe == null) {
+            Timber.w("[ZmqIoLoop] 上下文未初始化，I/O线程退出")
+            return
+        }
+
+        var poller: ZMQ.Poller? = null
+        var wakeupIndex = -1
+        try {
+            while (!closed.get()) {
+                var socketsChanged = false
+                for (client in clients) {
+                    if (client.prepareIo(context)) socketsChanged = true
+                }
+                if (pruneClosedClients()) socketsChanged = true
+                if (clientsChanged.getAndSet(false)) socketsChanged = true
+
+                val current = clients
+                if (socketsChanged || poller == null) {
+                    poller?.close()
+                    poller = context.createPoller(1 + current.size * 2)
+                    wakeupIndex = poller.register(pipe.source(), ZMQ.Poller.POLLIN)
+                    current.forEach { it.registerIo(poller) }
+                }
+
+                val timeoutMs = if (current.any { it.hasIoSession }) LIVENESS_CHECK_INTERVAL_MS else IDLE_POLL_TIMEOUT_MS
+                if (poller.poll(timeoutMs) < 0) {
+                    // 上下文已终止
+                    current.forEach { it.onIoFailure() }
+                    break
+                }
+                if (poller.pollin(wakeupIndex)) {
+                    drainWakeupPipe(pipe)
+                }
+
+                for (client in current) {
+                    try {
+                        client.serviceIo(poller)
+                    } catch (e: Exception) {
+                        Timber.e(e, "[ZmqIoLoop] 套接字会话异常")
+                        client.onIoFailure()
+                    }
+                }
+            }
+        } catch (e: Exception) {
+            Timber.e(e, "[ZmqIoLoop] I/O线程异常退出")
+            clients.forEach { it.onIoFailure() }
+        } finally {
+            poller?.close()
+            clients.forEach { it.releaseIo(context) }
+            Timber.i("[ZmqIoLoop] I/O线程结束")
+        }
+    }
+
+    /**
+     * 移除已关闭且套接字已销毁的客户端（I/O线程）
+     * @return 是否有客户端被移除
+     */
+    private fun pruneClosedClients(): Boolean {
+        if (clients.none { it.isReleasable }) return false
+        synchronized(lock) {
+            clients = clients.filter { !it.isReleasable }.toTypedArray()
+        }
+        return true
+    }
+
+    /**
+     * 创建I/O线程唤醒通道（非阻塞，可注册到ZMQ.Poller）
+     */
+    private fun createWakeupPipe(): Pipe {
+        return Pipe.open().apply {
+            source().configureBlocking(false)
+            sink().configureBlocking(false)
+        }
+    }
+
+    /**
+     * 清空唤醒通道中的数据
+     */
+    private fun drainWakeupPipe(pipe: Pipe) {
+        val buffer = ByteBuffer.allocate(16)
+        while (pipe.source().read(buffer) > 0) {
+            buffer.clear()
+        }
+    }
+
+    /**
+     * 停止I/O线程并关闭上下文，所有客户端的会话随之结束
+     */
+    fun close() {
+        if (!closed.compareAndSet(false, true)) return
+        wakeup()
+
+        ioThread?.let { thread ->
+            if (thread === Thread.currentThread()) return@let
+            try {
+                thread.join(THREAD_SHUTDOWN_TIMEOUT_MS)
+                if (thread.isAlive) {
+                    Timber.w("[ZmqIoLoop] I/O线程未能在规定时间内结束")
+                }
+            } catch (e: InterruptedException) {
+                Timber.w("[ZmqIoLoop] 等待I/O线程结束时被中断")
+                Thread.currentThread().interrupt()
+            }
+        }
+        ioThread = null
+
+        try {
+            wakeupPipe?.let { pipe ->
+                pipe.sink().close()
+                pipe.source().close()
+            }
+            zmqContext?.close()
+        } catch (e: Exception) {
+            Timber.w(e, "[ZmqIoLoop] 清理ZMQ资源时出现异常")
+        } finally {
+            wakeupPipe = null
+            zmqContext = null
+            clients = emptyArray()
+        }
+    }
+}
@@ -0,0 +1,77 @@
+package com.helywin.leggedjoystick.controller
+
+import com.helywin.leggedjoystick.data.SpeedLevel
+import org.junit.Assert.*
+import org.junit.Test
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicReference
+
+/**
+ * 控制输入快照测试：变更标志和并发写入下读取的一致性
+ */
+class ControlInputSnapshotTest {
+
+    @Test
+    fun read_reportsChangeOnlyForNewWrites() {
+        val snapshot = ControlInputSnapshot()
+        val frame = ControlInputFrame()
+        assertFalse(snapshot.read(frame))
+
+        snapshot.updateLeftStick(0.5f, -0.25f)
+        snapshot.updateButton(ControlInputSnapshot.BUTTON_A, true)
+        snapshot.updateSpeedLevel(SpeedLevel.FAST)
+        assertTrue(snapshot.read(frame))
+        assertFalse(snapshot.read(frame))
+
+        assertEquals(3L, frame.sequence)
+        assertEquals(0.5f, frame.leftX, 0f)
+        assertEquals(-0.25f, frame.leftY, 0f)
+        assertTrue(frame.isButtonPressed(ControlInputSnapshot.BUTTON_A))
+        assertEquals(SpeedLevel.FAST, frame.speedLevel)
+
+        snapshot.reset()
+        assertTrue(snapshot.read(frame))
+        assertTrue(frame.isLeftCenter)
+        assertEquals(0, frame.buttons)
+        // 速度档位不随摇杆复位
+        assertEquals(SpeedLevel.FAST, frame.speedLevel)
+    }
+
+    @Test
+    fun concurrentWriter_readerNeverSeesTornFrame() {
+        val snapshot = ControlInputSnapshot()
+        val writes = 200_000
+        val writer = Thread {
+            for (i in 1..writes) {
+                val v = i.toFloat()
+                snapshot.updateSticks(v, -v, 2 * v, -2 * v, sampleTimeNanos = i.toLong(), samples = i)
+            }
+        }
+        val failure = AtomicReference<String?>(null)
+        val reader = Thread {
+            val frame = ControlInputFrame()
+            var lastSequence = 0L
+            while (frame.sequence < writes && failure.get() == null) {
+                snapshot.read(frame)
+                // 同一次写入的所有字段必须一起可见，序号只增不减
+                val v = frame.leftX
+                if (frame.leftY != -v || frame.rightX != 2 * v || frame.rightY != -2 * v ||
+                    frame.stickTimeNanos != v.toLong() || frame.stickSamples != v.toInt() ||
+                    frame.sequence != v.toLong() || frame.sequence < lastSequence
+                ) {
+                    failure.set("seq=${frame.sequence} left=(${frame.leftX}, ${frame.leftY}) " +
+                        "right=(${frame.rightX}, ${frame.rightY}) t=${frame.stickTimeNanos}")
+                }
+                lastSequence = frame.sequence
+            }
+        }
+        reader.start()
+        writer.start()
+        writer.join(TimeUnit.SECONDS.toMillis(10))
+        reader.join(TimeUnit.SECONDS.toMillis(10))
+
+        assertFalse(reader.isAlive)
+        assertNull(failure.get())
+        assertEquals(writes.toLong(), snapshot.currentSequence)
+    }
+}
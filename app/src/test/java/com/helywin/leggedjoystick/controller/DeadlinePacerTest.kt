@@ -0,0 +1,57 @@
+package com.helywin.leggedjoystick.controller
+
+import org.junit.Assert.*
+import org.junit.Test
+import java.util.concurrent.TimeUnit
+
+/**
+ * 控制循环截止时间推进测试：固定步长、超时计数和跳过错过的周期
+ */
+class DeadlinePacerTest {
+
+    private fun ms(value: Long) = TimeUnit.MILLISECONDS.toNanos(value)
+
+    @Test
+    fun onTime_advancesByOnePeriodWithoutDrift() {
+        val pacer = DeadlinePacer(periodNanos = ms(10), startNanos = 0)
+        repeat(100) { i ->
+            // 每个周期晚醒 1ms、执行 2ms，截止时间仍按周期对齐
+            pacer.onTickDone(startNanos = ms(i * 10L + 1), workNanos = ms(2))
+        }
+        assertEquals(ms(1000), pacer.deadlineNanos)
+        assertEquals(0L, pacer.overruns)
+        assertEquals(0L, pacer.missedDeadlines)
+    }
+
+    @Test
+    fun longTick_countsOverrunAndSkipsMissedDeadlines() {
+        val pacer = DeadlinePacer(periodNanos = ms(10), startNanos = 0)
+        pacer.onTickDone(startNanos = 0, workNanos = ms(2))
+        assertEquals(ms(10), pacer.deadlineNanos)
+
+        // 执行到 35ms：20ms、30ms 两个截止时间已错过，下一个截止时间为 40ms
+        pacer.onTickDone(startNanos = ms(10), workNanos = ms(25))
+        assertEquals(1L, pacer.overruns)
+        assertEquals(2L, pacer.missedDeadlines)
+        assertEquals(ms(40), pacer.deadlineNanos)
+
+        // 未超过一个周期、但晚醒导致结束时恰好到达下一个截止时间，也算错过
+        pacer.onTickDone(startNanos = ms(45), workNanos = ms(5))
+        assertEquals(1L, pacer.overruns)
+        assertEquals(3L, pacer.missedDeadlines)
+        assertEquals(ms(60), pacer.deadlineNanos)
+    }
+
+    @Test
+    fun restart_rebasesDeadlineAndKeepsCounters() {
+        val pacer = DeadlinePacer(periodNanos = ms(50), startNanos = 0)
+        pacer.onTickDone(startNanos = 0, workNanos = ms(120))
+        assertEquals(1L, pacer.overruns)
+
+        pacer.restart(newPeriodNanos = ms(10), nowNanos = ms(123))
+        assertEquals(ms(123), pacer.deadlineNanos)
+        pacer.onTickDone(startNanos = ms(123), workNanos = ms(1))
+        assertEquals(ms(133), pacer.deadlineNanos)
+        assertEquals(1L, pacer.overruns)
+    }
+}
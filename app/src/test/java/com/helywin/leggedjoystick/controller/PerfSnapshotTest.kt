@@ -0,0 +1,60 @@
+package com.helywin.leggedjoystick.controller
+
+import com.helywin.leggedjoystick.metrics.LatencyGauge
+import com.helywin.leggedjoystick.zmq.LinkCountersSnapshot
+import legged_driver.MessageType
+import org.junit.Assert.*
+import org.junit.Test
+
+/**
+ * 性能采样速率和时延计量测试
+ */
+class PerfSnapshotTest {
+
+    private fun counters(odometry: Long, decodeFailures: Long = 0, dropped: Long = 0): LinkCountersSnapshot {
+        val received = LongArray(MessageType.entries.size)
+        received[MessageType.MESSAGE_TYPE_ODOMETRY.ordinal] = odometry
+        return LinkCountersSnapshot(received, decodeFailures, dropped)
+    }
+
+    @Test
+    fun ratesSince_usesCounterDeltasOverElapsedTime() {
+        val first = PerfSnapshot(timeNanos = 0, linkCounters = counters(100), gcCount = 3)
+        val second = PerfSnapshot(
+            timeNanos = 500_000_000,
+            linkCounters = counters(150, decodeFailures = 2, dropped = 1),
+            gcCount = 4
+        )
+
+        val rates = second.ratesSince(first)
+
+        assertEquals(100f, rates.receiveHz(MessageType.MESSAGE_TYPE_ODOMETRY), 0.01f)
+        assertEquals(0f, rates.receiveHz(MessageType.MESSAGE_TYPE_HEARTBEAT), 0f)
+        assertEquals(2, rates.decodeFailures)
+        assertEquals(1, rates.droppedFrames)
+        assertEquals(1, rates.gcCount)
+    }
+
+    @Test
+    fun ratesSince_firstSampleIsZero() {
+        val rates = PerfSnapshot(timeNanos = 1, linkCounters = counters(100)).ratesSince(null)
+        assertEquals(0f, rates.receiveHz(MessageType.MESSAGE_TYPE_ODOMETRY), 0f)
+    }
+
+    @Test
+    fun latencyGauge_drainStartsNewWindow() {
+        val gauge = LatencyGauge()
+        gauge.record(100)
+        gauge.record(300)
+
+        val summary = gauge.drain()
+        assertEquals(2, summary.samples)
+        assertEquals(200, summary.meanUs)
+        assertEquals(300, summary.maxUs)
+        assertEquals(300, summary.lastUs)
+
+        val empty = gauge.drain()
+        assertEquals(0, empty.samples)
+        assertEquals(0, empty.maxUs)
+    }
+}
@@ -0,0 +1,85 @@
+package com.helywin.leggedjoystick.input
+
+import org.junit.Assert.*
+import org.junit.Test
+import kotlin.math.exp
+
+/**
+ * 摇杆滤波测试：死区缩放、回中立即归零和按样本时间间隔的低通
+ */
+class StickFilterTest {
+
+    private val ms = 1_000_000L
+
+    private fun sample(leftX: Float, leftY: Float = 0f, rightX: Float = 0f, rightY: Float = 0f) =
+        floatArrayOf(leftX, leftY, rightX, rightY)
+
+    // 死区外的幅值重新缩放到 [0, 1]
+    private fun rescaled(value: Float) =
+        (value - StickFilter.DEADZONE_THRESHOLD) / (1f - StickFilter.DEADZONE_THRESHOLD)
+
+    @Test
+    fun firstSample_passesThroughWithDeadzoneRescale() {
+        val filter = StickFilter()
+        filter.add(sample(0.5f, rightY = -1f), 10 * ms)
+
+        assertEquals(rescaled(0.5f), filter.axes[0], 1e-6f)
+        assertEquals(0f, filter.axes[1], 0f)
+        assertEquals(-1f, filter.axes[3], 1e-6f)
+        assertEquals(10 * ms, filter.lastSampleTimeNanos)
+    }
+
+    @Test
+    fun smallAxisOnDeflectedStick_isZeroed() {
+        val filter = StickFilter()
+        filter.add(sample(0.05f, 0.9f), 10 * ms)
+
+        assertEquals(0f, filter.axes[0], 0f)
+        assertTrue(filter.axes[1] > 0.8f)
+    }
+
+    @Test
+    fun step_followsTimeConstant_andReturnsToCenterImmediately() {
+        val filter = StickFilter()
+        filter.add(sample(0.5f), 10 * ms)
+        val start = filter.axes[0]
+
+        // 一个时间常数后完成 1 - 1/e
+        val dt = StickFilter.TIME_CONSTANT_NS.toLong()
+        filter.add(sample(1f), 10 * ms + dt)
+        val expected = start + (1f - start) * (1f - exp(-1f))
+        assertEquals(expected, filter.axes[0], 1e-5f)
+
+        // 回到死区内不经过滤波
+        filter.add(sample(0.02f), 11 * ms + dt)
+        assertEquals(0f, filter.axes[0], 0f)
+    }
+
+    @Test
+    fun batchedSamples_matchSingleSampleOverSameInterval() {
+        val single = StickFilter()
+        val batched = StickFilter()
+        single.add(sample(0.3f), 10 * ms)
+        batched.add(sample(0.3f), 10 * ms)
+
+        single.add(sample(0.9f), 18 * ms)
+        for (t in 11..18) batched.add(sample(0.9f), t * ms)
+
+        // 平滑系数只取决于样本时间间隔，与一次事件中合并了多少样本无关
+        assertEquals(single.axes[0], batched.axes[0], 1e-5f)
+    }
+
+    @Test
+    fun nonIncreasingTime_andReset_takeSampleAsIs() {
+        val filter = StickFilter()
+        filter.add(sample(0.5f), 20 * ms)
+        filter.add(sample(1f), 20 * ms)
+        assertEquals(1f, filter.axes[0], 1e-6f)
+
+        filter.reset()
+        assertEquals(0L, filter.lastSampleTimeNanos)
+        assertEquals(0f, filter.axes[0], 0f)
+        filter.add(sample(1f, rightX = 1f), 30 * ms)
+        assertEquals(1f, filter.axes[2], 1e-6f)
+    }
+}
@@ -0,0 +1,40 @@
+package com.helywin.leggedjoystick.log
+
+import android.util.Log
+import org.junit.Assert.*
+import org.junit.Rule
+import org.junit.Test
+import org.junit.rules.TemporaryFolder
+
+/**
+ * 热路径日志测试
+ */
+class HotLogTest {
+
+    @get:Rule
+    val folder = TemporaryFolder()
+
+    @Test
+    fun dump_containsFormattedRecentEvents() {
+        HotLog.minPriority = Log.VERBOSE
+        HotLog.start(folder.root)
+
+        HotLog.log(HotEvent.BATTERY_RECEIVED, 87)
+        HotLog.log(HotEvent.VELOCITY_SENT, HotLog.bits(0.5f), HotLog.bits(-0.25f), HotLog.bits(0f))
+
+        val text = HotLog.dump("test")!!.readText()
+        assertTrue(text.contains("[Controller] 收到电池信息，电量: 87%"))
+        assertTrue(text.contains("vx=0.5, vy=-0.25, yaw_rate=0.0"))
+    }
+
+    @Test
+    fun log_belowMinPriorityIsNotRecorded() {
+        HotLog.minPriority = Log.DEBUG
+        HotLog.start(folder.root)
+
+        HotLog.log(HotEvent.STOP_SENT)
+
+        val text = HotLog.dump("filtered")!!.readText()
+        assertFalse(text.contains("发送停止指令"))
+    }
+}
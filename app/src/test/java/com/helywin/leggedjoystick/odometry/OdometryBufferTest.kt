@@ -0,0 +1,94 @@
+package com.helywin.leggedjoystick.odometry
+
+import kotlinx.coroutines.CoroutineStart
+import kotlinx.coroutines.async
+import kotlinx.coroutines.runBlocking
+import kotlinx.coroutines.withTimeout
+import org.junit.Assert.*
+import org.junit.Test
+
+/**
+ * 里程计环形缓冲区测试
+ */
+class OdometryBufferTest {
+
+    private fun OdometryBuffer.addPosition(timeNanos: Long, x: Float, y: Float) =
+        add(timeNanos, x, y, 0f, 0f, 0f, 0f, 1f, 0f, 0f, 0f, 0f, 0f, 0f)
+
+    @Test
+    fun latest_returnsNewestAfterWrap() {
+        val buffer = OdometryBuffer(capacity = 4)
+        val sample = OdometrySample()
+        assertFalse(buffer.latest(sample))
+
+        for (i in 1..10) buffer.addPosition(i * 10L, i.toFloat(), -i.toFloat())
+
+        assertTrue(buffer.latest(sample))
+        assertEquals(100L, sample.timeNanos)
+        assertEquals(10f, sample.x, 0f)
+        assertEquals(-10f, sample.y, 0f)
+        assertEquals(4, buffer.size)
+        assertEquals(10L, buffer.writeCount)
+    }
+
+    @Test
+    fun copyTrajectory_returnsWindowOldestFirst() {
+        val buffer = OdometryBuffer(capacity = 8)
+        for (i in 1..12) buffer.addPosition(i * 10L, i.toFloat(), 0f)
+
+        val window = TrajectoryWindow(capacity = 8)
+        assertEquals(3, buffer.copyTrajectory(sinceNanos = 100L, out = window))
+        assertArrayEquals(floatArrayOf(10f, 11f, 12f), window.x.copyOf(window.size), 0f)
+
+        // 窗口容量小于样本数时保留最新的
+        val small = TrajectoryWindow(capacity = 2)
+        assertEquals(2, buffer.copyTrajectory(sinceNanos = 0L, out = small))
+        assertArrayEquals(longArrayOf(110L, 120L), small.timeNanos.copyOf(small.size))
+
+        assertEquals(3, buffer.countSince(100L))
+        assertEquals(8, buffer.countSince(0L))
+    }
+
+    @Test
+    fun copyNewer_readsOnlyUnseenSamples() {
+        val buffer = OdometryBuffer(capacity = 8)
+        val window = TrajectoryWindow(capacity = 8)
+        for (i in 1..3) buffer.addPosition(i * 10L, i.toFloat(), 0f)
+
+        var seen = buffer.copyNewer(0L, window)
+        assertEquals(3L, seen)
+        assertEquals(3, window.size)
+
+        buffer.addPosition(40L, 4f, 0f)
+        seen = buffer.copyNewer(seen, window)
+        assertEquals(1, window.size)
+        assertEquals(4f, window.x[0], 0f)
+
+        // 清空后写入次数回退，返回值小于上次的值
+        buffer.clear()
+        buffer.addPosition(50L, 5f, 0f)
+        assertTrue(buffer.copyNewer(seen, window) < seen)
+        assertEquals(5f, window.x[0], 0f)
+    }
+
+    @Test
+    fun awaitWrite_suspendsUntilNextSample() = runBlocking {
+        val buffer = OdometryBuffer(capacity = 8)
+        buffer.addPosition(10L, 1f, 0f)
+        // 已有未读样本时立即返回
+        withTimeout(1000) { buffer.awaitWrite(0L) }
+
+        // 立即执行到挂起点
+        val waiting = async(start = CoroutineStart.UNDISPATCHED) { buffer.awaitWrite(1L) }
+        assertFalse(waiting.isCompleted)
+        buffer.addPosition(20L, 2f, 0f)
+        withTimeout(1000) { waiting.await() }
+    }
+
+    @Test
+    fun yawOf_quarterTurn() {
+        val half = Math.sqrt(0.5).toFloat()
+        assertEquals(Math.PI.toFloat() / 2, OdometryBuffer.yawOf(0f, 0f, half, half), 1e-5f)
+        assertEquals(0f, OdometryBuffer.yawOf(0f, 0f, 0f, 1f), 0f)
+    }
+}
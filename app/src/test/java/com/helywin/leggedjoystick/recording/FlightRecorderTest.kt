@@ -0,0 +1,110 @@
+package com.helywin.leggedjoystick.recording
+
+import com.helywin.leggedjoystick.proto.MessageUtils
+import com.helywin.leggedjoystick.zmq.FlightReplayer
+import com.helywin.leggedjoystick.zmq.NewZmqClient
+import legged_driver.BatteryInfoMessage
+import legged_driver.DeviceType
+import legged_driver.MessageType
+import org.junit.Assert.*
+import org.junit.Rule
+import org.junit.Test
+import org.junit.rules.TemporaryFolder
+import java.util.concurrent.Executor
+
+/**
+ * 黑匣子记录和回放测试
+ */
+class FlightRecorderTest {
+
+    @get:Rule
+    val folder = TemporaryFolder()
+
+    // 测试中同步执行文件操作，结果与后台线程执行完毕后相同
+    private val directExecutor = Executor { it.run() }
+
+    private fun batteryFrame(level: Int): ByteArray = MessageUtils.encodeFrame(
+        MessageUtils.createMessage(
+            0L, DeviceType.DEVICE_TYPE_SERVER, "robot", MessageType.MESSAGE_TYPE_BATTERY_INFO,
+            batteryInfo = BatteryInfoMessage(battery_level = level)
+        )
+    )
+
+    @Test
+    fun record_rollsSegmentsAndReadsBackInOrder() {
+        val recorder = FlightRecorder(folder.root, segmentBytes = 1024, maxSegments = 64, fileExecutor = directExecutor)
+        val session = recorder.startSession()
+        for (i in 1..100) {
+            val frame = batteryFrame(i)
+            val direction = if (i % 2 == 0) FrameDirection.OUTBOUND else FrameDirection.INBOUND
+            recorder.record(direction, frame, 0, frame.size, i * 1000L)
+        }
+        recorder.stopSession()
+
+        assertTrue(session.listFiles()!!.size > 1)
+        val frames = FlightRecordReader.readSession(session)
+        assertEquals(100, frames.size)
+        assertEquals(1000L, frames.first().timeNanos)
+        assertEquals(FrameDirection.OUTBOUND, frames[1].direction)
+        assertArrayEquals(batteryFrame(100), frames.last().bytes)
+    }
+
+    @Test
+    fun record_prunesOldestSegments() {
+        val recorder = FlightRecorder(folder.root, segmentBytes = 256, maxSegments = 3, fileExecutor = directExecutor)
+        val session = recorder.startSession()
+        val frame = batteryFrame(50)
+        repeat(100) { recorder.record(FrameDirection.INBOUND, frame, 0, frame.size, it.toLong()) }
+        recorder.stopSession()
+
+        assertEquals(3, session.listFiles()!!.size)
+    }
+
+    @Test
+    fun record_dropsFramesUntilSegmentIsReady() {
+        val pending = ArrayDeque<Runnable>()
+        val recorder = FlightRecorder(folder.root, segmentBytes = 256, maxSegments = 64, fileExecutor = { pending.add(it) })
+        val session = recorder.startSession()
+        val frame = batteryFrame(50)
+
+        // 首个分段还没在后台创建，记录不阻塞，直接丢弃并计数
+        recorder.record(FrameDirection.INBOUND, frame, 0, frame.size, 1L)
+        assertEquals(1, recorder.droppedFrameCount)
+        assertTrue(session.listFiles()!!.isEmpty())
+
+        while (pending.isNotEmpty()) pending.removeFirst().run()
+        recorder.record(FrameDirection.INBOUND, frame, 0, frame.size, 2L)
+        recorder.stopSession()
+        while (pending.isNotEmpty()) pending.removeFirst().run()
+
+        assertEquals(1, recorder.droppedFrameCount)
+        val frames = FlightRecordReader.readSession(session)
+        assertEquals(listOf(2L), frames.map { it.timeNanos })
+    }
+
+    @Test
+    fun replay_dispatchesInboundFramesThroughClient() {
+        val recorder = FlightRecorder(folder.root, fileExecutor = directExecutor)
+        val session = recorder.startSession()
+        for (i in 1..50) {
+            val frame = batteryFrame(i)
+            recorder.record(FrameDirection.INBOUND, frame, 0, frame.size, i * 1_000_000L)
+        }
+        val outbound = batteryFrame(0)
+        recorder.record(FrameDirection.OUTBOUND, outbound, 0, outbound.size, 51_000_000L)
+        recorder.stopSession()
+
+        val client = NewZmqClient()
+        var delivered = 0
+        client.setMessageCallback { delivered++ }
+        val report = FlightReplayer(client).run(FlightRecordReader.readSession(session), speed = 0.0)
+        println("replay: ${report.inboundFrames} frames, ${report.dispatchNanosPerFrame} ns/frame")
+
+        assertEquals(50, report.inboundFrames)
+        assertEquals(1, report.outboundFrames)
+        assertEquals(0, report.invalidFrames)
+        assertEquals(50, delivered)
+        assertEquals(50, client.getBatteryLevel())
+        client.close()
+    }
+}
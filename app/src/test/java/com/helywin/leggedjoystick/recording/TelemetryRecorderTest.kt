@@ -0,0 +1,74 @@
+package com.helywin.leggedjoystick.recording
+
+import com.helywin.leggedjoystick.zmq.DeliveryMode
+import com.helywin.leggedjoystick.zmq.NewZmqClient
+import com.helywin.leggedjoystick.zmq.RobotSimulator
+import com.helywin.leggedjoystick.zmq.SimulatorConfig
+import legged_driver.MessageType
+import org.junit.After
+import org.junit.Assert.*
+import org.junit.Before
+import org.junit.Rule
+import org.junit.Test
+import org.junit.rules.TemporaryFolder
+import java.io.File
+import java.util.concurrent.CountDownLatch
+import java.util.concurrent.TimeUnit
+
+/**
+ * 遥测记录测试：只有前台会话的里程计写入遥测文件
+ */
+class TelemetryRecorderTest {
+
+    @get:Rule
+    val folder = TemporaryFolder()
+
+    private lateinit var savedClock: () -> Long
+
+    @Before
+    fun setUp() {
+        // JVM单元测试中没有 SystemClock
+        savedClock = TelemetryRecorder.clock
+        TelemetryRecorder.clock = System::nanoTime
+    }
+
+    @After
+    fun tearDown() {
+        TelemetryRecorder.stop()
+        TelemetryRecorder.clock = savedClock
+    }
+
+    @Volatile
+    private var odometryArrived = CountDownLatch(0)
+
+    /**
+     * 录制到客户端又收到 [frames] 帧里程计为止，返回文件中的里程计记录数
+     * 客户端内部的里程计处理先于测试的订阅执行，计数到达时这些帧已经过记录判断
+     */
+    private fun recordUntilOdometry(file: File, frames: Int): Int {
+        TelemetryRecorder.start(file)
+        val latch = CountDownLatch(frames)
+        odometryArrived = latch
+        assertTrue(latch.await(3, TimeUnit.SECONDS))
+        TelemetryRecorder.stop()
+        return file.readLines().drop(1).count { it.split(',')[2] == "odom" }
+    }
+
+    @Test
+    fun onlyForegroundOdometry_reachesRecorder() {
+        RobotSimulator(SimulatorConfig(odometryHz = 200.0)).use { simulator ->
+            simulator.start()
+            val client = NewZmqClient(tcpEndpoint = simulator.endpoint).apply { setForeground(false) }
+            client.subscribe(MessageType.MESSAGE_TYPE_ODOMETRY, DeliveryMode.INLINE) { odometryArrived.countDown() }
+            try {
+                client.connect()
+                assertEquals(0, recordUntilOdometry(File(folder.root, "background.csv"), 20))
+
+                client.setForeground(true)
+                assertTrue(recordUntilOdometry(File(folder.root, "foreground.csv"), 20) >= 20)
+            } finally {
+                client.close()
+            }
+        }
+    }
+}
@@ -0,0 +1,38 @@
+package com.helywin.leggedjoystick.ui.video
+
+import org.junit.Assert.*
+import org.junit.Test
+
+/**
+ * 视频时间戳条纹编解码测试
+ */
+class LatencyMarkerCodecTest {
+
+    @Test
+    fun decode_roundTripsAtSeveralWidths() {
+        val timestamp = 1_760_000_123_456L
+        for (width in listOf(52, 208, 640, 1920)) {
+            val row = LatencyMarkerCodec.encodeRow(timestamp, width)
+            assertEquals("width=$width", timestamp and LatencyMarkerCodec.TIMESTAMP_MASK,
+                LatencyMarkerCodec.decodeRow(row, width))
+        }
+    }
+
+    @Test
+    fun decode_rejectsMissingOrCorruptStrip() {
+        assertEquals(-1L, LatencyMarkerCodec.decodeRow(IntArray(208) { 0xFF808080.toInt() }, 208))
+
+        val row = LatencyMarkerCodec.encodeRow(1_760_000_123_456L, 208)
+        // 翻转一个数据位（第10格）
+        for (x in 40 until 44) row[x] = row[x] xor 0x00FFFFFF
+        assertEquals(-1L, LatencyMarkerCodec.decodeRow(row, 208))
+    }
+
+    @Test
+    fun expand_picksNearestPeriod() {
+        val timestamp = 1_760_000_123_456L
+        val lowBits = timestamp and LatencyMarkerCodec.TIMESTAMP_MASK
+        assertEquals(timestamp, LatencyMarkerCodec.expand(lowBits, timestamp + 200))
+        assertEquals(timestamp, LatencyMarkerCodec.expand(lowBits, timestamp - 200))
+    }
+}
@@ -0,0 +1,107 @@
+package com.helywin.leggedjoystick.zmq
+
+import org.junit.Assert.*
+import org.junit.Test
+import java.util.concurrent.TimeUnit
+
+/**
+ * 在途指令表测试
+ */
+class CommandTrackerTest {
+
+    private val ms = TimeUnit.MILLISECONDS.toNanos(1)
+
+    private fun frameOf(requestId: Int) = byteArrayOf(requestId.toByte())
+
+    @Test
+    fun submit_sameTargetReusesInFlightRequest() {
+        val tracker = CommandTracker()
+        val sent = mutableListOf<ByteArray>()
+
+        val first = tracker.submit(CommandKind.MODE, 1, 0L, ::frameOf) { sent.add(it) }
+        val second = tracker.submit(CommandKind.MODE, 1, 10 * ms, ::frameOf) { sent.add(it) }
+
+        assertSame(first, second)
+        assertEquals(1, sent.size)
+        assertEquals(1, tracker.size)
+    }
+
+    @Test
+    fun ack_completesMatchingRequest() {
+        val tracker = CommandTracker()
+        var requestId = 0
+        val future = tracker.submit(CommandKind.CONTROL_MODE, 2, 0L, ::frameOf) { requestId = it[0].toInt() }
+
+        assertFalse(tracker.onAck(requestId + 1, true, "", 5 * ms))
+        assertTrue(tracker.onAck(requestId, true, "", 20 * ms))
+
+        val result = future.getNow(null)
+        assertEquals(CommandStatus.ACKED, result.status)
+        assertEquals(20L, result.latencyMs)
+        assertEquals(0, tracker.size)
+    }
+
+    @Test
+    fun newTarget_supersedesOlderRequest() {
+        val tracker = CommandTracker()
+        val old = tracker.submit(CommandKind.MODE, 0, 0L, ::frameOf) {}
+        val new = tracker.submit(CommandKind.MODE, 1, 0L, ::frameOf) {}
+
+        assertEquals(CommandStatus.SUPERSEDED, old.getNow(null).status)
+        assertFalse(new.isDone)
+
+        // 旧版本对端只广播当前状态，与目标一致时视为确认
+        tracker.onStateReport(CommandKind.MODE, 0, ms)
+        assertFalse(new.isDone)
+        tracker.onStateReport(CommandKind.MODE, 1, ms)
+        assertTrue(new.getNow(null).isSuccess)
+    }
+
+    @Test
+    fun deadlines_resendThenTimeOut() {
+        val tracker = CommandTracker(ackTimeoutMs = 100, maxAttempts = 3)
+        val resent = mutableListOf<ByteArray>()
+        // 先确认一条指令，说明对端支持确认
+        var controlRequestId = 0
+        tracker.submit(CommandKind.CONTROL_MODE, 2, 0L, ::frameOf) { controlRequestId = it[0].toInt() }
+        assertTrue(tracker.onAck(controlRequestId, true, "", 0L))
+        val future = tracker.submit(CommandKind.MODE, 1, 0L, ::frameOf) {}
+
+        tracker.checkDeadlines(50 * ms) { resent.add(it) }
+        assertTrue(resent.isEmpty())
+
+        tracker.checkDeadlines(100 * ms) { resent.add(it) }
+        tracker.checkDeadlines(200 * ms) { resent.add(it) }
+        assertEquals(2, resent.size)
+        assertEquals(2.toByte(), resent[1][0]) // 重发使用同一请求ID
+        assertFalse(future.isDone)
+
+        tracker.checkDeadlines(300 * ms) { resent.add(it) }
+        val result = future.getNow(null)
+        assertEquals(CommandStatus.TIMEOUT, result.status)
+        assertEquals(3, result.attempts)
+        assertEquals(0, tracker.size)
+    }
+
+    @Test
+    fun legacyPeer_waitsForStateBroadcastBeforeTimingOut() {
+        val tracker = CommandTracker(ackTimeoutMs = 100, maxAttempts = 3, legacyConfirmTimeoutMs = 1500)
+        val resent = mutableListOf<ByteArray>()
+        val confirmed = tracker.submit(CommandKind.MODE, 1, 0L, ::frameOf) {}
+
+        for (t in 100L..1400L step 100) tracker.checkDeadlines(t * ms) { resent.add(it) }
+        assertEquals(2, resent.size) // 重发次数不变，只是延长等待
+        assertFalse(confirmed.isDone)
+
+        // 约1秒一次的状态广播与目标一致
+        tracker.onStateReport(CommandKind.MODE, 1, 1000 * ms)
+        assertTrue(confirmed.getNow(null).isSuccess)
+
+        val expired = tracker.submit(CommandKind.CONTROL_MODE, 2, 2000 * ms, ::frameOf) {}
+        for (t in 2100L..3400L step 100) tracker.checkDeadlines(t * ms) {}
+        tracker.checkDeadlines(3499 * ms) {}
+        assertFalse(expired.isDone)
+        tracker.checkDeadlines(3500 * ms) {}
+        assertEquals(CommandStatus.TIMEOUT, expired.getNow(null).status)
+    }
+}
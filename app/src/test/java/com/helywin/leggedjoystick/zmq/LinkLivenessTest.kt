@@ -0,0 +1,105 @@
+package com.helywin.leggedjoystick.zmq
+
+import org.junit.Assert.*
+import org.junit.Test
+import java.util.concurrent.TimeUnit
+
+/**
+ * 链路存活判断测试：探测时机、断链判断和断链超时的上下限
+ */
+class LinkLivenessTest {
+
+    private fun ms(value: Long) = TimeUnit.MILLISECONDS.toNanos(value)
+
+    @Test
+    fun steadyDownlink_slowerThanProbeThreshold_doesNotProbe() {
+        // 5Hz 下行：静默阈值随帧间隔放宽，稳态下不探测
+        val liveness = LinkLiveness(heartbeatIntervalMs = 1000)
+        liveness.reset(0)
+        var now = ms(200)
+        liveness.onInbound(now)
+        repeat(20) {
+            for (step in 1..20) {
+                assertFalse("t=${now / 1_000_000}ms", liveness.shouldProbe(now + ms(step * 10L)))
+            }
+            now += ms(200)
+            liveness.onInbound(now)
+        }
+        assertEquals(ms(600), liveness.probeAfterNanos())
+    }
+
+    @Test
+    fun idleLink_probeThresholdCappedAtHeartbeatInterval() {
+        val liveness = LinkLiveness(heartbeatIntervalMs = 1000)
+        liveness.reset(0)
+        liveness.onInbound(ms(5000))
+        assertEquals(ms(1000), liveness.probeAfterNanos())
+        assertFalse(liveness.shouldProbe(ms(5999)))
+        assertTrue(liveness.shouldProbe(ms(6000)))
+    }
+
+    @Test
+    fun fastDownlink_usesMinimumProbeThreshold() {
+        val liveness = LinkLiveness(heartbeatIntervalMs = 1000)
+        liveness.reset(0)
+        var now = 0L
+        repeat(200) {
+            now += ms(10)
+            liveness.onInbound(now)
+        }
+        assertEquals(ms(LinkLiveness.PROBE_AFTER_SILENCE_MS), liveness.probeAfterNanos())
+        assertTrue(liveness.shouldProbe(now + ms(LinkLiveness.PROBE_AFTER_SILENCE_MS)))
+    }
+
+    @Test
+    fun unansweredRequest_probesAtIntervalThenDeclaresDead() {
+        val liveness = LinkLiveness(heartbeatIntervalMs = 1000)
+        liveness.reset(0)
+        liveness.onRequestSent(ms(100))
+
+        assertFalse(liveness.shouldProbe(ms(139)))
+        assertTrue(liveness.shouldProbe(ms(140)))
+        liveness.onRequestSent(ms(140))
+        assertFalse(liveness.shouldProbe(ms(170)))
+
+        // 没有往返时延数据时超时取上限：探测间隔 + 180ms
+        val deadAfter = ms(LinkLiveness.PROBE_INTERVAL_MS + LinkLiveness.MAX_LINK_TIMEOUT_MS)
+        assertEquals(deadAfter, liveness.deadAfterNanos())
+        assertFalse(liveness.isLinkDead(ms(100) + deadAfter))
+        assertTrue(liveness.isLinkDead(ms(101) + deadAfter))
+    }
+
+    @Test
+    fun anyInbound_answersOutstandingRequests() {
+        val liveness = LinkLiveness(heartbeatIntervalMs = 1000)
+        liveness.reset(0)
+        liveness.onRequestSent(ms(10))
+        liveness.onRequestSent(ms(50))
+        liveness.onInbound(ms(60))
+
+        assertEquals(0L, liveness.unansweredNanos(ms(500)))
+        assertFalse(liveness.isLinkDead(ms(500)))
+    }
+
+    @Test
+    fun linkTimeout_clampedBetweenMinAndMax() {
+        assertEquals(
+            ms(LinkLiveness.MAX_LINK_TIMEOUT_MS),
+            LinkLiveness.linkTimeoutNanos(LinkStatsSnapshot())
+        )
+        // 1ms p99，无抖动：1 + 20 余量 = 21ms，取下限
+        assertEquals(
+            ms(LinkLiveness.MIN_LINK_TIMEOUT_MS),
+            LinkLiveness.linkTimeoutNanos(LinkStatsSnapshot(rttSamples = 10, rttP99Us = 1_000))
+        )
+        // 40ms p99 + 4 × 5ms 抖动 + 20ms 余量 = 80ms
+        assertEquals(
+            ms(80),
+            LinkLiveness.linkTimeoutNanos(LinkStatsSnapshot(rttSamples = 10, rttP99Us = 40_000, jitterUs = 5_000))
+        )
+        assertEquals(
+            ms(LinkLiveness.MAX_LINK_TIMEOUT_MS),
+            LinkLiveness.linkTimeoutNanos(LinkStatsSnapshot(rttSamples = 10, rttP99Us = 500_000, jitterUs = 50_000))
+        )
+    }
+}
@@ -0,0 +1,188 @@
+/*********************************************************************************
+ * FileName: LoopbackHarness.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 在本机回环上驱动 NewZmqClient 和 RobotSimulator，统计端到端时延、吞吐和CPU开销
+ * Others: 速度指令的 yaw_rate 携带序号（不经过限幅），模拟器按序号记录到达时刻；
+ *         CPU 时间取自 ZMQ-IO 线程的 ThreadMXBean 计数
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.zmq
+
+import com.helywin.leggedjoystick.data.ConnectionState
+import com.helywin.leggedjoystick.metrics.RollingSampleWindow
+import legged_driver.MessageType
+import java.lang.management.ManagementFactory
+import java.util.concurrent.CountDownLatch
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicLong
+import java.util.concurrent.locks.LockSupport
+
+/**
+ * 一次运行的结果
+ *
+ * @param commandLatencyUs 指令从调用 sendVelocityCommand 到模拟器处理的时延百分位（p50, p95, p99, max）
+ * @param maxSendQueue 运行期间观察到的最大发送队列长度
+ * @param maxReceiveBacklog 模拟器已发出但客户端尚未处理的遥测帧数峰值（注入丢包时包括丢失的帧）
+ * @param ioCpuNanosPerMessage I/O线程每处理一帧（收+发）消耗的CPU时间
+ */
+data class HarnessReport(
+    val odometryHz: Double,
+    val commandsSent: Long,
+    val commandsDelivered: Long,
+    val commandLatencyUs: LongArray,
+    val telemetrySent: Long,
+    val telemetryReceived: Long,
+    val messagesReceived: Long,
+    val maxSendQueue: Int,
+    val maxReceiveBacklog: Long,
+    val finalReceiveBacklog: Long,
+    val ioCpuNanosPerMessage: Long
+) {
+    fun format(): String =
+        "odom=${odometryHz.toInt()}Hz cmd=$commandsDelivered/$commandsSent " +
+                "latency(us) p50=${commandLatencyUs[0]} p95=${commandLatencyUs[1]} p99=${commandLatencyUs[2]} " +
+                "max=${commandLatencyUs[3]} telemetry=$telemetryReceived/$telemetrySent rx=$messagesReceived " +
+                "sendQueueMax=$maxSendQueue backlogMax=$maxReceiveBacklog backlogEnd=$finalReceiveBacklog " +
+                "cpu/msg=${ioCpuNanosPerMessage}ns"
+}
+
+/**
+ * 回环测试驱动
+ */
+class LoopbackHarness(
+    private val commandRateHz: Double = 100.0,
+    private val durationMs: Long = 2000
+) {
+    companion object {
+        private const val CONNECT_TIMEOUT_MS = 3000L
+        private const val SETTLE_MS = 200L // 停止发送后等待在途帧到达
+        private const val COMMAND_VX = 0.5f
+        private val PERCENTILES = doubleArrayOf(50.0, 95.0, 99.0)
+    }
+
+    /**
+     * 按给定模拟器配置运行一次
+     */
+    fun run(config: SimulatorConfig): HarnessReport {
+        val simulator = RobotSimulator(config)
+        val client = NewZmqClient(tcpEndpoint = simulator.endpoint)
+        val connected = CountDownLatch(1)
+        val received = AtomicLong(0)
+        val telemetry = AtomicLong(0)
+        client.setConnectionStateCallback { state ->
+            if (state == ConnectionState.CONNECTED) connected.countDown()
+        }
+        client.setMessageCallback { message ->
+            received.incrementAndGet()
+            if (message.message_type == MessageType.MESSAGE_TYPE_ODOMETRY ||
+                message.message_type == MessageType.MESSAGE_TYPE_BATTERY_INFO
+            ) {
+                telemetry.incrementAndGet()
+            }
+        }
+
+        var sent = 0
+        val sendTimes = LongArray(((commandRateHz * durationMs / 1000).toInt() + 2).coerceAtMost(1 shl 20))
+        var maxSendQueue = 0
+        var maxBacklog = 0L
+        var cpuStart = 0L
+        var cpuEnd = 0L
+        var telemetrySent = 0L
+        var telemetryReceived = 0L
+        var messagesReceived = 0L
+        try {
+            simulator.start()
+            client.connect()
+            check(connected.await(CONNECT_TIMEOUT_MS, TimeUnit.MILLISECONDS)) { "连接模拟器超时" }
+
+            val ioThreadId = findThreadId("ZMQ-IO")
+            val threadBean = ManagementFactory.getThreadMXBean()
+            cpuStart = threadBean.getThreadCpuTime(ioThreadId)
+            val receivedAtStart = received.get()
+            val telemetryAtStart = telemetry.get()
+            val telemetrySentAtStart = simulator.telemetrySent.get()
+
+            // 按固定周期发送，序号从1开始（0表示未收到）
+            val period = (TimeUnit.SECONDS.toNanos(1) / commandRateHz).toLong()
+            val start = System.nanoTime()
+            val end = start + TimeUnit.MILLISECONDS.toNanos(durationMs)
+            var next = start
+            while (next < end && sent + 1 < sendTimes.size) {
+                LockSupport.parkNanos(next - System.nanoTime())
+                sent++
+                sendTimes[sent] = System.nanoTime()
+                client.sendVelocityCommand(COMMAND_VX, 0f, sent.toFloat())
+                maxSendQueue = maxOf(maxSendQueue, client.getSendQueueSize())
+                maxBacklog = maxOf(
+                    maxBacklog,
+                    (simulator.telemetrySent.get() - telemetrySentAtStart) - (telemetry.get() - telemetryAtStart)
+                )
+                next += period
+            }
+            Thread.sleep(SETTLE_MS)
+
+            cpuEnd = threadBean.getThreadCpuTime(ioThreadId)
+            telemetrySent = simulator.telemetrySent.get() - telemetrySentAtStart
+            telemetryReceived = telemetry.get() - telemetryAtStart
+            messagesReceived = received.get() - receivedAtStart
+        } finally {
+            client.close()
+            simulator.close()
+        }
+
+        // 模拟器线程结束后读取到达时刻
+        val latency = RollingSampleWindow(maxOf(sent, 1))
+        var delivered = 0L
+        var maxLatencyUs = 0L
+        for (sequence in 1..sent) {
+            val arrived = simulator.velocityReceivedAt(sequence)
+            if (arrived == 0L) continue // 被更新的指令覆盖或丢失
+            val us = TimeUnit.NANOSECONDS.toMicros(arrived - sendTimes[sequence])
+            latency.add(us)
+            maxLatencyUs = maxOf(maxLatencyUs, us)
+            delivered++
+        }
+        val percentiles = LongArray(PERCENTILES.size)
+        latency.percentiles(PERCENTILES, percentiles)
+
+        val handled = messagesReceived + sent
+        return HarnessReport(
+            odometryHz = config.odometryHz,
+            commandsSent = sent.toLong(),
+            commandsDelivered = delivered,
+            commandLatencyUs = percentiles + maxLatencyUs,
+            telemetrySent = telemetrySent,
+            telemetryReceived = telemetryReceived,
+            messagesReceived = messagesReceived,
+            maxSendQueue = maxSendQueue,
+            maxReceiveBacklog = maxBacklog,
+            finalReceiveBacklog = (telemetrySent - telemetryReceived).coerceAtLeast(0),
+            ioCpuNanosPerMessage = if (handled > 0 && cpuStart >= 0) (cpuEnd - cpuStart) / handled else 0
+        )
+    }
+
+    /**
+     * 逐步提高里程计频率，返回在运行结束时仍无接收积压的最高频率及每一步的结果
+     * @param backlogLimit 允许的在途帧数（回环上的正常排队）
+     */
+    fun findMaxInboundRate(
+        rates: List<Double>,
+        base: SimulatorConfig = SimulatorConfig(),
+        backlogLimit: Long = 64
+    ): Pair<Double, List<HarnessReport>> {
+        val reports = mutableListOf<HarnessReport>()
+        var sustained = 0.0
+        for (rate in rates) {
+            val report = run(base.copy(odometryHz = rate))
+            reports += report
+            if (report.finalReceiveBacklog > backlogLimit || report.maxSendQueue > 2) break
+            sustained = rate
+        }
+        return sustained to reports
+    }
+
+    private fun findThreadId(name: String): Long =
+        Thread.getAllStackTraces().keys.first { it.name == name }.id
+}
@@ -0,0 +1,99 @@
+package com.helywin.leggedjoystick.zmq
+
+import com.helywin.leggedjoystick.data.ConnectionState
+import legged_driver.MessageType
+import legged_driver.Mode
+import org.junit.Assert.*
+import org.junit.Assume.assumeTrue
+import org.junit.Test
+import java.util.concurrent.CountDownLatch
+import java.util.concurrent.TimeUnit
+
+/**
+ * 客户端与回环模拟器的端到端测试
+ * 设置环境变量 LOOPBACK_LOAD=1 时额外运行频率扫描和损伤链路下的负载测试
+ */
+class LoopbackHarnessTest {
+
+    @Test
+    fun velocityAndTelemetry_flowOverLoopback() {
+        val report = LoopbackHarness(commandRateHz = 100.0, durationMs = 500)
+            .run(SimulatorConfig(odometryHz = 200.0))
+        println(report.format())
+
+        assertTrue(report.commandsDelivered > report.commandsSent / 2)
+        assertTrue(report.telemetryReceived > 0)
+        assertTrue("p50=${report.commandLatencyUs[0]}us", report.commandLatencyUs[0] < 50_000)
+    }
+
+    @Test
+    fun setMode_completesOnAck() {
+        RobotSimulator().use { simulator ->
+            simulator.start()
+            val client = NewZmqClient(tcpEndpoint = simulator.endpoint)
+            val connected = CountDownLatch(1)
+            client.setConnectionStateCallback { if (it == ConnectionState.CONNECTED) connected.countDown() }
+            try {
+                client.connect()
+                assertTrue(connected.await(3, TimeUnit.SECONDS))
+
+                val result = client.setMode(Mode.MODE_MANUAL).get(2, TimeUnit.SECONDS)
+                assertEquals(CommandStatus.ACKED, result.status)
+                assertEquals(1, result.attempts)
+            } finally {
+                client.close()
+            }
+        }
+    }
+
+    @Test
+    fun velocitySlot_keepsOnlyLatestAndDropsCommandsWhileLinkDown() {
+        val simulator = RobotSimulator()
+        val client = NewZmqClient(tcpEndpoint = simulator.endpoint)
+        val connected = CountDownLatch(1)
+        val echoed = CountDownLatch(1)
+        client.setConnectionStateCallback { if (it == ConnectionState.CONNECTED) connected.countDown() }
+        client.subscribe(MessageType.MESSAGE_TYPE_VELOCITY_COMMAND, DeliveryMode.INLINE) { echoed.countDown() }
+        try {
+            // 模拟器尚未运行，链路未连通：指令只占一个槽位，不排队
+            client.connect()
+            for (sequence in 1..500) {
+                client.sendVelocityCommand(0.1f, 0f, sequence.toFloat())
+                assertTrue(client.getSendQueueSize() <= 1)
+            }
+            val drainDeadline = System.nanoTime() + TimeUnit.SECONDS.toNanos(1)
+            while (client.getSendQueueSize() > 0 && System.nanoTime() < drainDeadline) Thread.yield()
+            assertEquals(0, client.getSendQueueSize())
+
+            simulator.start()
+            assertTrue(connected.await(3, TimeUnit.SECONDS))
+            client.sendVelocityCommand(0.1f, 0f, 1000f)
+            assertTrue(echoed.await(2, TimeUnit.SECONDS))
+        } finally {
+            client.close()
+            simulator.close()
+        }
+
+        // 连通后不会重放断链期间的过期指令
+        assertTrue(simulator.velocityReceivedAt(1000) > 0)
+        assertTrue((1..500).all { simulator.velocityReceivedAt(it) == 0L })
+    }
+
+    @Test
+    fun load_inboundRateSweepAndImpairedLink() {
+        assumeTrue(System.getenv("LOOPBACK_LOAD") != null)
+        val harness = LoopbackHarness(commandRateHz = 100.0, durationMs = 3000)
+
+        val (maxRate, reports) = harness.findMaxInboundRate(
+            listOf(100.0, 200.0, 500.0, 1000.0, 2000.0, 5000.0, 10000.0)
+        )
+        reports.forEach { println(it.format()) }
+        println("max sustainable odometry rate: ${maxRate.toInt()}Hz")
+        assertTrue(maxRate >= 500.0)
+
+        // 5ms ± 5ms 单向时延、1% 丢包
+        val impaired = harness.run(SimulatorConfig(odometryHz = 500.0, lossRate = 0.01, delayMs = 5.0, jitterMs = 5.0))
+        println("impaired: " + impaired.format())
+        assertTrue(impaired.commandsDelivered > 0)
+    }
+}
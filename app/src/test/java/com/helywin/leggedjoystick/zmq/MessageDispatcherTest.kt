@@ -0,0 +1,77 @@
+package com.helywin.leggedjoystick.zmq
+
+import android.view.Choreographer
+import com.helywin.leggedjoystick.proto.MessageUtils
+import legged_driver.BatteryInfoMessage
+import legged_driver.DeviceType
+import legged_driver.LeggedDriverMessage
+import legged_driver.MessageType
+import org.junit.Assert.*
+import org.junit.Test
+
+/**
+ * 按消息类型订阅分发测试
+ */
+class MessageDispatcherTest {
+
+    private fun battery(level: Int): LeggedDriverMessage = MessageUtils.createMessage(
+        0L, DeviceType.DEVICE_TYPE_SERVER, "robot", MessageType.MESSAGE_TYPE_BATTERY_INFO,
+        batteryInfo = BatteryInfoMessage(battery_level = level)
+    )
+
+    @Test
+    fun mainCoalesced_deliversLatestOncePerFrame() {
+        val frames = mutableListOf<Choreographer.FrameCallback>()
+        val dispatcher = MessageDispatcher(FrameScheduler { frames.add(it) })
+        val delivered = mutableListOf<Int>()
+        dispatcher.subscribe(MessageType.MESSAGE_TYPE_BATTERY_INFO, DeliveryMode.MAIN_COALESCED) {
+            delivered.add(it.battery_info!!.battery_level)
+        }
+
+        for (level in 1..10) dispatcher.dispatch(battery(level))
+        assertEquals(1, frames.size)
+        frames.removeAt(0).doFrame(0L)
+        assertEquals(listOf(10), delivered)
+
+        dispatcher.dispatch(battery(11))
+        assertEquals(1, frames.size)
+        frames.removeAt(0).doFrame(0L)
+        assertEquals(listOf(10, 11), delivered)
+    }
+
+    @Test
+    fun inline_deliversEveryMessageAndUnsubscribeStopsDelivery() {
+        val dispatcher = MessageDispatcher()
+        var count = 0
+        val subscription = dispatcher.subscribe(MessageType.MESSAGE_TYPE_BATTERY_INFO, DeliveryMode.INLINE) { count++ }
+
+        assertTrue(dispatcher.hasSubscribers(MessageType.MESSAGE_TYPE_BATTERY_INFO.value))
+        assertFalse(dispatcher.hasSubscribers(MessageType.MESSAGE_TYPE_VELOCITY_COMMAND.value))
+        repeat(5) { dispatcher.dispatch(battery(it)) }
+        assertEquals(5, count)
+
+        dispatcher.unsubscribe(subscription)
+        dispatcher.dispatch(battery(0))
+        assertEquals(5, count)
+        assertFalse(dispatcher.hasSubscribers(MessageType.MESSAGE_TYPE_BATTERY_INFO.value))
+    }
+
+    @Test
+    fun client_countsUnsubscribedFramesWithoutDispatching() {
+        val client = NewZmqClient()
+        val frame = MessageUtils.encodeFrame(
+            MessageUtils.createVelocityCommandMessage(DeviceType.DEVICE_TYPE_SERVER, "robot", 0.1f, 0f, 0f)
+        )
+        var dispatched = 0
+        val subscription = client.subscribe(MessageType.MESSAGE_TYPE_VELOCITY_COMMAND, DeliveryMode.INLINE) {
+            dispatched++
+        }
+        assertTrue(client.replayInboundFrame(frame))
+        client.unsubscribe(subscription)
+        assertTrue(client.replayInboundFrame(frame))
+
+        assertEquals(1, dispatched)
+        assertEquals(2L, client.getLinkCounters().received(MessageType.MESSAGE_TYPE_VELOCITY_COMMAND))
+        client.close()
+    }
+}
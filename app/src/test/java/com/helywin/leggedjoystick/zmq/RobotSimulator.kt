@@ -0,0 +1,333 @@
+/*********************************************************************************
+ * FileName: RobotSimulator.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 本机回环机器人模拟器：ROUTER 端点，按 LeggedDriverMessage 协议（含CRC32）收发
+ * Others: 按配置频率发布心跳、电量和里程计，回显心跳和速度指令，确认模式设置；
+ *         可注入丢包、固定延迟和抖动。时间基准为 System.nanoTime，与同进程的客户端一致
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.zmq
+
+import com.helywin.leggedjoystick.proto.MessageUtils
+import legged_driver.*
+import org.zeromq.SocketType
+import org.zeromq.ZContext
+import org.zeromq.ZMQ
+import java.util.PriorityQueue
+import java.util.Random
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicLong
+
+/**
+ * 模拟器配置
+ *
+ * @param odometryHz 里程计发布频率，0 表示不发布
+ * @param lossRate 每一帧（双向）被丢弃的概率
+ * @param delayMs 单向固定延迟
+ * @param jitterMs 单向延迟的均匀抖动上限
+ */
+data class SimulatorConfig(
+    val heartbeatIntervalMs: Long = 1000,
+    val batteryHz: Double = 1.0,
+    val odometryHz: Double = 100.0,
+    val lossRate: Double = 0.0,
+    val delayMs: Double = 0.0,
+    val jitterMs: Double = 0.0,
+    val seed: Long = 1
+)
+
+/**
+ * 回环机器人模拟器，start() 后在独立线程上运行
+ */
+class RobotSimulator(private val config: SimulatorConfig = SimulatorConfig()) : AutoCloseable {
+    companion object {
+        private const val DEVICE_ID = "simulator"
+        private const val POLL_TIMEOUT_MS = 1L
+        private const val MAX_FRAMES_PER_POLL = 1024
+    }
+
+    /**
+     * 待延迟发送/处理的帧
+     */
+    private class DelayedFrame(val dueNanos: Long, val order: Long, val identity: ByteArray, val data: ByteArray)
+
+    private val context = ZContext()
+    private val socket: ZMQ.Socket = context.createSocket(SocketType.ROUTER).apply {
+        linger = 0
+        receiveTimeOut = 0
+        sendTimeOut = 0
+    }
+    private val random = Random(config.seed)
+    private var frameOrder = 0L
+    private val delayComparator = compareBy<DelayedFrame>({ it.dueNanos }, { it.order })
+    private val outbound = PriorityQueue(64, delayComparator)
+    private val inbound = PriorityQueue(64, delayComparator)
+
+    @Volatile
+    private var running = false
+    private var thread: Thread? = null
+
+    // 最近一次发来消息的客户端，遥测只发给它
+    private var peerIdentity: ByteArray? = null
+
+    // 机器人状态
+    private var mode = Mode.MODE_AUTO
+    private var controlMode = ControlMode.CONTROL_MODE_STAND_UP
+    private var heartbeatSequence = 0
+    private var odometryTick = 0L
+
+    // 速度指令接收记录：客户端在 yaw_rate 中携带序号，按序号记录接收时刻
+    private val velocityReceiveNanos = LongArray(1 shl 20)
+
+    /** 已绑定的端点，start() 后可用 */
+    val endpoint: String
+
+    /** 模拟器发出的遥测帧数（电量和里程计，包括被丢弃的） */
+    val telemetrySent = AtomicLong(0)
+
+    /** 收到的速度指令数 */
+    val velocityReceived = AtomicLong(0)
+
+    /** 收到的模式设置/控制模式设置数 */
+    val commandsReceived = AtomicLong(0)
+
+    init {
+        socket.bind("tcp://127.0.0.1:*")
+        endpoint = socket.lastEndpoint
+    }
+
+    fun start() {
+        running = true
+        thread = Thread(::loop, "RobotSimulator").apply {
+            isDaemon = true
+            start()
+        }
+    }
+
+    /**
+     * 序号为 [sequence] 的速度指令到达模拟器的时刻（包括注入的延迟），未收到时返回 0
+     * 应在 close() 之后读取
+     */
+    fun velocityReceivedAt(sequence: Int): Long =
+        if (sequence in velocityReceiveNanos.indices) velocityReceiveNanos[sequence] else 0L
+
+    override fun close() {
+        running = false
+        thread?.join(TimeUnit.SECONDS.toMillis(2))
+        context.close()
+    }
+
+    private fun loop() {
+        val poller = context.createPoller(1)
+        poller.register(socket, ZMQ.Poller.POLLIN)
+        val start = System.nanoTime()
+        var nextHeartbeat = start
+        var nextBattery = start
+        var nextOdometry = start
+        val heartbeatPeriod = TimeUnit.MILLISECONDS.toNanos(config.heartbeatIntervalMs)
+        val batteryPeriod = periodNanos(config.batteryHz)
+        val odometryPeriod = periodNanos(config.odometryHz)
+
+        try {
+            while (running) {
+                poller.poll(POLL_TIMEOUT_MS)
+                receiveAll()
+
+                val now = System.nanoTime()
+                processDue(inbound, now) { _, data -> handleFrame(data, now) }
+
+                if (peerIdentity != null) {
+                    if (now >= nextHeartbeat) {
+                        nextHeartbeat += heartbeatPeriod
+                        reply(heartbeat(null, now), now)
+                    }
+                    if (batteryPeriod > 0 && now >= nextBattery) {
+                        nextBattery += batteryPeriod
+                        sendTelemetry(batteryInfo(), now)
+                    }
+                    // 按时间表补发，保证平均频率；积压超过一秒时丢弃积压
+                    if (odometryPeriod > 0) {
+                        if (now - nextOdometry > TimeUnit.SECONDS.toNanos(1)) nextOdometry = now
+                        while (now >= nextOdometry) {
+                            nextOdometry += odometryPeriod
+                            sendTelemetry(odometry(), now)
+                        }
+                    }
+                }
+
+                processDue(outbound, System.nanoTime()) { identity, data ->
+                    socket.sendMore(identity)
+                    socket.send(data, ZMQ.DONTWAIT)
+                }
+            }
+        } finally {
+            poller.close()
+        }
+    }
+
+    private fun periodNanos(hz: Double): Long =
+        if (hz <= 0.0) 0L else (TimeUnit.SECONDS.toNanos(1) / hz).toLong()
+
+    /**
+     * 读取所有入站帧（ROUTER：身份帧 + 数据帧），按注入的丢包和延迟进入入站队列
+     */
+    private fun receiveAll() {
+        var frames = 0
+        while (frames < MAX_FRAMES_PER_POLL) {
+            val identity = socket.recv(ZMQ.DONTWAIT) ?: return
+            val data = if (socket.hasReceiveMore()) socket.recv(ZMQ.DONTWAIT) else null
+            frames++
+            if (data == null) continue
+            peerIdentity = identity
+            impair(inbound, identity, data, System.nanoTime())
+        }
+    }
+
+    private fun impair(queue: PriorityQueue<DelayedFrame>, identity: ByteArray, data: ByteArray, now: Long) {
+        if (config.lossRate > 0.0 && random.nextDouble() < config.lossRate) return
+        val delayMs = config.delayMs + if (config.jitterMs > 0.0) random.nextDouble() * config.jitterMs else 0.0
+        queue.add(DelayedFrame(now + (delayMs * 1_000_000).toLong(), frameOrder++, identity, data))
+    }
+
+    private inline fun processDue(
+        queue: PriorityQueue<DelayedFrame>,
+        now: Long,
+        action: (identity: ByteArray, data: ByteArray) -> Unit
+    ) {
+        while (true) {
+            val head = queue.peek() ?: return
+            if (head.dueNanos > now) return
+            queue.poll()
+            action(head.identity, head.data)
+        }
+    }
+
+    private fun handleFrame(data: ByteArray, now: Long) {
+        val message = MessageUtils.decodeFrame(data) ?: return
+        when (message.message_type) {
+            MessageType.MESSAGE_TYPE_HEARTBEAT -> {
+                val request = message.heartbeat ?: return
+                reply(heartbeat(request, now), now)
+                if (request.request_state) {
+                    reply(currentMode(), now)
+                    reply(currentControlMode(), now)
+                }
+            }
+            MessageType.MESSAGE_TYPE_VELOCITY_COMMAND -> {
+                val command = message.velocity_command ?: return
+                val sequence = command.yaw_rate.toInt()
+                if (sequence in velocityReceiveNanos.indices && velocityReceiveNanos[sequence] == 0L) {
+                    velocityReceiveNanos[sequence] = now
+                }
+                velocityReceived.incrementAndGet()
+                // 回显指令，时间戳为模拟器收到的时刻
+                reply(build(MessageType.MESSAGE_TYPE_VELOCITY_COMMAND, velocityCommand = command), now)
+            }
+            MessageType.MESSAGE_TYPE_MODE_SET -> {
+                commandsReceived.incrementAndGet()
+                message.mode_set?.let { mode = it.mode }
+                acknowledge(message.request_id, now)
+                reply(currentMode(), now)
+            }
+            MessageType.MESSAGE_TYPE_CONTROL_MODE_SET -> {
+                commandsReceived.incrementAndGet()
+                message.control_mode_set?.let { controlMode = it.control_mode }
+                acknowledge(message.request_id, now)
+                reply(currentControlMode(), now)
+            }
+            else -> {}
+        }
+    }
+
+    private fun acknowledge(requestId: Int, now: Long) {
+        if (requestId == 0) return
+        reply(
+            build(
+                MessageType.MESSAGE_TYPE_COMMAND_ACK,
+                commandAck = CommandAckMessage(request_id = requestId, accepted = true)
+            ),
+            now
+        )
+    }
+
+    private fun reply(message: LeggedDriverMessage, now: Long) {
+        val identity = peerIdentity ?: return
+        impair(outbound, identity, MessageUtils.encodeFrame(message), now)
+    }
+
+    private fun sendTelemetry(message: LeggedDriverMessage, now: Long) {
+        telemetrySent.incrementAndGet()
+        reply(message, now)
+    }
+
+    /**
+     * 服务器心跳，[request] 非空时回显其序号和发送时刻
+     */
+    private fun heartbeat(request: HeartbeatMessage?, now: Long): LeggedDriverMessage {
+        heartbeatSequence++
+        val nowUs = TimeUnit.NANOSECONDS.toMicros(now)
+        return build(
+            MessageType.MESSAGE_TYPE_HEARTBEAT,
+            heartbeat = HeartbeatMessage(
+                is_connected = true,
+                sequence = heartbeatSequence,
+                send_time_us = nowUs,
+                echo_sequence = request?.sequence ?: 0,
+                echo_time_us = request?.send_time_us ?: 0L,
+                echo_delay_us = 0
+            )
+        )
+    }
+
+    private fun batteryInfo() = build(
+        MessageType.MESSAGE_TYPE_BATTERY_INFO,
+        batteryInfo = BatteryInfoMessage(battery_level = 80, voltage = 25.0f, current = 2.0f, temperature = 35.0f)
+    )
+
+    private fun odometry(): LeggedDriverMessage {
+        // 半径2米的圆周运动
+        val t = odometryTick++ * 0.01
+        return build(
+            MessageType.MESSAGE_TYPE_ODOMETRY,
+            odometry = OdometryMessage(
+                position = Vector3(x = (2 * kotlin.math.cos(t)).toFloat(), y = (2 * kotlin.math.sin(t)).toFloat(), z = 0.3f),
+                orientation = Quaternion(z = kotlin.math.sin(t / 2).toFloat(), w = kotlin.math.cos(t / 2).toFloat()),
+                linear_velocity = Vector3(x = 0.5f),
+                angular_velocity = Vector3(z = 0.25f)
+            )
+        )
+    }
+
+    private fun currentMode() =
+        build(MessageType.MESSAGE_TYPE_CURRENT_MODE, currentMode = CurrentModeMessage(mode = mode))
+
+    private fun currentControlMode() = build(
+        MessageType.MESSAGE_TYPE_CURRENT_CONTROL_MODE,
+        currentControlMode = CurrentControlModeMessage(control_mode = controlMode)
+    )
+
+    private fun build(
+        type: MessageType,
+        heartbeat: HeartbeatMessage? = null,
+        batteryInfo: BatteryInfoMessage? = null,
+        velocityCommand: VelocityCommandMessage? = null,
+        currentMode: CurrentModeMessage? = null,
+        currentControlMode: CurrentControlModeMessage? = null,
+        odometry: OdometryMessage? = null,
+        commandAck: CommandAckMessage? = null
+    ) = MessageUtils.createMessage(
+        timestampMs = MessageUtils.getCurrentTimestampMs(),
+        deviceType = DeviceType.DEVICE_TYPE_SERVER,
+        deviceId = DEVICE_ID,
+        messageType = type,
+        heartbeat = heartbeat,
+        batteryInfo = batteryInfo,
+        velocityCommand = velocityCommand,
+        currentMode = currentMode,
+        currentControlMode = currentControlMode,
+        odometry = odometry,
+        commandAck = commandAck
+    )
+}
@@ -0,0 +1,51 @@
+package com.helywin.leggedjoystick.zmq
+
+import com.helywin.leggedjoystick.data.ConnectionState
+import org.junit.Assert.*
+import org.junit.Test
+import java.util.concurrent.CountDownLatch
+import java.util.concurrent.TimeUnit
+
+/**
+ * 多个客户端共享同一个 I/O 循环的测试
+ */
+class ZmqIoLoopTest {
+
+    @Test
+    fun twoClients_shareOneIoThread_andOnlyForegroundSendsVelocity() {
+        RobotSimulator().use { first ->
+            RobotSimulator().use { second ->
+                first.start()
+                second.start()
+                val loop = ZmqIoLoop()
+                val foreground = NewZmqClient(tcpEndpoint = first.endpoint, ioLoop = loop)
+                val background = NewZmqClient(tcpEndpoint = second.endpoint, ioLoop = loop).apply { setForeground(false) }
+                val connected = CountDownLatch(2)
+                listOf(foreground, background).forEach { client ->
+                    client.setConnectionStateCallback { if (it == ConnectionState.CONNECTED) connected.countDown() }
+                }
+                try {
+                    foreground.connect()
+                    background.connect()
+                    assertTrue(connected.await(3, TimeUnit.SECONDS))
+                    assertEquals(2, loop.clientCount)
+                    assertEquals(1, Thread.getAllStackTraces().keys.count { it.name == ZmqIoLoop.DEFAULT_THREAD_NAME })
+
+                    repeat(20) {
+                        foreground.sendVelocityCommand(0.1f, 0f, 0f)
+                        background.sendVelocityCommand(0.1f, 0f, 0f)
+                        Thread.sleep(10)
+                    }
+                    Thread.sleep(200)
+                    assertTrue(first.velocityReceived.get() > 0)
+                    // 后台会话只可能收到转入后台时补发的零速度指令
+                    assertTrue(second.velocityReceived.get() <= 1)
+                } finally {
+                    foreground.close()
+                    background.close()
+                    loop.close()
+                }
+            }
+        }
+    }
+}
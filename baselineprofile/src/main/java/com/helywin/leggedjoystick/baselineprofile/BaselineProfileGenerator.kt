@@ -0,0 +1,59 @@
+/*********************************************************************************
+ * FileName: BaselineProfileGenerator.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 生成基线配置：冷启动到主控制界面、拖动摇杆、打开并关闭设置界面
+ * Others: 结果同时写入启动配置（startup profile），release 构建据此把启动路径放进主 dex
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.baselineprofile
+
+import androidx.benchmark.macro.junit4.BaselineProfileRule
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.uiautomator.By
+import androidx.test.uiautomator.Until
+import org.junit.Rule
+import org.junit.Test
+import org.junit.runner.RunWith
+
+@RunWith(AndroidJUnit4::class)
+class BaselineProfileGenerator {
+
+    companion object {
+        private const val PACKAGE_NAME = "com.helywin.leggedjoystick"
+        // 与 MainControlScreen 中的测试标签一致
+        const val LEFT_JOYSTICK_TAG = "left_joystick"
+        const val FIND_TIMEOUT_MS = 5_000L
+    }
+
+    @get:Rule
+    val baselineProfileRule = BaselineProfileRule()
+
+    @Test
+    fun generate() = baselineProfileRule.collect(
+        packageName = PACKAGE_NAME,
+        includeInStartupProfile = true
+    ) {
+        pressHome()
+        startActivityAndWait()
+
+        // 摇杆拖动路径（手势处理和发送循环）
+        device.wait(Until.findObject(By.res(LEFT_JOYSTICK_TAG)), FIND_TIMEOUT_MS)?.let { joystick ->
+            val bounds = joystick.visibleBounds
+            device.drag(
+                bounds.centerX(), bounds.centerY(),
+                bounds.centerX() + bounds.width() / 3, bounds.centerY() - bounds.height() / 3,
+                20
+            )
+        }
+
+        // 设置界面
+        device.wait(Until.findObject(By.desc("设置")), FIND_TIMEOUT_MS)?.let { settings ->
+            settings.click()
+            device.waitForIdle()
+            device.pressBack()
+            device.waitForIdle()
+        }
+    }
+}
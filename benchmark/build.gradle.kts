@@ -0,0 +1,127 @@
+import groovy.json.JsonOutput
+import groovy.json.JsonSlurper
+
+plugins {
+    alias(libs.plugins.android.library)
+    alias(libs.plugins.kotlin.android)
+    alias(libs.plugins.androidx.benchmark)
+}
+
+// 协议热路径微基准，在真机上运行：./gradlew :benchmark:connectedReleaseAndroidTest :benchmark:checkBenchmarkBaseline
+android {
+    namespace = "com.helywin.leggedjoystick.benchmark"
+    compileSdk = 36
+
+    defaultConfig {
+        minSdk = 26
+        testInstrumentationRunner = "androidx.benchmark.junit4.AndroidBenchmarkRunner"
+    }
+
+    // 基准必须在不可调试的构建上运行
+    testBuildType = "release"
+    buildTypes {
+        release {
+            isDefault = true
+            signingConfig = signingConfigs.getByName("debug")
+        }
+    }
+
+    compileOptions {
+        sourceCompatibility = JavaVersion.VERSION_11
+        targetCompatibility = JavaVersion.VERSION_11
+    }
+    kotlinOptions {
+        jvmTarget = "11"
+    }
+}
+
+dependencies {
+    androidTestImplementation(project(":protocol"))
+    androidTestImplementation(libs.androidx.benchmark.junit4)
+    androidTestImplementation(libs.androidx.test.runner)
+    androidTestImplementation(libs.androidx.junit)
+    androidTestImplementation(libs.junit)
+}
+
+/**
+ * 将设备上的基准结果与 baseline.json 比较
+ * 耗时中位数超过基线 * toleranceRatio 或每次操作分配数超过基线时失败；
+ * 传入 -PupdateBenchmarkBaseline 时用本次结果覆盖基线
+ */
+tasks.register("checkBenchmarkBaseline") {
+    group = "verification"
+    description = "Compare protocol benchmark results with the stored baseline"
+
+    val resultsDir = layout.buildDirectory.dir("outputs/connected_android_test_additional_output")
+    val baselineFile = file("baseline.json")
+    val update = providers.gradleProperty("updateBenchmarkBaseline").isPresent
+
+    doLast {
+        val resultFiles = resultsDir.get().asFile.walkTopDown()
+            .filter { it.isFile && it.name.endsWith("benchmarkData.json") }
+            .toList()
+        if (resultFiles.isEmpty()) {
+            throw GradleException("未找到基准结果，请先运行 connectedReleaseAndroidTest")
+        }
+
+        // 名称 -> (耗时中位数ns, 分配数中位数)
+        val results = linkedMapOf<String, Pair<Double, Double>>()
+        var device = ""
+        resultFiles.forEach { resultFile ->
+            @Suppress("UNCHECKED_CAST")
+            val json = JsonSlurper().parse(resultFile) as Map<String, Any?>
+            val build = (json["context"] as? Map<*, *>)?.get("build") as? Map<*, *>
+            device = "${build?.get("brand")} ${build?.get("model")}".trim()
+            (json["benchmarks"] as List<*>).forEach { entry ->
+                val benchmark = entry as Map<*, *>
+                val name = "${(benchmark["className"] as String).substringAfterLast('.')}.${benchmark["name"]}"
+                val metrics = benchmark["metrics"] as Map<*, *>
+                fun median(metric: String) =
+                    ((metrics[metric] as? Map<*, *>)?.get("median") as? Number)?.toDouble() ?: 0.0
+                results[name] = median("timeNs") to median("allocationCount")
+            }
+        }
+
+        if (update) {
+            val baseline = mapOf(
+                "device" to device,
+                "toleranceRatio" to 1.10,
+                "benchmarks" to results.mapValues { (_, value) ->
+                    mapOf("timeNs" to value.first, "allocationCount" to value.second)
+                }
+            )
+            baselineFile.writeText(JsonOutput.prettyPrint(JsonOutput.toJson(baseline)) + "\n")
+            logger.lifecycle("已更新基准基线: ${results.size} 项（$device）")
+            return@doLast
+        }
+
+        @Suppress("UNCHECKED_CAST")
+        val baseline = JsonSlurper().parse(baselineFile) as Map<String, Any?>
+        val tolerance = (baseline["toleranceRatio"] as Number).toDouble()
+        val expected = baseline["benchmarks"] as Map<*, *>
+        if (baseline["device"] != device) {
+            logger.warn("基线设备为 ${baseline["device"]}，当前设备为 $device，耗时比较仅供参考")
+        }
+
+        val failures = mutableListOf<String>()
+        results.forEach { (name, value) ->
+            val reference = expected[name] as? Map<*, *>
+            if (reference == null) {
+                logger.warn("$name 没有基线数据: ${"%.0f".format(value.first)} ns/op, ${value.second} allocs/op")
+                return@forEach
+            }
+            val timeLimit = (reference["timeNs"] as Number).toDouble() * tolerance
+            val allocLimit = (reference["allocationCount"] as Number).toDouble()
+            if (value.first > timeLimit) {
+                failures += "$name: ${"%.0f".format(value.first)} ns/op > ${"%.0f".format(timeLimit)}"
+            }
+            if (value.second > allocLimit) {
+                failures += "$name: ${value.second} allocs/op > $allocLimit"
+            }
+            logger.lifecycle("$name: ${"%.0f".format(value.first)} ns/op, ${value.second} allocs/op")
+        }
+        if (failures.isNotEmpty()) {
+            throw GradleException("基准结果超过基线:\n" + failures.joinToString("\n"))
+        }
+    }
+}
@@ -0,0 +1,166 @@
+/*********************************************************************************
+ * FileName: ProtocolCodecBenchmark.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 协议编解码微基准：按消息类型测量创建、序列化、反序列化、CRC校验的耗时和分配
+ * Others: 结果中的 timeNs 和 allocationCount 由 checkBenchmarkBaseline 与 baseline.json 比较
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.benchmark
+
+import androidx.benchmark.junit4.BenchmarkRule
+import androidx.benchmark.junit4.measureRepeated
+import com.helywin.leggedjoystick.proto.MessageUtils
+import legged_driver.*
+import org.junit.Assert.assertTrue
+import org.junit.Rule
+import org.junit.Test
+import org.junit.runner.RunWith
+import org.junit.runners.Parameterized
+
+@RunWith(Parameterized::class)
+class ProtocolCodecBenchmark(private val messageType: MessageType) {
+
+    companion object {
+        private const val DEVICE_ID = "remote_1234abcd"
+        private const val TIMESTAMP_MS = 1_760_400_000_000L
+
+        @JvmStatic
+        @Parameterized.Parameters(name = "{0}")
+        fun messageTypes(): List<MessageType> = MessageType.entries
+    }
+
+    @get:Rule
+    val benchmarkRule = BenchmarkRule()
+
+    /**
+     * 按消息类型创建带典型负载的消息（未计算CRC）
+     */
+    private fun create(): LeggedDriverMessage = when (messageType) {
+        MessageType.MESSAGE_TYPE_HEARTBEAT -> build(
+            heartbeat = HeartbeatMessage(
+                is_connected = true,
+                sequence = 12345,
+                send_time_us = 987_654_321L,
+                echo_sequence = 12344,
+                echo_time_us = 987_650_000L,
+                echo_delay_us = 850
+            )
+        )
+        MessageType.MESSAGE_TYPE_BATTERY_INFO -> build(
+            batteryInfo = BatteryInfoMessage(battery_level = 87, voltage = 25.2f, current = 3.4f, temperature = 36.5f)
+        )
+        MessageType.MESSAGE_TYPE_MODE_SET -> build(modeSet = ModeSetMessage(mode = Mode.MODE_MANUAL))
+        MessageType.MESSAGE_TYPE_CONTROL_MODE_SET -> build(
+            controlModeSet = ControlModeSetMessage(control_mode = ControlMode.CONTROL_MODE_LIE_DOWN)
+        )
+        MessageType.MESSAGE_TYPE_VELOCITY_COMMAND -> build(
+            velocityCommand = VelocityCommandMessage(vx = 0.8f, vy = -0.25f, yaw_rate = 0.6f)
+        )
+        MessageType.MESSAGE_TYPE_CURRENT_MODE -> build(currentMode = CurrentModeMessage(mode = Mode.MODE_AUTO))
+        MessageType.MESSAGE_TYPE_CURRENT_CONTROL_MODE -> build(
+            currentControlMode = CurrentControlModeMessage(control_mode = ControlMode.CONTROL_MODE_STAND_UP)
+        )
+        MessageType.MESSAGE_TYPE_ODOMETRY -> build(
+            odometry = OdometryMessage(
+                position = Vector3(x = 1.25f, y = -3.5f, z = 0.32f),
+                orientation = Quaternion(x = 0.01f, y = -0.02f, z = 0.38f, w = 0.92f),
+                linear_velocity = Vector3(x = 0.8f, y = 0.05f, z = 0f),
+                angular_velocity = Vector3(x = 0.001f, y = -0.002f, z = 0.6f)
+            )
+        )
+        MessageType.MESSAGE_TYPE_COMMAND_ACK -> build(
+            commandAck = CommandAckMessage(request_id = 42, accepted = true)
+        )
+        MessageType.MESSAGE_TYPE_UNSPECIFIED -> build()
+    }
+
+    private fun build(
+        heartbeat: HeartbeatMessage? = null,
+        batteryInfo: BatteryInfoMessage? = null,
+        modeSet: ModeSetMessage? = null,
+        controlModeSet: ControlModeSetMessage? = null,
+        velocityCommand: VelocityCommandMessage? = null,
+        currentMode: CurrentModeMessage? = null,
+        currentControlMode: CurrentControlModeMessage? = null,
+        odometry: OdometryMessage? = null,
+        commandAck: CommandAckMessage? = null
+    ): LeggedDriverMessage = MessageUtils.createMessage(
+        TIMESTAMP_MS, DeviceType.DEVICE_TYPE_SERVER, DEVICE_ID, messageType,
+        heartbeat, batteryInfo, modeSet, controlModeSet,
+        velocityCommand, currentMode, currentControlMode, odometry, commandAck
+    )
+
+    @Test
+    fun createMessageWithCRC() {
+        val payload = create()
+        benchmarkRule.measureRepeated {
+            MessageUtils.createMessageWithCRC(
+                TIMESTAMP_MS, DeviceType.DEVICE_TYPE_SERVER, DEVICE_ID, messageType,
+                payload.heartbeat, payload.battery_info, payload.mode_set, payload.control_mode_set,
+                payload.velocity_command, payload.current_mode, payload.current_control_mode, payload.odometry,
+                payload.command_ack
+            )
+        }
+    }
+
+    @Test
+    fun serializeMessage() {
+        // 带CRC的完整消息
+        val message = MessageUtils.deserializeMessage(MessageUtils.encodeFrame(create()))
+        benchmarkRule.measureRepeated {
+            MessageUtils.serializeMessage(message)
+        }
+    }
+
+    @Test
+    fun deserializeMessage() {
+        val data = MessageUtils.encodeFrame(create())
+        benchmarkRule.measureRepeated {
+            MessageUtils.deserializeMessage(data)
+        }
+    }
+
+    @Test
+    fun verifyMessage() {
+        val message = MessageUtils.deserializeMessage(MessageUtils.encodeFrame(create()))
+        assertTrue(MessageUtils.verifyMessage(message))
+        benchmarkRule.measureRepeated {
+            MessageUtils.verifyMessage(message)
+        }
+    }
+
+    @Test
+    fun calculateCRC32() {
+        val data = MessageUtils.serializeMessage(create())
+        benchmarkRule.measureRepeated {
+            MessageUtils.calculateCRC32(data)
+        }
+    }
+
+    @Test
+    fun encodeFrame() {
+        val message = create()
+        benchmarkRule.measureRepeated {
+            MessageUtils.encodeFrame(message)
+        }
+    }
+
+    @Test
+    fun verifyFrame() {
+        val data = MessageUtils.encodeFrame(create())
+        assertTrue(MessageUtils.verifyFrame(data))
+        benchmarkRule.measureRepeated {
+            MessageUtils.verifyFrame(data)
+        }
+    }
+
+    @Test
+    fun decodeFrame() {
+        val data = MessageUtils.encodeFrame(create())
+        benchmarkRule.measureRepeated {
+            MessageUtils.decodeFrame(data)
+        }
+    }
+}
@@ -0,0 +1,97 @@
+import groovy.json.JsonSlurper
+
+plugins {
+    alias(libs.plugins.android.test)
+    alias(libs.plugins.kotlin.android)
+}
+
+// 界面和启动宏基准，在真机上运行：./gradlew :macrobenchmark:connectedBenchmarkReleaseAndroidTest :macrobenchmark:checkFrameTiming
+android {
+    namespace = "com.helywin.leggedjoystick.macrobenchmark"
+    compileSdk = 36
+
+    defaultConfig {
+        minSdk = 26
+        targetSdk = 36
+        testInstrumentationRunner = "androidx.test.runner.AndroidJUnitRunner"
+    }
+
+    buildTypes {
+        // 与基线配置插件为 app 生成的 benchmarkRelease 构建对应（release 优化、调试签名、包含基线配置）
+        create("benchmarkRelease") {
+            isDebuggable = true
+            signingConfig = signingConfigs.getByName("debug")
+            matchingFallbacks += listOf("release")
+        }
+    }
+
+    targetProjectPath = ":app"
+    experimentalProperties["android.experimental.self-instrumenting"] = true
+
+    compileOptions {
+        sourceCompatibility = JavaVersion.VERSION_11
+        targetCompatibility = JavaVersion.VERSION_11
+    }
+    kotlinOptions {
+        jvmTarget = "11"
+    }
+}
+
+dependencies {
+    implementation(libs.androidx.junit)
+    implementation(libs.androidx.uiautomator)
+    implementation(libs.androidx.benchmark.macro.junit4)
+}
+
+androidComponents {
+    beforeVariants(selector().all()) {
+        it.enable = it.buildType == "benchmarkRelease"
+    }
+}
+
+/**
+ * 检查宏基准结果中的掉帧数
+ * frameOverrunMs 大于0的帧即为掉帧，超过 -PmaxJankyFrames（默认0）时失败
+ */
+tasks.register("checkFrameTiming") {
+    group = "verification"
+    description = "Fail when the macrobenchmark frame timing shows janky frames"
+
+    val resultsDir = layout.buildDirectory.dir("outputs/connected_android_test_additional_output")
+    val maxJankyFrames = providers.gradleProperty("maxJankyFrames").map { it.toInt() }.orElse(0)
+
+    doLast {
+        val resultFiles = resultsDir.get().asFile.walkTopDown()
+            .filter { it.isFile && it.name.endsWith("benchmarkData.json") }
+            .toList()
+        if (resultFiles.isEmpty()) {
+            throw GradleException("未找到宏基准结果，请先运行 connectedBenchmarkReleaseAndroidTest")
+        }
+
+        val failures = mutableListOf<String>()
+        resultFiles.forEach { resultFile ->
+            @Suppress("UNCHECKED_CAST")
+            val json = JsonSlurper().parse(resultFile) as Map<String, Any?>
+            (json["benchmarks"] as List<*>).forEach { entry ->
+                val benchmark = entry as Map<*, *>
+                val name = "${(benchmark["className"] as String).substringAfterLast('.')}.${benchmark["name"]}"
+                val overrun = (benchmark["sampledMetrics"] as? Map<*, *>)?.get("frameOverrunMs") as? Map<*, *>
+                if (overrun == null) {
+                    logger.warn("$name 没有 frameOverrunMs 数据（需要 API 31 以上的设备）")
+                    return@forEach
+                }
+                val frames = (overrun["runs"] as List<*>).flatMap { it as List<*> }.map { (it as Number).toDouble() }
+                val janky = frames.count { it > 0.0 }
+                logger.lifecycle(
+                    "$name: ${frames.size} 帧, 掉帧 $janky, P99 overrun ${"%.1f".format(overrun["P99"] as Number)}ms"
+                )
+                if (janky > maxJankyFrames.get()) {
+                    failures += "$name: 掉帧 $janky > ${maxJankyFrames.get()}"
+                }
+            }
+        }
+        if (failures.isNotEmpty()) {
+            throw GradleException("宏基准掉帧超过目标:\n" + failures.joinToString("\n"))
+        }
+    }
+}
@@ -0,0 +1,103 @@
+/*********************************************************************************
+ * FileName: JoystickDragBenchmark.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 主控制界面持续拖动摇杆的帧时间宏基准
+ * Others: 左摇杆连续画圈、右摇杆来回拖动，手指全程不抬起；目标是中端设备上没有掉帧，
+ *         由 checkFrameTiming 检查 frameOverrunMs
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.macrobenchmark
+
+import android.graphics.Point
+import android.graphics.Rect
+import androidx.benchmark.macro.CompilationMode
+import androidx.benchmark.macro.FrameTimingMetric
+import androidx.benchmark.macro.MacrobenchmarkScope
+import androidx.benchmark.macro.StartupMode
+import androidx.benchmark.macro.junit4.MacrobenchmarkRule
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.uiautomator.By
+import androidx.test.uiautomator.Until
+import org.junit.Rule
+import org.junit.Test
+import org.junit.runner.RunWith
+import kotlin.math.cos
+import kotlin.math.min
+import kotlin.math.sin
+
+@RunWith(AndroidJUnit4::class)
+class JoystickDragBenchmark {
+
+    companion object {
+        private const val PACKAGE_NAME = "com.helywin.leggedjoystick"
+        // 与 MainControlScreen 中的测试标签一致
+        private const val LEFT_JOYSTICK_TAG = "left_joystick"
+        private const val RIGHT_JOYSTICK_TAG = "right_joystick"
+        private const val FIND_TIMEOUT_MS = 5_000L
+        private const val ITERATIONS = 5
+        private const val DRAG_LAPS = 4
+        private const val POINTS_PER_LAP = 24
+        private const val STEPS_PER_SEGMENT = 4 // UiAutomator 每步约5ms
+    }
+
+    @get:Rule
+    val benchmarkRule = MacrobenchmarkRule()
+
+    @Test
+    fun sustainedDrag() = benchmarkRule.measureRepeated(
+        packageName = PACKAGE_NAME,
+        metrics = listOf(FrameTimingMetric()),
+        compilationMode = CompilationMode.Partial(),
+        startupMode = StartupMode.WARM,
+        iterations = ITERATIONS,
+        setupBlock = {
+            pressHome()
+            startActivityAndWait()
+        }
+    ) {
+        val left = device.wait(Until.findObject(By.res(LEFT_JOYSTICK_TAG)), FIND_TIMEOUT_MS)
+            ?: error("未找到左摇杆")
+        val right = device.wait(Until.findObject(By.res(RIGHT_JOYSTICK_TAG)), FIND_TIMEOUT_MS)
+            ?: error("未找到右摇杆")
+
+        dragCircles(left.visibleBounds)
+        dragBackAndForth(right.visibleBounds)
+    }
+
+    /**
+     * 在摇杆区域内连续画圈，把手始终离开零位
+     */
+    private fun MacrobenchmarkScope.dragCircles(bounds: Rect) {
+        val radius = min(bounds.width(), bounds.height()) * 0.35
+        val points = Array(DRAG_LAPS * POINTS_PER_LAP + 2) { index ->
+            if (index == 0) {
+                Point(bounds.centerX(), bounds.centerY())
+            } else {
+                val angle = 2 * Math.PI * (index - 1) / POINTS_PER_LAP
+                Point(
+                    bounds.centerX() + (radius * cos(angle)).toInt(),
+                    bounds.centerY() + (radius * sin(angle)).toInt()
+                )
+            }
+        }
+        device.swipe(points, STEPS_PER_SEGMENT)
+    }
+
+    /**
+     * 线性摇杆从中心向两端来回拖动
+     */
+    private fun MacrobenchmarkScope.dragBackAndForth(bounds: Rect) {
+        val reach = (bounds.width() * 0.4).toInt()
+        val points = Array(DRAG_LAPS * 2 + 2) { index ->
+            val x = when {
+                index == 0 || index == DRAG_LAPS * 2 + 1 -> bounds.centerX()
+                index % 2 == 1 -> bounds.centerX() + reach
+                else -> bounds.centerX() - reach
+            }
+            Point(x, bounds.centerY())
+        }
+        device.swipe(points, STEPS_PER_SEGMENT * POINTS_PER_LAP / 4)
+    }
+}
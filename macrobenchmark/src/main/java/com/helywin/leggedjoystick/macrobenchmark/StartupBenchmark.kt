@@ -0,0 +1,52 @@
+/*********************************************************************************
+ * FileName: StartupBenchmark.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 冷启动基准，对比不预编译与使用基线配置预编译
+ * Others: 应用在可以操控时调用 reportFullyDrawn，timeToFullDisplayMs 即启动到可操控的耗时；
+ *         基线配置由 :baselineprofile 生成并打包进被测构建
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.macrobenchmark
+
+import androidx.benchmark.macro.BaselineProfileMode
+import androidx.benchmark.macro.CompilationMode
+import androidx.benchmark.macro.StartupMode
+import androidx.benchmark.macro.StartupTimingMetric
+import androidx.benchmark.macro.junit4.MacrobenchmarkRule
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import org.junit.Rule
+import org.junit.Test
+import org.junit.runner.RunWith
+
+@RunWith(AndroidJUnit4::class)
+class StartupBenchmark {
+
+    companion object {
+        private const val PACKAGE_NAME = "com.helywin.leggedjoystick"
+        private const val ITERATIONS = 10
+    }
+
+    @get:Rule
+    val benchmarkRule = MacrobenchmarkRule()
+
+    @Test
+    fun startupWithoutCompilation() = startup(CompilationMode.None())
+
+    @Test
+    fun startupWithBaselineProfile() = startup(CompilationMode.Partial(BaselineProfileMode.Require))
+
+    private fun startup(compilationMode: CompilationMode) = benchmarkRule.measureRepeated(
+        packageName = PACKAGE_NAME,
+        metrics = listOf(StartupTimingMetric()),
+        compilationMode = compilationMode,
+        startupMode = StartupMode.COLD,
+        iterations = ITERATIONS,
+        setupBlock = {
+            pressHome()
+        }
+    ) {
+        startActivityAndWait()
+    }
+}
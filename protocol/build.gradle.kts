@@ -0,0 +1,57 @@
+plugins {
+    alias(libs.plugins.android.library)
+    alias(libs.plugins.kotlin.android)
+    alias(libs.plugins.wire)
+}
+
+// 协议编解码（Wire 生成的消息类、帧编解码、CRC32、热路径编码器），供 app 和 benchmark 共用
+android {
+    namespace = "com.helywin.leggedjoystick.proto"
+    compileSdk = 36
+
+    defaultConfig {
+        minSdk = 26
+    }
+
+    // 与 app 相同的跟踪开关
+    val tracingOverride = providers.gradleProperty("enableTracing").orNull
+
+    buildTypes {
+        debug {
+            buildConfigField("boolean", "ENABLE_TRACING", tracingOverride ?: "true")
+        }
+        release {
+            buildConfigField("boolean", "ENABLE_TRACING", tracingOverride ?: "false")
+        }
+    }
+    buildFeatures {
+        buildConfig = true
+    }
+
+    compileOptions {
+        sourceCompatibility = JavaVersion.VERSION_11
+        targetCompatibility = JavaVersion.VERSION_11
+    }
+    kotlinOptions {
+        jvmTarget = "11"
+    }
+}
+
+wire {
+    kotlin {
+        android = true
+        javaInterop = true
+    }
+    sourcePath {
+        srcDir("../proto")
+    }
+}
+
+dependencies {
+    // 生成的消息类出现在公开接口中
+    api(libs.wire.runtime)
+    implementation(libs.timber)
+    implementation(libs.androidx.tracing.ktx)
+
+    testImplementation(libs.junit)
+}
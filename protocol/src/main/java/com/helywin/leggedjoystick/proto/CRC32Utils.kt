@@ -0,0 +1,130 @@
+/*********************************************************************************
+ * FileName: CRC32Utils.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: CRC32计算引擎，算法与C++端一致（多项式0xEDB88320，初值/异或值0xFFFFFFFF）
+ * Others: Android 11及以上使用java.util.zip.CRC32（ARMv8上由ART内联为CRC32指令），
+ *         更早的系统使用slicing-by-8查表实现
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.proto
+
+import android.os.Build
+import java.util.zip.CRC32
+import java.util.zip.Checksum
+
+/**
+ * CRC32工具类，实现与C++代码一致的CRC32算法
+ * 所有方法都是线程安全的，查表数据在类初始化时构建
+ */
+internal object CRC32Utils {
+
+    private const val POLYNOMIAL = 0xEDB88320.toInt()
+    const val INITIAL = 0xFFFFFFFF.toInt()
+
+    /**
+     * slicing-by-8查表：8张256项表连续存放，第k张表位于[k * 256, (k + 1) * 256)
+     */
+    private val tables = IntArray(8 * 256).also { table ->
+        for (i in 0 until 256) {
+            var crc = i
+            for (j in 0 until 8) {
+                crc = if ((crc and 1) != 0) (crc ushr 1) xor POLYNOMIAL else crc ushr 1
+            }
+            table[i] = crc
+        }
+        for (k in 1 until 8) {
+            for (i in 0 until 256) {
+                val previous = table[(k - 1) * 256 + i]
+                table[k * 256 + i] = (previous ushr 8) xor table[previous and 0xFF]
+            }
+        }
+    }
+
+    /**
+     * java.util.zip.CRC32与本协议的多项式和初值相同；
+     * 在ART内联CRC32指令之前它走JNI，小帧反而比纯Kotlin查表慢
+     */
+    val useIntrinsic: Boolean = Build.VERSION.SDK_INT >= Build.VERSION_CODES.R
+
+    private val threadChecksum = ThreadLocal.withInitial { newChecksum() }
+
+    /**
+     * 创建新的CRC32累加器
+     */
+    fun newChecksum(): Checksum = if (useIntrinsic) CRC32() else Slicing8Checksum()
+
+    /**
+     * 获取当前线程复用的CRC32累加器（已重置）
+     * 仅可在当前调用栈内使用，不要保存引用
+     */
+    fun threadChecksum(): Checksum = threadChecksum.get()!!.also { it.reset() }
+
+    fun calculate(data: ByteArray): Long {
+        return calculate(data, 0, data.size)
+    }
+
+    fun calculate(data: ByteArray, offset: Int, length: Int): Long {
+        val checksum = threadChecksum()
+        checksum.update(data, offset, length)
+        return checksum.value
+    }
+
+    /**
+     * 在CRC寄存器上累加一段数据（slicing-by-8），可以分段调用
+     */
+    fun update(crc: Int, data: ByteArray, offset: Int, length: Int): Int {
+        var current = crc
+        var pos = offset
+        val end = offset + length
+
+        while (end - pos >= 8) {
+            val one = current xor ((data[pos].toInt() and 0xFF) or
+                    ((data[pos + 1].toInt() and 0xFF) shl 8) or
+                    ((data[pos + 2].toInt() and 0xFF) shl 16) or
+                    ((data[pos + 3].toInt() and 0xFF) shl 24))
+            val two = (data[pos + 4].toInt() and 0xFF) or
+                    ((data[pos + 5].toInt() and 0xFF) shl 8) or
+                    ((data[pos + 6].toInt() and 0xFF) shl 16) or
+                    ((data[pos + 7].toInt() and 0xFF) shl 24)
+            current = tables[7 * 256 + (one and 0xFF)] xor
+                    tables[6 * 256 + ((one ushr 8) and 0xFF)] xor
+                    tables[5 * 256 + ((one ushr 16) and 0xFF)] xor
+                    tables[4 * 256 + (one ushr 24)] xor
+                    tables[3 * 256 + (two and 0xFF)] xor
+                    tables[2 * 256 + ((two ushr 8) and 0xFF)] xor
+                    tables[256 + ((two ushr 16) and 0xFF)] xor
+                    tables[two ushr 24]
+            pos += 8
+        }
+        while (pos < end) {
+            current = tables[(current xor data[pos].toInt()) and 0xFF] xor (current ushr 8)
+            pos++
+        }
+        return current
+    }
+
+    fun finish(crc: Int): Int = crc xor 0xFFFFFFFF.toInt()
+
+    /**
+     * 基于slicing-by-8查表的累加器，用于不支持CRC32指令内联的系统
+     */
+    class Slicing8Checksum : Checksum {
+        private var crc = INITIAL
+
+        override fun update(b: Int) {
+            crc = tables[(crc xor b) and 0xFF] xor (crc ushr 8)
+        }
+
+        override fun update(b: ByteArray, off: Int, len: Int) {
+            crc = CRC32Utils.update(crc, b, off, len)
+        }
+
+        override fun getValue(): Long = finish(crc).toLong() and 0xFFFFFFFFL
+
+        override fun reset() {
+            crc = INITIAL
+        }
+    }
+}
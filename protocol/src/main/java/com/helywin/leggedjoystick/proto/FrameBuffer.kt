@@ -0,0 +1,69 @@
+/*********************************************************************************
+ * FileName: FrameBuffer.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 可复用的发送帧缓冲区及其对象池
+ * Others: 高频消息（速度指令、心跳）编码到池化缓冲区后直接交给socket发送，稳态下不分配内存
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.proto
+
+import java.util.concurrent.ArrayBlockingQueue
+
+/**
+ * 发送帧缓冲区，有效数据为 bytes[0, length)
+ */
+class FrameBuffer(capacity: Int = DEFAULT_CAPACITY) {
+    companion object {
+        const val DEFAULT_CAPACITY = 128
+    }
+
+    var bytes = ByteArray(capacity)
+        private set
+    var length = 0
+
+    /**
+     * 保证容量不小于 [capacity]，扩容时不保留原有数据
+     */
+    fun ensureCapacity(capacity: Int) {
+        if (bytes.size < capacity) {
+            bytes = ByteArray(maxOf(capacity, bytes.size * 2))
+        }
+    }
+
+    /**
+     * 拷贝一段已编码的数据
+     */
+    fun set(data: ByteArray) {
+        ensureCapacity(data.size)
+        data.copyInto(bytes)
+        length = data.size
+    }
+
+    /**
+     * 复制有效数据为新的字节数组（仅用于调试和非热路径）
+     */
+    fun toByteArray(): ByteArray = bytes.copyOf(length)
+}
+
+/**
+ * 帧缓冲区对象池，线程安全
+ * ArrayBlockingQueue的存取不会分配节点对象；池空时新建，池满时丢弃归还的缓冲区
+ */
+class FrameBufferPool(maxPooled: Int) {
+    private val pool = ArrayBlockingQueue<FrameBuffer>(maxPooled)
+
+    fun acquire(): FrameBuffer = pool.poll() ?: FrameBuffer()
+
+    fun release(buffer: FrameBuffer) {
+        buffer.length = 0
+        pool.offer(buffer)
+    }
+
+    /**
+     * 当前空闲的缓冲区数量
+     */
+    val available: Int
+        get() = pool.size
+}
@@ -0,0 +1,201 @@
+/*********************************************************************************
+ * FileName: HotPathEncoder.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 高频消息（速度指令、心跳）的预分配编码器，直接写入 FrameBuffer
+ * Others: 输出与 Wire + MessageUtils.encodeFrame 逐字节一致：
+ *         字段按声明顺序编码，proto3默认值不编码，浮点数按位判断（-0.0会被编码），末尾追加crc32字段
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.proto
+
+import legged_driver.DeviceType
+import legged_driver.MessageType
+
+/**
+ * 心跳中的链路统计字段，由发送方复用
+ */
+class HeartbeatFields {
+    var sequence = 0
+    var sendTimeUs = 0L
+    var echoSequence = 0
+    var echoTimeUs = 0L
+    var echoDelayUs = 0
+    var requestState = false
+}
+
+/**
+ * 高频消息编码器，每个客户端一个实例
+ * 设备类型和设备ID在构造时预编码，编码过程不创建Wire消息对象
+ * 编码方法本身无共享可变状态，多个线程可以同时使用（各自写入自己的FrameBuffer）
+ */
+class HotPathEncoder(deviceType: DeviceType, deviceId: String) {
+    companion object {
+        // LeggedDriverMessage 字段tag
+        private const val TAG_TIMESTAMP_MS = (1 shl 3) or 0
+        private const val TAG_DEVICE_TYPE = (2 shl 3) or 0
+        private const val TAG_DEVICE_ID = (3 shl 3) or 2
+        private const val TAG_MESSAGE_TYPE = (4 shl 3) or 0
+        private const val TAG_HEARTBEAT = (10 shl 3) or 2
+        private const val TAG_VELOCITY_COMMAND = (14 shl 3) or 2
+
+        // 消息体字段tag
+        private const val TAG_HEARTBEAT_IS_CONNECTED = (1 shl 3) or 0
+        private const val TAG_HEARTBEAT_SEQUENCE = (2 shl 3) or 0
+        private const val TAG_HEARTBEAT_SEND_TIME_US = (3 shl 3) or 0
+        private const val TAG_HEARTBEAT_ECHO_SEQUENCE = (4 shl 3) or 0
+        private const val TAG_HEARTBEAT_ECHO_TIME_US = (5 shl 3) or 0
+        private const val TAG_HEARTBEAT_ECHO_DELAY_US = (6 shl 3) or 0
+        private const val TAG_HEARTBEAT_REQUEST_STATE = (7 shl 3) or 0
+        private const val TAG_VELOCITY_VX = (1 shl 3) or 5
+        private const val TAG_VELOCITY_VY = (2 shl 3) or 5
+        private const val TAG_VELOCITY_YAW_RATE = (3 shl 3) or 5
+
+        // 帧中除设备信息外的最大长度：时间戳(11) + 消息类型(2) + 消息体(最长为心跳，46) + crc32(7)
+        private const val MAX_VARIABLE_SIZE = 80
+    }
+
+    // 预编码的 device_type + device_id 字段
+    private val devicePrefix: ByteArray = run {
+        val idBytes = deviceId.toByteArray(Charsets.UTF_8)
+        val out = ByteArray(16 + idBytes.size)
+        var pos = 0
+        if (deviceType.value != 0) {
+            out[pos++] = TAG_DEVICE_TYPE.toByte()
+            pos = writeVarint64(deviceType.value.toLong(), out, pos)
+        }
+        if (idBytes.isNotEmpty()) {
+            out[pos++] = TAG_DEVICE_ID.toByte()
+            pos = MessageUtils.writeVarint32(idBytes.size, out, pos)
+            idBytes.copyInto(out, pos)
+            pos += idBytes.size
+        }
+        out.copyOf(pos)
+    }
+
+    private val maxFrameSize = devicePrefix.size + MAX_VARIABLE_SIZE
+
+    /**
+     * 编码速度指令帧
+     */
+    fun encodeVelocityCommand(
+        frame: FrameBuffer,
+        timestampMs: Long,
+        vx: Float,
+        vy: Float,
+        yawRate: Float
+    ) = ProtoTrace.section(ProtoTrace.ENCODE_VELOCITY) {
+        frame.ensureCapacity(maxFrameSize)
+        val out = frame.bytes
+        var pos = writeHeader(out, timestampMs, MessageType.MESSAGE_TYPE_VELOCITY_COMMAND)
+
+        // VelocityCommandMessage 消息体，长度必然小于128，用一个字节表示
+        out[pos++] = TAG_VELOCITY_COMMAND.toByte()
+        val lengthPos = pos++
+        val bodyStart = pos
+        pos = writeFloatField(TAG_VELOCITY_VX, vx, out, pos)
+        pos = writeFloatField(TAG_VELOCITY_VY, vy, out, pos)
+        pos = writeFloatField(TAG_VELOCITY_YAW_RATE, yawRate, out, pos)
+        out[lengthPos] = (pos - bodyStart).toByte()
+
+        frame.length = appendCRC32(out, pos)
+    }
+
+    /**
+     * 编码心跳帧
+     */
+    fun encodeHeartbeat(
+        frame: FrameBuffer,
+        timestampMs: Long,
+        isConnected: Boolean,
+        fields: HeartbeatFields? = null
+    ) = ProtoTrace.section(ProtoTrace.ENCODE_HEARTBEAT) {
+        frame.ensureCapacity(maxFrameSize)
+        val out = frame.bytes
+        var pos = writeHeader(out, timestampMs, MessageType.MESSAGE_TYPE_HEARTBEAT)
+
+        // HeartbeatMessage 消息体，长度必然小于128，用一个字节表示
+        out[pos++] = TAG_HEARTBEAT.toByte()
+        val lengthPos = pos++
+        val bodyStart = pos
+        if (isConnected) {
+            out[pos++] = TAG_HEARTBEAT_IS_CONNECTED.toByte()
+            out[pos++] = 1
+        }
+        if (fields != null) {
+            pos = writeVarintField(TAG_HEARTBEAT_SEQUENCE, fields.sequence.toLong() and 0xFFFFFFFFL, out, pos)
+            pos = writeVarintField(TAG_HEARTBEAT_SEND_TIME_US, fields.sendTimeUs, out, pos)
+            pos = writeVarintField(TAG_HEARTBEAT_ECHO_SEQUENCE, fields.echoSequence.toLong() and 0xFFFFFFFFL, out, pos)
+            pos = writeVarintField(TAG_HEARTBEAT_ECHO_TIME_US, fields.echoTimeUs, out, pos)
+            pos = writeVarintField(TAG_HEARTBEAT_ECHO_DELAY_US, fields.echoDelayUs.toLong() and 0xFFFFFFFFL, out, pos)
+            if (fields.requestState) {
+                out[pos++] = TAG_HEARTBEAT_REQUEST_STATE.toByte()
+                out[pos++] = 1
+            }
+        }
+        out[lengthPos] = (pos - bodyStart).toByte()
+
+        frame.length = appendCRC32(out, pos)
+    }
+
+    /**
+     * 写入 timestamp_ms、设备信息和 message_type 字段
+     */
+    private fun writeHeader(out: ByteArray, timestampMs: Long, messageType: MessageType): Int {
+        var pos = 0
+        if (timestampMs != 0L) {
+            out[pos++] = TAG_TIMESTAMP_MS.toByte()
+            pos = writeVarint64(timestampMs, out, pos)
+        }
+        devicePrefix.copyInto(out, pos)
+        pos += devicePrefix.size
+        out[pos++] = TAG_MESSAGE_TYPE.toByte()
+        return writeVarint64(messageType.value.toLong(), out, pos)
+    }
+
+    /**
+     * 编码varint字段，默认值0不编码
+     */
+    private fun writeVarintField(tag: Int, value: Long, out: ByteArray, offset: Int): Int {
+        if (value == 0L) return offset
+        out[offset] = tag.toByte()
+        return writeVarint64(value, out, offset + 1)
+    }
+
+    /**
+     * 编码float字段，与Wire一致按位比较默认值
+     */
+    private fun writeFloatField(tag: Int, value: Float, out: ByteArray, offset: Int): Int {
+        val bits = value.toRawBits()
+        if (bits == 0) return offset
+        var pos = offset
+        out[pos++] = tag.toByte()
+        out[pos++] = bits.toByte()
+        out[pos++] = (bits ushr 8).toByte()
+        out[pos++] = (bits ushr 16).toByte()
+        out[pos++] = (bits ushr 24).toByte()
+        return pos
+    }
+
+    /**
+     * 在 [0, bodyEnd) 上计算CRC32并追加crc32字段，返回帧长度
+     */
+    private fun appendCRC32(out: ByteArray, bodyEnd: Int): Int {
+        val crc = CRC32Utils.calculate(out, 0, bodyEnd).toInt()
+        if (crc == 0) return bodyEnd
+        val pos = MessageUtils.writeVarint32(MessageUtils.CRC32_FIELD_TAG, out, bodyEnd)
+        return MessageUtils.writeVarint32(crc, out, pos)
+    }
+
+    private fun writeVarint64(value: Long, out: ByteArray, offset: Int): Int {
+        var pos = offset
+        var v = value
+        while (v and 0x7FL.inv() != 0L) {
+            out[pos++] = ((v and 0x7F) or 0x80).toByte()
+            v = v ushr 7
+        }
+        out[pos++] = v.toByte()
+        return pos
+    }
+}
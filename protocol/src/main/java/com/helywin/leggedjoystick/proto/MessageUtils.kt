@@ -0,0 +1,494 @@
+package com.helywin.leggedjoystick.proto
+
+import legged_driver.*
+import okio.Buffer
+import timber.log.Timber
+import java.util.UUID
+
+object MessageUtils {
+
+    // crc32字段（字段号20，varint）的tag编码: (20 << 3) | 0 = 160 -> 0xA0 0x01
+    private const val CRC32_FIELD_NUMBER = 20
+    internal const val CRC32_FIELD_TAG = CRC32_FIELD_NUMBER shl 3
+    internal const val CRC32_FIELD_TAG_SIZE = 2
+
+    // message_type 字段号，分发前只读取这个字段判断是否需要完整解码
+    private const val MESSAGE_TYPE_FIELD_NUMBER = 4
+
+    // protobuf wire type
+    private const val WIRE_TYPE_VARINT = 0
+    private const val WIRE_TYPE_FIXED64 = 1
+    private const val WIRE_TYPE_LENGTH_DELIMITED = 2
+    private const val WIRE_TYPE_FIXED32 = 5
+
+    /**
+     * 编码用的线程私有缓冲区，避免每帧重复分配
+     */
+    private class EncodeScratch {
+        val buffer = Buffer()
+        var bytes = ByteArray(256)
+    }
+
+    private val encodeScratch = ThreadLocal.withInitial { EncodeScratch() }
+    
+    /**
+     * 计算CRC32校验码（使用与C++一致的算法）
+     */
+    fun calculateCRC32(data: ByteArray): Int {
+        return CRC32Utils.calculate(data).toInt()
+    }
+
+    /**
+     * 测试CRC32实现（用于调试）
+     */
+    fun testCRC32() {
+        Timber.d("开始CRC32测试...")
+        
+        // 测试已知数据的CRC32值
+        val testData = "Hello, World!".toByteArray()
+        val crc = calculateCRC32(testData)
+        Timber.d("CRC32 of 'Hello, World!': 0x${crc.toString(16).uppercase()}")
+        
+        // 测试空数据
+        val emptyCRC = calculateCRC32(byteArrayOf())
+        Timber.d("CRC32 of empty data: 0x${emptyCRC.toString(16).uppercase()}")
+        
+        // 测试单字节数据
+        val singleByteCRC = calculateCRC32(byteArrayOf(0x41)) // 'A'
+        Timber.d("CRC32 of 'A': 0x${singleByteCRC.toString(16).uppercase()}")
+        
+        // 测试消息序列化和CRC32计算
+        val testMessage = createHeartbeatMessage(
+            DeviceType.DEVICE_TYPE_REMOTE_CONTROLLER,
+            "test_device",
+            true
+        )
+        
+        val serialized = encodeFrame(testMessage)
+        Timber.d("编码帧长度: ${serialized.size} bytes")
+        
+        // 验证帧
+        val isValid = verifyFrame(serialized)
+        Timber.d("帧CRC32验证结果: $isValid")
+        
+        // 测试反序列化
+        try {
+            val deserialized = deserializeMessage(serialized)
+            Timber.d("反序列化成功，CRC32: 0x${deserialized.crc32.toString(16).uppercase()}")
+            
+            val isDeserializedValid = verifyMessage(deserialized)
+            Timber.d("反序列化消息CRC32验证结果: $isDeserializedValid")
+        } catch (e: Exception) {
+            Timber.e(e, "反序列化失败")
+        }
+    }
+
+    /**
+     * 生成设备ID
+     */
+    fun generateDeviceId(deviceType: DeviceType): String {
+        val prefix = when (deviceType) {
+            DeviceType.DEVICE_TYPE_SERVER -> "server"
+            DeviceType.DEVICE_TYPE_NAVIGATION -> "nav"
+            DeviceType.DEVICE_TYPE_REMOTE_CONTROLLER -> "remote"
+            else -> "unknown"
+        }
+        val uuid = UUID.randomUUID().toString().substring(0, 8)
+        return "${prefix}_$uuid"
+    }
+
+    /**
+     * 创建消息（不含CRC32，CRC32在 [encodeFrame] 编码时写入）
+     */
+    fun createMessage(
+        timestampMs: Long,
+        deviceType: DeviceType,
+        deviceId: String,
+        messageType: MessageType,
+        heartbeat: HeartbeatMessage? = null,
+        batteryInfo: BatteryInfoMessage? = null,
+        modeSet: ModeSetMessage? = null,
+        controlModeSet: ControlModeSetMessage? = null,
+        velocityCommand: VelocityCommandMessage? = null,
+        currentMode: CurrentModeMessage? = null,
+        currentControlMode: CurrentControlModeMessage? = null,
+        odometry: OdometryMessage? = null,
+        commandAck: CommandAckMessage? = null,
+        requestId: Int = 0
+    ): LeggedDriverMessage {
+        // CRC32字段设为0（proto3默认值不编码，计算CRC32时不会包含CRC32本身）
+        return LeggedDriverMessage.Builder()
+            .timestamp_ms(timestampMs)
+            .device_type(deviceType)
+            .device_id(deviceId)
+            .message_type(messageType)
+            .request_id(requestId)
+            .crc32(0) // CRC32字段在计算时必须为0
+            .also { builder ->
+                heartbeat?.let { builder.heartbeat(it) }
+                batteryInfo?.let { builder.battery_info(it) }
+                modeSet?.let { builder.mode_set(it) }
+                controlModeSet?.let { builder.control_mode_set(it) }
+                velocityCommand?.let { builder.velocity_command(it) }
+                currentMode?.let { builder.current_mode(it) }
+                currentControlMode?.let { builder.current_control_mode(it) }
+                odometry?.let { builder.odometry(it) }
+                commandAck?.let { builder.command_ack(it) }
+            }
+            .build()
+    }
+
+    /**
+     * 创建消息并计算CRC32
+     * 注意：CRC32是对整个消息序列化数据计算的，但计算时crc32字段应该为0
+     * 发送路径请使用 [createMessage] + [encodeFrame]，避免重复编码
+     */
+    fun createMessageWithCRC(
+        timestampMs: Long,
+        deviceType: DeviceType,
+        deviceId: String,
+        messageType: MessageType,
+        heartbeat: HeartbeatMessage? = null,
+        batteryInfo: BatteryInfoMessage? = null,
+        modeSet: ModeSetMessage? = null,
+        controlModeSet: ControlModeSetMessage? = null,
+        velocityCommand: VelocityCommandMessage? = null,
+        currentMode: CurrentModeMessage? = null,
+        currentControlMode: CurrentControlModeMessage? = null,
+        odometry: OdometryMessage? = null,
+        commandAck: CommandAckMessage? = null
+    ): LeggedDriverMessage {
+        val message = createMessage(
+            timestampMs, deviceType, deviceId, messageType,
+            heartbeat, batteryInfo, modeSet, controlModeSet,
+            velocityCommand, currentMode, currentControlMode, odometry, commandAck
+        )
+        return message.copy(crc32 = calculateMessageCRC32(message))
+    }
+
+    /**
+     * 计算消息的CRC32（忽略消息中已有的crc32字段）
+     */
+    private fun calculateMessageCRC32(message: LeggedDriverMessage): Int {
+        val body = if (message.crc32 == 0) message else message.copy(crc32 = 0)
+        return calculateCRC32(serializeMessage(body))
+    }
+
+    /**
+     * 编码发送帧：消息只编码一次，随后在帧尾追加crc32字段
+     * 与C++端一致：CRC32在crc32=0（即不含字段20）的序列化数据上计算
+     */
+    fun encodeFrame(message: LeggedDriverMessage): ByteArray = ProtoTrace.section(ProtoTrace.ENCODE_FRAME) {
+        val body = if (message.crc32 == 0) message else message.copy(crc32 = 0)
+        val scratch = encodeScratch.get()!!
+
+        scratch.buffer.clear()
+        LeggedDriverMessage.ADAPTER.encode(scratch.buffer, body)
+        val bodySize = scratch.buffer.size.toInt()
+        if (scratch.bytes.size < bodySize) {
+            scratch.bytes = ByteArray(maxOf(bodySize, scratch.bytes.size * 2))
+        }
+        var read = 0
+        while (read < bodySize) {
+            read += scratch.buffer.read(scratch.bytes, read, bodySize - read)
+        }
+
+        val crc = CRC32Utils.calculate(scratch.bytes, 0, bodySize).toInt()
+
+        // proto3中crc32为0时不编码该字段
+        val frameSize = if (crc == 0) bodySize else bodySize + CRC32_FIELD_TAG_SIZE + varint32Size(crc)
+        val frame = scratch.bytes.copyOf(frameSize)
+        if (crc != 0) {
+            writeVarint32(crc, frame, writeVarint32(CRC32_FIELD_TAG, frame, bodySize))
+        }
+        frame
+    }
+
+    /**
+     * 直接在接收到的原始字节上校验CRC32：跳过crc32字段的字节，其余字节参与计算
+     * 不需要先解码消息
+     */
+    fun verifyFrame(data: ByteArray, offset: Int = 0, length: Int = data.size - offset): Boolean =
+        ProtoTrace.section(ProtoTrace.VERIFY_FRAME) { verifyFrameFields(data, offset, length) }
+
+    private fun verifyFrameFields(data: ByteArray, offset: Int, length: Int): Boolean {
+        val end = offset + length
+        var pos = offset
+        var segmentStart = offset
+        val checksum = CRC32Utils.threadChecksum()
+        var receivedCRC = 0
+
+        while (pos < end) {
+            val fieldStart = pos
+
+            // 读取tag
+            val tagEnd = varintEnd(data, pos, end)
+            if (tagEnd < 0) return false
+            val tag = decodeVarint32(data, pos)
+            pos = tagEnd
+
+            when (tag and 0x7) {
+                WIRE_TYPE_VARINT -> {
+                    val valueEnd = varintEnd(data, pos, end)
+                    if (valueEnd < 0) return false
+                    if ((tag ushr 3) == CRC32_FIELD_NUMBER) {
+                        checksum.update(data, segmentStart, fieldStart - segmentStart)
+                        segmentStart = valueEnd
+                        receivedCRC = decodeVarint32(data, pos)
+                    }
+                    pos = valueEnd
+                }
+                WIRE_TYPE_FIXED64 -> pos += 8
+                WIRE_TYPE_FIXED32 -> pos += 4
+                WIRE_TYPE_LENGTH_DELIMITED -> {
+                    val sizeEnd = varintEnd(data, pos, end)
+                    if (sizeEnd < 0) return false
+                    val size = decodeVarint32(data, pos)
+                    if (size < 0 || size > end - sizeEnd) return false
+                    pos = sizeEnd + size
+                }
+                else -> return false
+            }
+            if (pos > end) return false
+        }
+
+        checksum.update(data, segmentStart, end - segmentStart)
+        return checksum.value.toInt() == receivedCRC
+    }
+
+    /**
+     * 校验并解码接收帧，CRC32校验失败时返回null
+     */
+    fun decodeFrame(data: ByteArray): LeggedDriverMessage? = ProtoTrace.section(ProtoTrace.DECODE_FRAME) {
+        if (!verifyFrame(data)) {
+            Timber.w("CRC32校验失败 - 数据长度: ${data.size}")
+            null
+        } else {
+            deserializeMessage(data)
+        }
+    }
+
+    /**
+     * 不解码消息，直接从原始字节读取 message_type（字段号4）的枚举值
+     * 只遍历顶层字段，不创建对象；字段缺失时返回0（UNSPECIFIED），数据不完整时返回-1
+     */
+    fun peekMessageType(data: ByteArray, offset: Int = 0, length: Int = data.size - offset): Int {
+        val end = offset + length
+        var pos = offset
+        while (pos < end) {
+            val tagEnd = varintEnd(data, pos, end)
+            if (tagEnd < 0) return -1
+            val tag = decodeVarint32(data, pos)
+            pos = tagEnd
+
+            when (tag and 0x7) {
+                WIRE_TYPE_VARINT -> {
+                    val valueEnd = varintEnd(data, pos, end)
+                    if (valueEnd < 0) return -1
+                    if ((tag ushr 3) == MESSAGE_TYPE_FIELD_NUMBER) {
+                        return decodeVarint32(data, pos)
+                    }
+                    pos = valueEnd
+                }
+                WIRE_TYPE_FIXED64 -> pos += 8
+                WIRE_TYPE_FIXED32 -> pos += 4
+                WIRE_TYPE_LENGTH_DELIMITED -> {
+                    val sizeEnd = varintEnd(data, pos, end)
+                    if (sizeEnd < 0) return -1
+                    val size = decodeVarint32(data, pos)
+                    if (size < 0 || size > end - sizeEnd) return -1
+                    pos = sizeEnd + size
+                }
+                else -> return -1
+            }
+        }
+        return if (pos == end) 0 else -1
+    }
+
+    /**
+     * 返回从start开始的varint结束后的位置，数据不完整或超过10字节时返回-1
+     */
+    private fun varintEnd(data: ByteArray, start: Int, end: Int): Int {
+        var pos = start
+        val limit = minOf(end, start + 10)
+        while (pos < limit) {
+            if (data[pos++].toInt() and 0x80 == 0) {
+                return pos
+            }
+        }
+        return -1
+    }
+
+    /**
+     * 解码varint的低32位（调用前需由 [varintEnd] 确认数据完整）
+     */
+    private fun decodeVarint32(data: ByteArray, start: Int): Int {
+        var result = 0
+        var shift = 0
+        var pos = start
+        while (shift < 32) {
+            val b = data[pos++].toInt()
+            result = result or ((b and 0x7F) shl shift)
+            if (b and 0x80 == 0) break
+            shift += 7
+        }
+        return result
+    }
+
+    internal fun varint32Size(value: Int): Int {
+        var size = 1
+        var v = value
+        while (v and 0x7F.inv() != 0) {
+            size++
+            v = v ushr 7
+        }
+        return size
+    }
+
+    /**
+     * 写入varint，返回写入结束后的位置
+     */
+    internal fun writeVarint32(value: Int, out: ByteArray, offset: Int): Int {
+        var pos = offset
+        var v = value
+        while (v and 0x7F.inv() != 0) {
+            out[pos++] = ((v and 0x7F) or 0x80).toByte()
+            v = v ushr 7
+        }
+        out[pos++] = v.toByte()
+        return pos
+    }
+
+    /**
+     * 序列化消息为字节数组
+     */
+    fun serializeMessage(message: LeggedDriverMessage): ByteArray {
+        return message.encode()
+    }
+
+    /**
+     * 反序列化字节数组为消息
+     */
+    fun deserializeMessage(data: ByteArray): LeggedDriverMessage {
+        return LeggedDriverMessage.ADAPTER.decode(data)
+    }
+
+    /**
+     * 验证消息的CRC32校验码
+     * 接收路径请直接使用 [verifyFrame] 校验原始字节
+     */
+    fun verifyMessage(message: LeggedDriverMessage): Boolean {
+        val originalCRC = message.crc32
+        val calculatedCRC = calculateMessageCRC32(message)
+
+        val isValid = calculatedCRC == originalCRC
+
+        if (!isValid) {
+            Timber.w("CRC32校验失败 - 原始: 0x${originalCRC.toString(16).uppercase()}, " +
+                    "计算得到: 0x${calculatedCRC.toString(16).uppercase()}")
+        }
+
+        return isValid
+    }
+
+    /**
+     * 获取当前时间戳（毫秒）
+     */
+    fun getCurrentTimestampMs(): Long {
+        return System.currentTimeMillis()
+    }
+
+    /**
+     * 创建心跳消息
+     */
+    fun createHeartbeatMessage(
+        deviceType: DeviceType,
+        deviceId: String,
+        isConnected: Boolean = true
+    ): LeggedDriverMessage {
+        return createMessage(
+            timestampMs = getCurrentTimestampMs(),
+            deviceType = deviceType,
+            deviceId = deviceId,
+            messageType = MessageType.MESSAGE_TYPE_HEARTBEAT,
+            heartbeat = HeartbeatMessage(is_connected = isConnected)
+        )
+    }
+
+    /**
+     * 创建模式设置消息
+     */
+    fun createModeSetMessage(
+        deviceType: DeviceType,
+        deviceId: String,
+        mode: Mode,
+        requestId: Int = 0
+    ): LeggedDriverMessage {
+        return createMessage(
+            timestampMs = getCurrentTimestampMs(),
+            deviceType = deviceType,
+            deviceId = deviceId,
+            messageType = MessageType.MESSAGE_TYPE_MODE_SET,
+            modeSet = ModeSetMessage(mode = mode),
+            requestId = requestId
+        )
+    }
+
+    /**
+     * 创建控制模式设置消息
+     */
+    fun createControlModeSetMessage(
+        deviceType: DeviceType,
+        deviceId: String,
+        controlMode: ControlMode,
+        requestId: Int = 0
+    ): LeggedDriverMessage {
+        return createMessage(
+            timestampMs = getCurrentTimestampMs(),
+            deviceType = deviceType,
+            deviceId = deviceId,
+            messageType = MessageType.MESSAGE_TYPE_CONTROL_MODE_SET,
+            controlModeSet = ControlModeSetMessage(control_mode = controlMode),
+            requestId = requestId
+        )
+    }
+
+    /**
+     * 创建速度指令消息
+     */
+    fun createVelocityCommandMessage(
+        deviceType: DeviceType,
+        deviceId: String,
+        vx: Float,
+        vy: Float,
+        yawRate: Float
+    ): LeggedDriverMessage {
+        return createMessage(
+            timestampMs = getCurrentTimestampMs(),
+            deviceType = deviceType,
+            deviceId = deviceId,
+            messageType = MessageType.MESSAGE_TYPE_VELOCITY_COMMAND,
+            velocityCommand = VelocityCommandMessage(vx = vx, vy = vy, yaw_rate = yawRate)
+        )
+    }
+}
+
+/**
+ * 模式枚举的显示名称扩展属性
+ */
+val Mode.displayName: String
+    get() = when (this) {
+        Mode.MODE_AUTO -> "自动模式"
+        Mode.MODE_MANUAL -> "手动模式"
+    }
+
+/**
+ * 控制模式枚举的显示名称扩展属性
+ */
+val ControlMode.displayName: String
+    get() = when (this) {
+        ControlMode.CONTROL_MODE_PASSIVE -> "阻尼模式"
+        ControlMode.CONTROL_MODE_STAND_UP -> "站立模式"
+        ControlMode.CONTROL_MODE_LIE_DOWN -> "趴下模式"
+        ControlMode.CONTROL_MODE_UNSPECIFIED -> "未指定控制模式"
+    }
\ No newline at end of file
@@ -0,0 +1,30 @@
+/*********************************************************************************
+ * FileName: ProtoTrace.kt
+ * Author: helywin <jiang770882022@hotmail.com>
+ * Version: 0.1.0
+ * Date: 2025-10-14
+ * Description: 协议编解码的系统跟踪区段
+ * Others: 由本模块的 BuildConfig.ENABLE_TRACING 控制，与 app 的开关一致
+ *********************************************************************************/
+
+package com.helywin.leggedjoystick.proto
+
+import androidx.tracing.Trace
+
+internal object ProtoTrace {
+    const val ENCODE_FRAME = "Proto.encodeFrame"
+    const val VERIFY_FRAME = "Proto.verifyFrame"
+    const val DECODE_FRAME = "Proto.decodeFrame"
+    const val ENCODE_VELOCITY = "Proto.encodeVelocity"
+    const val ENCODE_HEARTBEAT = "Proto.encodeHeartbeat"
+
+    inline fun <T> section(name: String, block: () -> T): T {
+        if (!BuildConfig.ENABLE_TRACING) return block()
+        Trace.beginSection(name)
+        try {
+            return block()
+        } finally {
+            Trace.endSection()
+        }
+    }
+}
@@ -0,0 +1,74 @@
+package com.helywin.leggedjoystick.proto
+
+import org.junit.Assert.*
+import org.junit.Test
+import java.util.zip.CRC32
+import kotlin.random.Random
+
+/**
+ * CRC32引擎一致性测试，耗时见 :benchmark 的 ProtocolCodecBenchmark
+ */
+class CRC32UtilsTest {
+
+    /**
+     * 与C++端相同的逐字节查表实现，作为参考
+     */
+    private object ReferenceCRC32 {
+        private val table = IntArray(256) { i ->
+            var crc = i
+            for (j in 0 until 8) {
+                crc = if ((crc and 1) != 0) (crc ushr 1) xor 0xEDB88320.toInt() else crc ushr 1
+            }
+            crc
+        }
+
+        fun calculate(data: ByteArray, offset: Int = 0, length: Int = data.size - offset): Int {
+            var crc = 0xFFFFFFFF.toInt()
+            for (i in offset until offset + length) {
+                crc = table[(crc xor (data[i].toInt() and 0xFF)) and 0xFF] xor (crc ushr 8)
+            }
+            return crc xor 0xFFFFFFFF.toInt()
+        }
+    }
+
+    @Test
+    fun knownVectors() {
+        // CRC-32/ISO-HDLC标准校验值
+        assertEquals(0xCBF43926.toInt(), MessageUtils.calculateCRC32("123456789".toByteArray()))
+        assertEquals(0, MessageUtils.calculateCRC32(byteArrayOf()))
+        assertEquals(0xEC4AC3D0.toInt(), MessageUtils.calculateCRC32("Hello, World!".toByteArray()))
+        assertEquals(0xD3D99E8B.toInt(), MessageUtils.calculateCRC32(byteArrayOf(0x41)))
+    }
+
+    @Test
+    fun slicing8_matchesReferenceAndZip() {
+        val random = Random(20251014)
+        for (length in 0..300) {
+            val data = random.nextBytes(length + 16)
+            val offset = random.nextInt(16)
+            val expected = ReferenceCRC32.calculate(data, offset, length)
+
+            val slicing = CRC32Utils.Slicing8Checksum()
+            slicing.update(data, offset, length)
+            assertEquals("slicing-by-8 length=$length", expected, slicing.value.toInt())
+
+            val zip = CRC32()
+            zip.update(data, offset, length)
+            assertEquals("zip length=$length", expected, zip.value.toInt())
+        }
+    }
+
+    @Test
+    fun segmentedUpdate_matchesSinglePass() {
+        val random = Random(7)
+        val data = random.nextBytes(257)
+        val expected = ReferenceCRC32.calculate(data)
+        for (split in data.indices) {
+            val checksum = CRC32Utils.Slicing8Checksum()
+            checksum.update(data, 0, split)
+            checksum.update(data[split].toInt())
+            checksum.update(data, split + 1, data.size - split - 1)
+            assertEquals("split=$split", expected, checksum.value.toInt())
+        }
+    }
+}
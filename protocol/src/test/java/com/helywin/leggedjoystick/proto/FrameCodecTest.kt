@@ -0,0 +1,88 @@
+package com.helywin.leggedjoystick.proto
+
+import legged_driver.*
+import org.junit.Assert.*
+import org.junit.Test
+
+/**
+ * 帧编解码与旧的“编码-计算CRC-重建-再编码”流程的一致性测试
+ */
+class FrameCodecTest {
+
+    private fun legacyFrame(message: LeggedDriverMessage): ByteArray {
+        val crc = MessageUtils.calculateCRC32(message.copy(crc32 = 0).encode())
+        return message.copy(crc32 = crc).encode()
+    }
+
+    private val messages = listOf(
+        MessageUtils.createHeartbeatMessage(DeviceType.DEVICE_TYPE_REMOTE_CONTROLLER, "remote_1234abcd", true),
+        MessageUtils.createModeSetMessage(DeviceType.DEVICE_TYPE_REMOTE_CONTROLLER, "remote_1234abcd", Mode.MODE_MANUAL),
+        MessageUtils.createControlModeSetMessage(
+            DeviceType.DEVICE_TYPE_REMOTE_CONTROLLER, "remote_1234abcd", ControlMode.CONTROL_MODE_LIE_DOWN
+        ),
+        MessageUtils.createVelocityCommandMessage(
+            DeviceType.DEVICE_TYPE_REMOTE_CONTROLLER, "remote_1234abcd", 0.8f, -0.25f, -0.0f
+        )
+    )
+
+    @Test
+    fun encodeFrame_matchesLegacyEncoding() {
+        messages.forEach { message ->
+            assertArrayEquals(legacyFrame(message), MessageUtils.encodeFrame(message))
+        }
+    }
+
+    @Test
+    fun verifyFrame_acceptsEncodedFrames() {
+        messages.forEach { message ->
+            val frame = MessageUtils.encodeFrame(message)
+            assertTrue(MessageUtils.verifyFrame(frame))
+            val decoded = MessageUtils.decodeFrame(frame)!!
+            assertEquals(message.copy(crc32 = decoded.crc32), decoded)
+            assertTrue(MessageUtils.verifyMessage(decoded))
+        }
+    }
+
+    @Test
+    fun verifyFrame_rejectsCorruptedFrames() {
+        messages.forEach { message ->
+            val frame = MessageUtils.encodeFrame(message)
+            for (i in frame.indices) {
+                val corrupted = frame.copyOf()
+                corrupted[i] = (corrupted[i].toInt() xor 0x01).toByte()
+                assertFalse("byte $i", MessageUtils.verifyFrame(corrupted))
+            }
+        }
+    }
+
+    @Test
+    fun verifyFrame_skipsCrcFieldAnywhereInFrame() {
+        val message = messages.first()
+        val frame = MessageUtils.encodeFrame(message)
+        val crc = MessageUtils.decodeFrame(frame)!!.crc32
+        val body = message.encode()
+
+        // crc32字段放在帧首时也应能正确校验
+        val crcField = LeggedDriverMessage(crc32 = crc).encode()
+        assertTrue(MessageUtils.verifyFrame(crcField + body))
+    }
+
+    @Test
+    fun verifyFrame_rejectsTruncatedFrames() {
+        val frame = MessageUtils.encodeFrame(messages.last())
+        for (length in 1 until frame.size) {
+            assertFalse(MessageUtils.verifyFrame(frame, 0, length))
+        }
+    }
+
+    @Test
+    fun peekMessageType_readsTypeWithoutDecoding() {
+        messages.forEach { message ->
+            val frame = MessageUtils.encodeFrame(message)
+            assertEquals(message.message_type.value, MessageUtils.peekMessageType(frame))
+        }
+        assertEquals(0, MessageUtils.peekMessageType(LeggedDriverMessage(timestamp_ms = 1L).encode()))
+        val truncated = MessageUtils.encodeFrame(messages.first())
+        assertEquals(-1, MessageUtils.peekMessageType(truncated, 0, 1))
+    }
+}
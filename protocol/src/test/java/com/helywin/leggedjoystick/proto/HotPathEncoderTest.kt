@@ -0,0 +1,108 @@
+package com.helywin.leggedjoystick.proto
+
+import legged_driver.*
+import org.junit.Assert.*
+import org.junit.Test
+
+/**
+ * 预编码编码器与 Wire + encodeFrame 输出的一致性测试
+ */
+class HotPathEncoderTest {
+
+    private val deviceType = DeviceType.DEVICE_TYPE_REMOTE_CONTROLLER
+    private val deviceId = "remote_1234abcd"
+    private val encoder = HotPathEncoder(deviceType, deviceId)
+
+    private val floats = listOf(0f, -0f, 0.05f, -0.25f, 1f, -3f, 2.5e-8f, Float.MAX_VALUE)
+    private val timestamps = listOf(0L, 1L, 127L, 128L, 1_760_000_000_000L)
+
+    @Test
+    fun velocityCommand_matchesWire() {
+        val frame = FrameBuffer()
+        for (timestamp in timestamps) {
+            for (vx in floats) {
+                for (yawRate in floats) {
+                    val vy = -vx
+                    val message = MessageUtils.createMessage(
+                        timestampMs = timestamp,
+                        deviceType = deviceType,
+                        deviceId = deviceId,
+                        messageType = MessageType.MESSAGE_TYPE_VELOCITY_COMMAND,
+                        velocityCommand = VelocityCommandMessage(vx = vx, vy = vy, yaw_rate = yawRate)
+                    )
+                    encoder.encodeVelocityCommand(frame, timestamp, vx, vy, yawRate)
+                    assertArrayEquals(
+                        "t=$timestamp vx=$vx vy=$vy yaw=$yawRate",
+                        MessageUtils.encodeFrame(message),
+                        frame.toByteArray()
+                    )
+                    assertTrue(MessageUtils.verifyFrame(frame.bytes, 0, frame.length))
+                }
+            }
+        }
+    }
+
+    @Test
+    fun heartbeat_matchesWire() {
+        val frame = FrameBuffer()
+        for (timestamp in timestamps) {
+            for (isConnected in listOf(true, false)) {
+                val message = MessageUtils.createMessage(
+                    timestampMs = timestamp,
+                    deviceType = deviceType,
+                    deviceId = deviceId,
+                    messageType = MessageType.MESSAGE_TYPE_HEARTBEAT,
+                    heartbeat = HeartbeatMessage(is_connected = isConnected)
+                )
+                encoder.encodeHeartbeat(frame, timestamp, isConnected)
+                assertArrayEquals(MessageUtils.encodeFrame(message), frame.toByteArray())
+            }
+        }
+    }
+
+    @Test
+    fun heartbeatWithLinkFields_matchesWire() {
+        val frame = FrameBuffer()
+        val fields = HeartbeatFields()
+        val sequences = listOf(0, 1, 200, Int.MAX_VALUE, -1)
+        val times = listOf(0L, 127L, 1_760_000_000_000_000L, Long.MAX_VALUE)
+        for (sequence in sequences) {
+            for (time in times) {
+                fields.sequence = sequence
+                fields.sendTimeUs = time
+                fields.echoSequence = sequence xor 1
+                fields.echoTimeUs = time / 2
+                fields.echoDelayUs = sequence ushr 1
+                fields.requestState = sequence % 2 == 0
+                val message = MessageUtils.createMessage(
+                    timestampMs = 1_760_000_000_000L,
+                    deviceType = deviceType,
+                    deviceId = deviceId,
+                    messageType = MessageType.MESSAGE_TYPE_HEARTBEAT,
+                    heartbeat = HeartbeatMessage(
+                        is_connected = true,
+                        sequence = fields.sequence,
+                        send_time_us = fields.sendTimeUs,
+                        echo_sequence = fields.echoSequence,
+                        echo_time_us = fields.echoTimeUs,
+                        echo_delay_us = fields.echoDelayUs,
+                        request_state = fields.requestState
+                    )
+                )
+                encoder.encodeHeartbeat(frame, 1_760_000_000_000L, true, fields)
+                assertArrayEquals("seq=$sequence t=$time", MessageUtils.encodeFrame(message), frame.toByteArray())
+            }
+        }
+    }
+
+    @Test
+    fun frameBuffer_isReusedWithoutGrowing() {
+        val frame = FrameBuffer()
+        encoder.encodeVelocityCommand(frame, 1_760_000_000_000L, 1f, 1f, 1f)
+        val bytes = frame.bytes
+        repeat(1000) {
+            encoder.encodeVelocityCommand(frame, 1_760_000_000_000L + it, it * 0.001f, -1f, 0f)
+        }
+        assertSame(bytes, frame.bytes)
+    }
+}
@@ -21,3 +21,7 @@ dependencyResolutionManagement {
 
 rootProject.name = "LeggedJoystick"
 include(":app")
+include(":protocol")
+include(":benchmark")
+include(":macrobenchmark")
+include(":baselineprofile")